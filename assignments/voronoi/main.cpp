@@ -2,6 +2,9 @@
 #include <GLFW/glfw3.h>
 
 #include <shader.h>
+#include "app.h"
+#include "debug_ui.h"
+#include "perf_hud.h"
 
 #include <iostream>
 #include <vector>
@@ -10,6 +13,7 @@
 // structure to hold the info necessary to render an object
 struct SceneObject {
     unsigned int VAO;           // vertex array object handle
+    unsigned int VBO;           // vertex buffer object handle, deleted with the VAO when the cones are rebuilt
     unsigned int vertexCount;   // number of vertices in the object
     float r, g, b;              // for object color
     float x, y;                 // for position offset
@@ -17,10 +21,16 @@ struct SceneObject {
 
 // declaration of the function you will implement in voronoi 1.1
 SceneObject instantiateCone(float r, float g, float b, float offsetX, float offsetY);
-// mouse, keyboard and screen reshape glfw callbacks
+// recreates the cones with the current coneSlices
+void rebuildCones();
+// hooks of the runtime (see app.h)
+void setup();
+void render();
+void shutdown();
+void handleInput(const InputEvent &event);
+// mouse and keyboard glfw callbacks
 void button_input_callback(GLFWwindow* window, int button, int action, int mods);
 void key_input_callback(GLFWwindow* window, int button, int other,int action, int mods);
-void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 
 // settings
 const unsigned int SCR_WIDTH = 600;
@@ -30,47 +40,37 @@ const unsigned int SCR_HEIGHT = 600;
 std::vector<SceneObject> sceneObjects;
 std::vector<Shader> shaderPrograms;
 Shader* activeShader;
+int coneSlices = 32;            // triangles around the apex of a cone, changed live in the performance window
+PerfHud perfHud;                // frame times, draw calls and the cone tessellation slider
 
 
-int main()
+int main(int argc, char* argv[])
 {
-    // glfw: initialize and configure
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-#ifdef __APPLE__
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); // uncomment this statement to fix compilation on OS X
-#endif
-
-    // glfw window creation
-    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Assignment - Voronoi Diagram", NULL, NULL);
-    if (window == NULL)
-    {
-        std::cout << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
-        return -1;
-    }
-    glfwMakeContextCurrent(window);
-    // setup frame buffer size callback
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-    // setup input callbacks
-    glfwSetMouseButtonCallback(window, button_input_callback); // NEW!
-    glfwSetKeyCallback(window, key_input_callback); // NEW!
-
-    // glad: load all OpenGL function pointers
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
-    {
-        std::cout << "Failed to initialize GLAD" << std::endl;
-        return -1;
+    // the runtime creates the window, or a headless context if asked on the command line, and runs the frames
+    // (see app.h); the input is recorded and replayed through it as well (see input_replay.h)
+    app().onSetup = setup;
+    app().onInput = handleInput;
+    app().onRender = render;
+    app().onShutdown = shutdown;
+    return app().run("Assignment - Voronoi Diagram", SCR_WIDTH, SCR_HEIGHT, argc, argv);
+}
+
+
+void setup(){
+    if (app().window()) {
+        // after the input callbacks of the runtime, the ImGui backend forwards the events to them
+        initDebugUi(app().window());
+        perfHud.addSlider("cone slices", &coneSlices, 3, 512, rebuildCones);
     }
 
     // NEW!
     // build and compile the shader programs
-    shaderPrograms.push_back(Shader("shader.vert", "color.frag"));
-    shaderPrograms.push_back(Shader("shader.vert", "distance.frag"));
-    shaderPrograms.push_back(Shader("shader.vert", "distance_color.frag"));
+    {
+        CPU_SCOPE("compile shaders");
+        shaderPrograms.push_back(Shader("shader.vert", "color.frag"));
+        shaderPrograms.push_back(Shader("shader.vert", "distance.frag"));
+        shaderPrograms.push_back(Shader("shader.vert", "distance_color.frag"));
+    }
     activeShader = &shaderPrograms[0];
 
     // NEW!
@@ -79,14 +79,31 @@ int main()
     glEnable(GL_DEPTH_TEST); // turn on z-buffer depth test
     glDepthFunc(GL_LESS); // draws fragments that are closer to the screen in NDC
 
-    // render loop
-    while (!glfwWindowShouldClose(window)) {
-        // background color
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        // notice that now we are clearing two buffers, the color and the z-buffer
+    // headless runs have no mouse, place the same cones in every run instead (unless the input is replayed)
+    if (app().context().isHeadless() && !app().context().isReplaying()) {
+        srand(1);
+        for (int i = 0; i < 32; i++) {
+            float x = (float) rand() / (float) RAND_MAX * 2.0f - 1.0f;
+            float y = (float) rand() / (float) RAND_MAX * 2.0f - 1.0f;
+            sceneObjects.push_back(instantiateCone((float) rand() / (float) RAND_MAX, (float) rand() / (float) RAND_MAX,
+                                                   (float) rand() / (float) RAND_MAX, x, y));
+        }
+    }
+}
+
+
+void render(){
+    // background color
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    // notice that now we are clearing two buffers, the color and the z-buffer
+    {
+        GPU_SCOPE("clear");
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
 
-        // render the cones
+    // render the cones, the GPU time is reported as "cones"
+    {
+        GPU_SCOPE("cones");
         glUseProgram(activeShader->ID);
 
         // TODO voronoi 1.3
@@ -94,20 +111,37 @@ int main()
         // - bind the VAO; set the uniform variables; and draw.
         // CODE HERE
 
+    }
 
-        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+    // performance window
+    if (app().window()) {
+        perfHud.newFrame();
+        perfHud.setCounter("cones", (double) sceneObjects.size());
+        beginDebugUi();
+        perfHud.draw();
+        endDebugUi();
     }
+}
+
+
+void shutdown(){
+    if (app().window())
+        shutdownDebugUi();
+}
+
 
-    // glfw: terminate, clearing all previously allocated GLFW resources.
-    glfwTerminate();
-    return 0;
+// the input events of the frame, passed on to the glfw callbacks below (the window is null in headless replays)
+void handleInput(const InputEvent &event){
+    if (event.type == InputEvent::MOUSE_BUTTON)
+        button_input_callback(app().window(), event.key, event.action, event.mods);
+    else if (event.type == InputEvent::KEY)
+        key_input_callback(app().window(), event.key, event.scancode, event.action, event.mods);
 }
 
 
 // creates a cone triangle mesh, uploads it to openGL and returns the VAO associated to the mesh
 SceneObject instantiateCone(float r, float g, float b, float offsetX, float offsetY){
+    CPU_SCOPE("instantiateCone");
     // TODO voronoi 1.1
     // (exercises 1.7 and 1.8 can help you with implementing this function)
 
@@ -116,7 +150,7 @@ SceneObject instantiateCone(float r, float g, float b, float offsetX, float offs
 
     // you will need to store offsetX, offsetY, r, g and b in the object.
     // CODE HERE
-    // Build the geometry into an std::vector<float> or float array.
+    // Build the geometry into an std::vector<float> or float array, with coneSlices triangles around the apex.
     // CODE HERE
     // Store the number of vertices in the mesh in the scene object.
     // CODE HERE
@@ -126,13 +160,23 @@ SceneObject instantiateCone(float r, float g, float b, float offsetX, float offs
     // CODE HERE
     // Set the position attribute pointers in the shader.
     // CODE HERE
-    // Store the VAO handle in the scene object.
+    // Store the VAO and VBO handles in the scene object.
     // CODE HERE
 
     // 'return' the scene object for the cone instance you just created.
     return sceneObject;
 }
 
+// recreates every cone with the same color and position, called when coneSlices changes
+void rebuildCones(){
+    CPU_SCOPE("rebuildCones");
+    for (SceneObject &sceneObject : sceneObjects) {
+        glDeleteVertexArrays(1, &sceneObject.VAO);
+        glDeleteBuffers(1, &sceneObject.VBO);
+        sceneObject = instantiateCone(sceneObject.r, sceneObject.g, sceneObject.b, sceneObject.x, sceneObject.y);
+    }
+}
+
 // glfw: called whenever a mouse button is pressed
 void button_input_callback(GLFWwindow* window, int button, int action, int mods){
     // TODO voronoi 1.2
@@ -145,7 +189,9 @@ void button_input_callback(GLFWwindow* window, int button, int action, int mods)
     // - Push the return value to the back of the global 'vector<SceneObject> sceneObjects'.
     // - The click position should be transformed from screen coordinates to normalized device coordinates,
     //   to obtain the offset values that describe the position of the object in the screen plane.
+    //   Read it with inputReplay().getCursorPos and inputReplay().getWindowSize, the window is null in replays.
     // - A random value in the range [0, 1] should be used for the r, g and b variables.
+    // - Ignore the click when ImGui::GetIO().WantCaptureMouse is set, the mouse is over the performance window.
     // CODE HERE
 }
 
@@ -159,12 +205,3 @@ void key_input_callback(GLFWwindow* window, int button, int other,int action, in
     //   and so on.
     // CODE HERE
 }
-
-
-// glfw: whenever the window size changed (by OS or user resize) this callback function executes
-void framebuffer_size_callback(GLFWwindow* window, int width, int height)
-{
-    // make sure the viewport matches the new window dimensions; note that width and
-    // height will be significantly larger than specified on retina displays.
-    glViewport(0, 0, width, height);
-}
\ No newline at end of file
@@ -0,0 +1,804 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+#include "shader.h"
+#include "glmutils.h"
+#include "mesh_upload.h"
+#include "gpu_profiler.h"
+#include "cpu_profiler.h"
+#include "debug_ui.h"
+#include "perf_hud.h"
+#include "particle_sort.h"
+#include "app.h"
+#include "mesh_file.h"
+#include "texture_cache.h"
+
+// rain and snow as in Project Gotham Racing 4 (ShaderX 7, chapter 5.1): a fixed buffer of random seeds is uploaded
+// once, and the vertex shader places every particle in a box centered on the camera with mod(), from the distance
+// the particles fell so far (offset) and the camera position. Nothing is spawned, killed or uploaded while the
+// camera moves, a frame only sets a few uniforms, so the cost is the vertex and fill rate of the draw.
+//
+// Rain streaks are drawn from the tail, where the particle was streakTime seconds ago seen by the previous camera,
+// to the head seen by the current camera, in one of three ways (--streaks lines|geometry|instanced, or the keys
+// 3, 4 and 5): 1 pixel lines, quads expanded from points in a geometry shader (streak.geom), or instanced quads
+// expanded in the vertex shader (streak.vert). The quads have the width of a drop instead of the large points
+// of a gl_PointSize approach, so the fill rate stays low; their GPU time is reported per path, to compare them:
+//     benchmark gs.json weather_effects rain.rec -- --streaks geometry
+//     benchmark instanced.json weather_effects rain.rec -- --streaks instanced
+//
+// The particles are blended over each other in buffer order, which is only right for additive blending. With
+// --sort (or the key 6) they are sorted back to front every frame on the CPU (particle_sort.h, --sort-threads <n>)
+// and drawn through an index buffer; this applies to the draws of point vertices, the snow and the geometry shader
+// streaks, the instanced lines and quads draw one seed per instance and stay in buffer order
+//
+// The particles collide with the scene on the GPU (--no-collisions, or the key 7, turns it off): the depth of the
+// floor and cubes is rendered from above the volume into an occlusion map, and the particles under its surface are
+// hidden, so the rain and snow stop on the floor and under the cubes without any CPU query of the geometry. The
+// rain drops that went under the surface in this frame are appended to a ring of splashes with transform
+// feedback (splash_spawn.vert/.geom), at the hit position with the normal of the occlusion map, and every splash
+// is drawn as droplets that bounce off the surface (splash.geom)
+//
+// The streaks are shaded with the profile of a drop (textures/streak.png), and the snow flakes and splash droplets
+// with sprites packed into one atlas (texture_cache.h), every snow seed keeps one of the snow sprites so all of
+// them are drawn in one draw call; the textures are loaded by the texture cache, windowed runs draw the
+// placeholders until they are uploaded, headless and replayed runs wait for them in setup, so that every
+// benchmark frame draws the same thing
+// ---------------------------------------------------------------------------------------------------------------
+
+// function declarations
+// ---------------------
+void setup();
+void update(float dt);
+void render();
+void shutdown();
+void handleInput(const InputEvent &event);
+void processInput(float dt);
+void processScriptedInput(float dt);
+void cursor_input_callback(GLFWwindow* window, double posX, double posY);
+void createSeedBuffer();
+void drawScene(const glm::mat4 &viewProjection);
+void drawSceneGeometry(const glm::mat4 &viewProjection);
+void createCollisionResources();
+void drawOcclusionMap();
+void setOcclusionUniforms(Shader* shader);
+void spawnSplashes();
+void drawSplashes(const glm::mat4 &viewProjection);
+void drawPrecipitation(const glm::mat4 &viewProjection);
+void setWeather(int weather);
+void parseOptions(int argc, char* argv[]);
+void drawPointVertices();
+void setSpriteUniforms(Shader* shader, unsigned int first, unsigned int count);
+void sortParticles();
+
+// screen settings
+// ---------------
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+// structure to hold render info
+// -----------------------------
+struct SceneObject{
+    unsigned int VAO;
+    unsigned int vertexCount;
+    GLenum indexType;
+    void drawSceneObject() const{
+        glBindVertexArray(VAO);
+        glDrawElements(GL_TRIANGLES, vertexCount, indexType, 0);
+    }
+};
+
+// global variables used for rendering
+// -----------------------------------
+SceneObject cube;
+SceneObject floorObj;
+Shader* sceneShader;
+Shader* precipitationShader;
+Shader* streakGeometryShader;               // precipitation.vert, streak.geom and streak.frag
+Shader* streakInstancedShader;              // streak.vert and streak.frag
+Shader* splashSpawnShader;                  // splash_spawn.vert and .geom, captured with transform feedback
+Shader* splashShader;                       // splash.vert, splash.geom and precipitation.frag
+Texture streakTexture;
+Texture spriteAtlas;
+// the sprites of the atlas, the snow sprites first
+const std::vector<std::string> spritePaths = {"textures/snow_soft.png", "textures/snow_star.png",
+                                              "textures/snow_clump.png", "textures/splash_droplet.png"};
+const unsigned int SNOW_SPRITES = 3, SPLASH_SPRITE = 3;
+
+// the particle volume: seeds are 4 normalized 16 bit values (position in the volume, random size and brightness),
+// 8 bytes per particle; the same buffer is drawn as points, or instanced with 2 (lines) or 4 (quads) vertices
+// -----------------------------------------------------------------------------------------------------------------
+unsigned int seedBuffer = 0;
+unsigned int pointsVAO = 0, streaksVAO = 0;
+int particleCount = 200000;                 // changed live in the performance window, recreates the seed buffer
+float volumeSize = 20.0f;                   // side of the box around the camera, in meters
+glm::vec3 particleOffset(0.0f);             // distance fallen so far, wrapped to the volume size
+std::vector<uint16_t> seeds;                // copy of the seed buffer, for the sort
+
+// back to front order of the particles, recomputed every frame when sorting
+// --------------------------------------------------------------------------
+bool sortEnabled = false;
+int sortThreads = (int) std::max(1u, std::thread::hardware_concurrency());
+ParticleSorter particleSorter(1);
+std::vector<unsigned int> sortedOrder;
+unsigned int sortedIndexBuffer = 0;         // element buffer of pointsVAO
+
+// rain falls fast and is drawn as streaks, snow falls slowly and is drawn as points
+enum Weather { RAIN, SNOW };
+struct WeatherSettings{
+    glm::vec3 fallVelocity;
+    glm::vec4 color;
+    float pointSize;
+    float streakTime;                       // seconds of motion in a streak, 0 draws points
+    float streakWidth;                      // width of a drop in meters, for the quad streaks
+    bool splashes;                          // splash on the scene, otherwise only stop on it
+};
+const WeatherSettings weatherSettings[] = {
+        {glm::vec3(0.0f, -9.0f, 0.0f), glm::vec4(.7f, .75f, .8f, .5f), 0.0f, 0.04f, 0.005f, true},
+        {glm::vec3(0.0f, -1.0f, 0.0f), glm::vec4(1.0f, 1.0f, 1.0f, .9f), 40.0f, 0.0f, 0.0f, false},
+};
+int weather = RAIN;
+enum StreakRenderer { LINES, GEOMETRY_SHADER, INSTANCED_QUADS };
+const char* streakRendererNames[] = {"lines", "geometry", "instanced"};
+int streakRenderer = INSTANCED_QUADS;
+glm::vec3 wind(1.0f, 0.0f, 0.5f);           // constant wind instead of the Perlin noise of the chapter
+float frameTime = 0.0f;                     // seconds of the last update, the drops fell velocity * frameTime
+
+// collisions: the occlusion map is a depth texture of the scene seen from above, with an orthographic projection
+// that covers the volume; it maps depth 0 to the top of the volume and depth 1 to its bottom
+// -----------------------------------------------------------------------------------------------------------------
+bool collisions = true;
+const unsigned int OCCLUSION_MAP_SIZE = 512;
+unsigned int occlusionFBO = 0, occlusionMap = 0;
+glm::vec3 occlusionArea;                    // x and z of the corner of the map, and its side, in meters
+glm::vec2 occlusionHeight;                  // height of depth 0 and the height range of the depths
+
+// the splashes of every frame are captured in the next slot of a ring, the number written to a slot is read back
+// from a query once it is available, without waiting for the GPU; a splash is 8 floats: position, normal, time of
+// the hit and a random value
+// -----------------------------------------------------------------------------------------------------------------
+const unsigned int SPLASH_SLOTS = 64, SPLASH_SLOT_CAPACITY = 4096;
+const unsigned int splashSize = 8 * sizeof(float);
+const float splashLifetime = .3f, splashRestitution = .15f, splashPointSize = 6.0f;
+unsigned int splashBuffer = 0, splashVAO = 0;
+unsigned int splashQueries[SPLASH_SLOTS];
+GLsizei splashCounts[SPLASH_SLOTS] = {};    // splashes written to every slot, when known
+float splashTimes[SPLASH_SLOTS] = {};       // time of the frame captured in every slot
+bool splashPending[SPLASH_SLOTS] = {};      // the query of the slot has no result yet
+unsigned int nextSplashSlot = 0;
+unsigned int drawnSplashes = 0;
+
+// global variables used for control
+// ---------------------------------
+glm::vec3 camPosition(.0f, 1.6f, 5.0f);
+float camYaw = -glm::half_pi<float>(), camPitch = 0.0f;     // -z forward
+float linearSpeed = 5.0f, rotationGain = 0.003f;            // meters per second, radians per pixel
+bool cursorCaptured = true;     // the mouse turns the camera, TAB releases the cursor to use the performance window
+glm::mat4 previousViewProjection(1.0f);
+const float fieldOfView = 70.0f;            // vertical, in degrees
+
+// performance window, the particle count and volume size can be changed there while the assignment runs
+// -----------------------------------------------------------------------------------------------------
+PerfHud perfHud;
+
+
+int main(int argc, char* argv[])
+{
+    // the runtime creates the window and loads the OpenGL functions, or a headless context if asked on the
+    // command line, and runs the frames (see app.h)
+    // -----------------------------------------------------------------------------------------------------
+    app().onSetup = setup;
+    app().onInput = handleInput;
+    app().onUpdate = update;
+    app().onRender = render;
+    app().onShutdown = shutdown;
+    parseOptions(argc, argv);
+    return app().run("Assignment - Weather Effects", SCR_WIDTH, SCR_HEIGHT, argc, argv);
+}
+
+
+void setup(){
+    if (app().window()) {
+        glfwSetInputMode(app().window(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+        // after the input callbacks of the runtime, the ImGui backend forwards the events to them
+        initDebugUi(app().window());
+    }
+    // count the GL calls for the draw call and triangle counts of the performance window
+    glCallCounter().install();
+    perfHud.addSlider("particles", &particleCount, 1000, 4000000, createSeedBuffer);
+    perfHud.addSlider("volume size", &volumeSize, 5.0f, 100.0f);
+    perfHud.addSlider("streaks", &streakRenderer, LINES, INSTANCED_QUADS);
+    perfHud.addSlider("sort threads", &sortThreads, 1, 32, []{ particleSorter.setThreadCount((unsigned int) sortThreads); });
+    particleSorter.setThreadCount((unsigned int) sortThreads);
+
+    // set up the z-buffer
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+    // gl_PointSize is set in precipitation.vert
+    glEnable(GL_PROGRAM_POINT_SIZE);
+
+    {
+        CPU_SCOPE("compile shaders");
+        sceneShader = new Shader("scene.vert", "scene.frag");
+        precipitationShader = new Shader("precipitation.vert", "precipitation.frag");
+        streakGeometryShader = new Shader("precipitation.vert", "streak.frag", "streak.geom");
+        streakInstancedShader = new Shader("streak.vert", "streak.frag");
+        splashSpawnShader = new Shader("splash_spawn.vert", "splash_spawn.frag", "splash_spawn.geom");
+        splashSpawnShader->setFeedbackVaryings({"splashPosition", "splashNormal", "splashData"});
+        splashShader = new Shader("splash.vert", "precipitation.frag", "splash.geom");
+    }
+
+    // map the binary mesh files, written next to the executable by mesh_converter at build time, and load them
+    // into openGL straight from the mapping; only the full detail level of the files is drawn
+    SceneObject* meshes[] = {&floorObj, &cube};
+    const char* meshPaths[] = {"floor.mesh", "cube.mesh"};
+    for (int i = 0; i < 2; i++){
+        MappedMeshFile meshFile;
+        if (!meshFile.open(meshPaths[i])){
+            std::cout << "ERROR::WEATHER_EFFECTS::MESH_NOT_LOADED " << meshPaths[i]
+                      << " (run the assignment from its build directory)" << std::endl;
+            app().fail();
+            return;
+        }
+        meshes[i]->VAO = createVertexArray(meshFile, sceneShader->ID);
+        meshes[i]->vertexCount = meshFile.lod(0).indexCount;
+        meshes[i]->indexType = meshFile.indexType();
+    }
+
+    TextureOptions spriteOptions;
+    spriteOptions.wrap = GL_CLAMP_TO_EDGE;
+    streakTexture = textureCache().load("textures/streak.png", spriteOptions);
+    spriteAtlas = textureCache().loadAtlas(spritePaths, spriteOptions);
+    if (!app().window() || app().context().isReplaying())
+        textureCache().finishLoading();
+
+    createSeedBuffer();
+    createCollisionResources();
+}
+
+
+void update(float dt){
+    if (app().window() || app().context().isReplaying())
+        processInput(dt);
+    else
+        processScriptedInput(dt);
+    frameTime = dt;
+
+    // the particles of every kind move with the same velocity, so the whole volume moves by one offset; it is
+    // wrapped to the volume here, so the float keeps its precision in long runs
+    particleOffset += (weatherSettings[weather].fallVelocity + wind) * dt;
+    particleOffset = glm::mod(particleOffset, glm::vec3(volumeSize));
+
+    // report the GPU time of the last second
+    static float lastStatsTime = 0;
+    if (app().time() - lastStatsTime > 1.0f){
+        lastStatsTime = app().time();
+        gpuProfiler().printStats(std::cout);
+        gpuProfiler().resetStats();
+    }
+}
+
+
+void render(){
+    glClearColor(0.3f, 0.33f, 0.36f, 1.0f);
+    {
+        GPU_SCOPE("clear");
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+
+    glm::vec3 camForward(cos(camPitch) * cos(camYaw), sin(camPitch), cos(camPitch) * sin(camYaw));
+    glm::mat4 view = glm::lookAt(camPosition, camPosition + camForward, glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(fieldOfView), (float) SCR_WIDTH / (float) SCR_HEIGHT, .1f, 200.0f);
+    glm::mat4 viewProjection = projection * view;
+
+    drawScene(viewProjection);
+    if (collisions){
+        drawOcclusionMap();
+        spawnSplashes();
+    }
+    drawPrecipitation(viewProjection);
+    drawSplashes(viewProjection);
+    previousViewProjection = viewProjection;
+
+    if (app().window()) {
+        perfHud.newFrame();
+        perfHud.setCounter("particles", (double) particleCount);
+        perfHud.setCounter("splashes", (double) drawnSplashes);
+        beginDebugUi();
+        perfHud.draw();
+        endDebugUi();
+    }
+}
+
+
+void shutdown(){
+    glDeleteVertexArrays(1, &pointsVAO);
+    glDeleteVertexArrays(1, &streaksVAO);
+    glDeleteBuffers(1, &seedBuffer);
+    glDeleteBuffers(1, &sortedIndexBuffer);
+    glDeleteFramebuffers(1, &occlusionFBO);
+    glDeleteTextures(1, &occlusionMap);
+    glDeleteVertexArrays(1, &splashVAO);
+    glDeleteBuffers(1, &splashBuffer);
+    glDeleteQueries(SPLASH_SLOTS, splashQueries);
+    delete sceneShader;
+    delete precipitationShader;
+    delete streakGeometryShader;
+    delete streakInstancedShader;
+    delete splashSpawnShader;
+    delete splashShader;
+    streakTexture = Texture();
+    spriteAtlas = Texture();
+    if (app().window())
+        shutdownDebugUi();
+}
+
+
+void drawScene(const glm::mat4 &viewProjection){
+    GPU_SCOPE("scene");
+    drawSceneGeometry(viewProjection);
+}
+
+
+void drawSceneGeometry(const glm::mat4 &viewProjection){
+    sceneShader->use();
+    // the floor, and cubes along the path, so that the camera motion is easy to see
+    sceneShader->setMat4("model", viewProjection);
+    floorObj.drawSceneObject();
+    for (int i = -2; i <= 2; i++){
+        sceneShader->setMat4("model", viewProjection * glm::translate(i * 6.0f, 1.0f, -8.0f) * glm::rotateY((float) i));
+        cube.drawSceneObject();
+        sceneShader->setMat4("model", viewProjection * glm::translate(-8.0f, .5f, i * 6.0f) * glm::scale(.5f, .5f, .5f));
+        cube.drawSceneObject();
+    }
+}
+
+
+void drawPrecipitation(const glm::mat4 &viewProjection){
+    const WeatherSettings &settings = weatherSettings[weather];
+    bool streaks = settings.streakTime > 0.0f;
+    // points and lines share precipitation.vert, the quads are expanded in the geometry or vertex shader
+    Shader* shader = !streaks || streakRenderer == LINES ? precipitationShader :
+                     streakRenderer == GEOMETRY_SHADER ? streakGeometryShader : streakInstancedShader;
+
+    shader->use();
+    shader->setMat4("viewProjection", viewProjection);
+    shader->setMat4("previousViewProjection", previousViewProjection);
+    shader->setVec3("cameraPosition", camPosition);
+    shader->setVec3("volumeSize", glm::vec3(volumeSize));
+    shader->setVec3("offset", particleOffset);
+    shader->setVec3("velocity", settings.fallVelocity + wind);
+    shader->setFloat("streakTime", settings.streakTime);
+    shader->setFloat("pointSize", settings.pointSize);
+    shader->setBool("streaks", streaks && streakRenderer == LINES);
+    shader->setVec4("color", settings.color);
+    shader->setVec2("viewportSize", (float) SCR_WIDTH, (float) SCR_HEIGHT);
+    shader->setFloat("streakWidth", settings.streakWidth);
+    shader->setFloat("pixelsPerUnit", (float) SCR_HEIGHT * .5f / tan(glm::radians(fieldOfView) * .5f));
+    setOcclusionUniforms(shader);
+    streakTexture.bind(1);
+    shader->setInt("streakTexture", 1);
+    setSpriteUniforms(shader, 0, SNOW_SPRITES);
+
+    // blended over the scene, tested against its depth but not written, the particles don't hide each other
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDepthMask(GL_FALSE);
+    if (!streaks){
+        GPU_SCOPE("points");
+        drawPointVertices();
+    }
+    else if (streakRenderer == LINES){
+        GPU_SCOPE("streaks (lines)");
+        glBindVertexArray(streaksVAO);
+        glDrawArraysInstanced(GL_LINES, 0, 2, particleCount);
+    }
+    else if (streakRenderer == GEOMETRY_SHADER){
+        GPU_SCOPE("streaks (geometry shader)");
+        drawPointVertices();
+    }
+    else {
+        GPU_SCOPE("streaks (instanced quads)");
+        glBindVertexArray(streaksVAO);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, particleCount);
+    }
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+}
+
+
+// the occlusion map and its framebuffer, and the ring of splashes with its queries
+// --------------------------------------------------------------------------------
+void createCollisionResources(){
+    glGenTextures(1, &occlusionMap);
+    glBindTexture(GL_TEXTURE_2D, occlusionMap);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, OCCLUSION_MAP_SIZE, OCCLUSION_MAP_SIZE, 0,
+                 GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    GLint previousFramebuffer;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGenFramebuffers(1, &occlusionFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, occlusionFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, occlusionMap, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE){
+        std::cout << "ERROR::WEATHER_EFFECTS::OCCLUSION_FRAMEBUFFER_INCOMPLETE" << std::endl;
+        collisions = false;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint) previousFramebuffer);
+
+    glGenBuffers(1, &splashBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, splashBuffer);
+    glBufferData(GL_ARRAY_BUFFER, SPLASH_SLOTS * SPLASH_SLOT_CAPACITY * splashSize, nullptr, GL_DYNAMIC_COPY);
+    glGenVertexArrays(1, &splashVAO);
+    glBindVertexArray(splashVAO);
+    for (unsigned int i = 0; i < 3; i++)
+        glEnableVertexAttribArray(i);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, splashSize, (void*) 0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, splashSize, (void*) (3 * sizeof(float)));
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, splashSize, (void*) (6 * sizeof(float)));
+    glBindVertexArray(0);
+    glGenQueries(SPLASH_SLOTS, splashQueries);
+}
+
+
+// the depth of the scene seen from above, in a square that covers the volume; the square moves in steps of a
+// texel, so the depths of the static scene don't shimmer while the camera moves
+// -------------------------------------------------------------------------------------------------------------
+void drawOcclusionMap(){
+    GPU_SCOPE("occlusion map");
+    float texel = volumeSize / (float) (OCCLUSION_MAP_SIZE - 1);
+    float size = texel * (float) OCCLUSION_MAP_SIZE;
+    occlusionArea = glm::vec3(std::floor((camPosition.x - volumeSize * .5f) / texel) * texel,
+                              std::floor((camPosition.z - volumeSize * .5f) / texel) * texel, size);
+    occlusionHeight = glm::vec2(camPosition.y + volumeSize * .5f, volumeSize);
+
+    // x and z to the clip space x and y, the top of the volume to depth 0 and its bottom to depth 1
+    glm::mat4 occlusionViewProjection(0.0f);
+    occlusionViewProjection[0][0] = 2.0f / size;
+    occlusionViewProjection[2][1] = 2.0f / size;
+    occlusionViewProjection[1][2] = -2.0f / occlusionHeight.y;
+    occlusionViewProjection[3][0] = -2.0f * occlusionArea.x / size - 1.0f;
+    occlusionViewProjection[3][1] = -2.0f * occlusionArea.y / size - 1.0f;
+    occlusionViewProjection[3][2] = 2.0f * occlusionHeight.x / occlusionHeight.y - 1.0f;
+    occlusionViewProjection[3][3] = 1.0f;
+
+    GLint previousFramebuffer, viewport[4];
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glBindFramebuffer(GL_FRAMEBUFFER, occlusionFBO);
+    glViewport(0, 0, OCCLUSION_MAP_SIZE, OCCLUSION_MAP_SIZE);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    drawSceneGeometry(occlusionViewProjection);
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint) previousFramebuffer);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+
+// the occlusion map on texture unit 0, for the particle shaders that test against it
+// ------------------------------------------------------------------------------------
+void setOcclusionUniforms(Shader* shader){
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, occlusionMap);
+    shader->setInt("occlusionMap", 0);
+    shader->setBool("collisions", collisions);
+    shader->setVec3("occlusionArea", occlusionArea);
+    shader->setVec2("occlusionHeight", occlusionHeight);
+}
+
+
+// the sprite atlas on texture unit 2 and the rectangles of count of its sprites from first, no sprites (the shaders
+// draw round points) until the atlas is loaded
+// -----------------------------------------------------------------------------------------------------------------
+void setSpriteUniforms(Shader* shader, unsigned int first, unsigned int count){
+    spriteAtlas.bind(2);
+    shader->setInt("spriteAtlas", 2);
+    std::vector<float> rects = spriteAtlas.spriteRectData();
+    if (rects.size() < (first + count) * 4)
+        count = 0;
+    if (count)
+        glUniform4fv(glGetUniformLocation(shader->ID, "spriteRects"), (GLsizei) count, &rects[first * 4]);
+    shader->setInt("spriteCount", (int) count);
+}
+
+
+// every seed goes through splash_spawn, only the drops that hit the scene are written to the next slot; the
+// splashes past the capacity of a slot are dropped by the transform feedback
+// -----------------------------------------------------------------------------------------------------------
+void spawnSplashes(){
+    const WeatherSettings &settings = weatherSettings[weather];
+    if (!settings.splashes)
+        return;
+    GPU_SCOPE("spawn splashes");
+    unsigned int slot = nextSplashSlot;
+    nextSplashSlot = (nextSplashSlot + 1) % SPLASH_SLOTS;
+
+    splashSpawnShader->use();
+    splashSpawnShader->setVec3("cameraPosition", camPosition);
+    splashSpawnShader->setVec3("volumeSize", glm::vec3(volumeSize));
+    splashSpawnShader->setVec3("offset", particleOffset);
+    splashSpawnShader->setVec3("velocity", settings.fallVelocity + wind);
+    splashSpawnShader->setFloat("frameTime", frameTime);
+    splashSpawnShader->setFloat("currentTime", app().time());
+    setOcclusionUniforms(splashSpawnShader);
+
+    glBindBufferRange(GL_TRANSFORM_FEEDBACK_BUFFER, 0, splashBuffer, slot * SPLASH_SLOT_CAPACITY * splashSize,
+                      SPLASH_SLOT_CAPACITY * splashSize);
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, splashQueries[slot]);
+    glBeginTransformFeedback(GL_POINTS);
+    glBindVertexArray(pointsVAO);
+    glDrawArrays(GL_POINTS, 0, particleCount);
+    glEndTransformFeedback();
+    glEndQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN);
+    glDisable(GL_RASTERIZER_DISCARD);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+
+    splashCounts[slot] = 0;
+    splashTimes[slot] = app().time();
+    splashPending[slot] = true;
+}
+
+
+// the slots of the last splashLifetime seconds whose count is known, in one draw
+// --------------------------------------------------------------------------------
+void drawSplashes(const glm::mat4 &viewProjection){
+    GLint firsts[SPLASH_SLOTS];
+    GLsizei counts[SPLASH_SLOTS];
+    GLsizei slots = 0;
+    drawnSplashes = 0;
+    for (unsigned int slot = 0; slot < SPLASH_SLOTS; slot++){
+        if (splashPending[slot]){
+            GLuint available = 0;
+            glGetQueryObjectuiv(splashQueries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available)
+                continue;
+            GLuint written = 0;
+            glGetQueryObjectuiv(splashQueries[slot], GL_QUERY_RESULT, &written);
+            splashCounts[slot] = (GLsizei) written;
+            splashPending[slot] = false;
+        }
+        if (splashCounts[slot] == 0 || app().time() - splashTimes[slot] > splashLifetime)
+            continue;
+        firsts[slots] = (GLint) (slot * SPLASH_SLOT_CAPACITY);
+        counts[slots] = splashCounts[slot];
+        drawnSplashes += (unsigned int) splashCounts[slot];
+        slots++;
+    }
+    if (slots == 0)
+        return;
+
+    GPU_SCOPE("splashes");
+    const WeatherSettings &settings = weatherSettings[weather];
+    splashShader->use();
+    splashShader->setMat4("viewProjection", viewProjection);
+    splashShader->setVec3("velocity", settings.fallVelocity + wind);
+    splashShader->setFloat("currentTime", app().time());
+    splashShader->setFloat("lifetime", splashLifetime);
+    splashShader->setFloat("restitution", splashRestitution);
+    splashShader->setFloat("pointSize", splashPointSize);
+    splashShader->setVec4("color", weatherSettings[RAIN].color);
+    splashShader->setBool("streaks", false);
+    setSpriteUniforms(splashShader, SPLASH_SPRITE, 1);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDepthMask(GL_FALSE);
+    glBindVertexArray(splashVAO);
+    glMultiDrawArrays(GL_POINTS, firsts, counts, slots);
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+}
+
+
+// one point vertex per particle, in buffer order or back to front
+// ----------------------------------------------------------------
+void drawPointVertices(){
+    glBindVertexArray(pointsVAO);
+    if (!sortEnabled){
+        glDrawArrays(GL_POINTS, 0, particleCount);
+        return;
+    }
+    sortParticles();
+    {
+        CPU_SCOPE("uploadSortedIndices");
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sortedIndexBuffer);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr) (sortedOrder.size() * sizeof(unsigned int)),
+                     sortedOrder.data(), GL_STREAM_DRAW);
+    }
+    glDrawElements(GL_POINTS, particleCount, GL_UNSIGNED_INT, 0);
+}
+
+
+// the particles are placed like in precipitation.vert and sorted by their depth along the view direction, the
+// farthest first; the depth is in [-radius, radius] around the camera, radius is half the box diagonal
+// ----------------------------------------------------------------------------------------------------------------
+void sortParticles(){
+    glm::vec3 camForward(cos(camPitch) * cos(camYaw), sin(camPitch), cos(camPitch) * sin(camYaw));
+    glm::vec3 boxMin = camPosition - glm::vec3(volumeSize * .5f);
+    glm::vec3 wrapOrigin = particleOffset - boxMin;
+    float radius = volumeSize * .5f * std::sqrt(3.0f);
+    float size = volumeSize;
+    auto wrap = [size](float x){ return x - size * std::floor(x / size); };
+
+    particleSorter.sort((unsigned int) particleCount, [&](unsigned int i){
+        const uint16_t* seed = &seeds[(size_t) i * 4];
+        glm::vec3 position = boxMin + glm::vec3(wrap(seed[0] / 65535.0f * size + wrapOrigin.x),
+                                                wrap(seed[1] / 65535.0f * size + wrapOrigin.y),
+                                                wrap(seed[2] / 65535.0f * size + wrapOrigin.z));
+        return depthKey(glm::dot(position - camPosition, camForward) + radius, 2.0f * radius);
+    }, sortedOrder);
+}
+
+
+// the seeds never change after this, the particles are moved by the vertex shader
+// --------------------------------------------------------------------------------
+void createSeedBuffer(){
+    CPU_SCOPE("createSeedBuffer");
+    if (!seedBuffer){
+        glGenBuffers(1, &seedBuffer);
+        glGenBuffers(1, &sortedIndexBuffer);
+        glGenVertexArrays(1, &pointsVAO);
+        glGenVertexArrays(1, &streaksVAO);
+    }
+
+    // the same seeds in every run, so that benchmarks draw the same particles
+    seeds.resize((size_t) particleCount * 4);
+    uint32_t state = 1;
+    for (uint16_t &seed : seeds){
+        // xorshift32
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        seed = (uint16_t) (state >> 16);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, seedBuffer);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) (seeds.size() * sizeof(uint16_t)), seeds.data(), GL_STATIC_DRAW);
+
+    // one seed per vertex for points (and the geometry shader), one seed per instance, shared by the 2 vertices of
+    // a line or the 4 vertices of a quad, for streaks
+    unsigned int VAOs[] = {pointsVAO, streaksVAO};
+    for (int i = 0; i < 2; i++){
+        glBindVertexArray(VAOs[i]);
+        glBindBuffer(GL_ARRAY_BUFFER, seedBuffer);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 4, GL_UNSIGNED_SHORT, GL_TRUE, 4 * sizeof(uint16_t), 0);
+        glVertexAttribDivisor(0, i);
+    }
+    glBindVertexArray(0);
+}
+
+
+void setWeather(int newWeather){
+    weather = newWeather;
+    // snow is seen from closer
+    volumeSize = weather == SNOW ? 12.0f : 20.0f;
+}
+
+
+// the options of the assignment, the other options are read by the runtime:
+//   --streaks lines|geometry|instanced   streak renderer
+//   --particles <n>                      particle count
+//   --snow                               start with snow instead of rain
+//   --sort                               draw the point vertices back to front
+//   --sort-threads <n>                   threads of the sort (default: the hardware threads)
+//   --no-collisions                      the particles fall through the scene
+void parseOptions(int argc, char* argv[]){
+    for (int i = 1; i < argc; i++){
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--streaks") == 0 && hasValue){
+            for (int renderer = LINES; renderer <= INSTANCED_QUADS; renderer++)
+                if (std::strcmp(argv[i + 1], streakRendererNames[renderer]) == 0)
+                    streakRenderer = renderer;
+            i++;
+        }
+        else if (std::strcmp(argv[i], "--particles") == 0 && hasValue)
+            particleCount = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--snow") == 0)
+            setWeather(SNOW);
+        else if (std::strcmp(argv[i], "--sort") == 0)
+            sortEnabled = true;
+        else if (std::strcmp(argv[i], "--sort-threads") == 0 && hasValue)
+            sortThreads = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--no-collisions") == 0)
+            collisions = false;
+    }
+}
+
+
+void cursor_input_callback(GLFWwindow* window, double posX, double posY){
+    // the cursor is disabled while captured, so it moves without bounds and only the change is used
+    static bool firstPosition = true;
+    static double lastX, lastY;
+    if (!firstPosition && cursorCaptured){
+        camYaw += (float) (posX - lastX) * rotationGain;
+        camPitch -= (float) (posY - lastY) * rotationGain;
+        camPitch = glm::clamp(camPitch, -1.5f, 1.5f);
+    }
+    firstPosition = false;
+    lastX = posX;
+    lastY = posY;
+}
+
+
+void processInput(float dt) {
+    CPU_SCOPE("processInput");
+    if (inputReplay().getKey(GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        app().close();
+
+    // TAB toggles between turning the camera and using the performance window
+    static bool tabWasPressed = false;
+    bool tabPressed = inputReplay().getKey(GLFW_KEY_TAB) == GLFW_PRESS;
+    if (tabPressed && !tabWasPressed){
+        cursorCaptured = !cursorCaptured;
+        if (app().window())
+            glfwSetInputMode(app().window(), GLFW_CURSOR, cursorCaptured ? GLFW_CURSOR_DISABLED : GLFW_CURSOR_NORMAL);
+    }
+    tabWasPressed = tabPressed;
+
+    if (inputReplay().getKey(GLFW_KEY_1) == GLFW_PRESS)
+        setWeather(RAIN);
+    if (inputReplay().getKey(GLFW_KEY_2) == GLFW_PRESS)
+        setWeather(SNOW);
+    if (inputReplay().getKey(GLFW_KEY_3) == GLFW_PRESS)
+        streakRenderer = LINES;
+    if (inputReplay().getKey(GLFW_KEY_4) == GLFW_PRESS)
+        streakRenderer = GEOMETRY_SHADER;
+    if (inputReplay().getKey(GLFW_KEY_5) == GLFW_PRESS)
+        streakRenderer = INSTANCED_QUADS;
+    // 6 toggles the back to front sort
+    static bool sortKeyWasPressed = false;
+    bool sortKeyPressed = inputReplay().getKey(GLFW_KEY_6) == GLFW_PRESS;
+    if (sortKeyPressed && !sortKeyWasPressed)
+        sortEnabled = !sortEnabled;
+    sortKeyWasPressed = sortKeyPressed;
+    // 7 toggles the collisions with the scene
+    static bool collisionKeyWasPressed = false;
+    bool collisionKeyPressed = inputReplay().getKey(GLFW_KEY_7) == GLFW_PRESS;
+    if (collisionKeyPressed && !collisionKeyWasPressed)
+        collisions = !collisions;
+    collisionKeyWasPressed = collisionKeyPressed;
+
+    // walk on the floor plane with WASD, in the direction the camera looks at
+    glm::vec3 forward(cos(camYaw), 0.0f, sin(camYaw));
+    glm::vec3 right(-forward.z, 0.0f, forward.x);
+    glm::vec3 move(0.0f);
+    if (inputReplay().getKey(GLFW_KEY_W) == GLFW_PRESS)
+        move += forward;
+    if (inputReplay().getKey(GLFW_KEY_S) == GLFW_PRESS)
+        move -= forward;
+    if (inputReplay().getKey(GLFW_KEY_D) == GLFW_PRESS)
+        move += right;
+    if (inputReplay().getKey(GLFW_KEY_A) == GLFW_PRESS)
+        move -= right;
+    if (glm::length(move) > 0.0f)
+        camPosition += glm::normalize(move) * linearSpeed * dt;
+}
+
+
+// headless runs have no input, the camera walks in a circle instead (unless the input is replayed)
+// -----------------------------------------------------------------------------------------------
+void processScriptedInput(float dt){
+    camYaw += .3f * dt;
+    camPosition += glm::vec3(cos(camYaw), 0.0f, sin(camYaw)) * linearSpeed * dt;
+}
+
+
+// the input events of the frame, passed on to the glfw callbacks above (the window is null in headless replays)
+// -------------------------------------------------------------------------------------------------------------
+void handleInput(const InputEvent &event){
+    if (event.type == InputEvent::CURSOR_POS)
+        cursor_input_callback(app().window(), event.x, event.y);
+}
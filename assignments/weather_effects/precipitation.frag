@@ -0,0 +1,29 @@
+#version 330 core
+in float alpha;
+flat in vec4 spriteRect;                // of the point in the sprite atlas, empty until it is loaded
+
+uniform vec4 color;
+uniform bool streaks;
+uniform sampler2D spriteAtlas;
+
+out vec4 fragColor;
+
+void main()
+{
+    float coverage = alpha;
+    vec3 tint = vec3(1.0);
+    // sprites (snow, splash droplets), round and soft points until the atlas is loaded
+    if (!streaks && spriteRect.z > spriteRect.x){
+        // gl_PointCoord.y goes down, the atlas v goes up
+        vec4 sprite = texture(spriteAtlas, mix(spriteRect.xy, spriteRect.zw, vec2(gl_PointCoord.x, 1.0 - gl_PointCoord.y)));
+        coverage *= sprite.a;
+        tint = sprite.rgb;
+    }
+    else if (!streaks){
+        vec2 fromCenter = gl_PointCoord * 2.0 - 1.0;
+        coverage *= 1.0 - smoothstep(0.5, 1.0, dot(fromCenter, fromCenter));
+    }
+    if (coverage <= 0.0)
+        discard;
+    fragColor = vec4(color.rgb * tint, color.a * coverage);
+}
@@ -0,0 +1,67 @@
+#version 330 core
+// static seed of the particle, the position in the volume in [0, 1) and a random value in w
+layout (location = 0) in vec4 seed;
+
+uniform mat4 viewProjection;
+uniform mat4 previousViewProjection;    // of the previous frame, the streaks include the camera motion
+uniform vec3 cameraPosition;
+uniform vec3 volumeSize;                // size of the box around the camera that is filled with particles
+uniform vec3 offset;                    // distance the particles moved since the start, modulo volumeSize
+uniform vec3 velocity;                  // fall and wind, in world units per second
+uniform float streakTime;               // seconds of motion in a streak
+uniform float pointSize;                // size of a point one unit away from the camera
+uniform bool streaks;                   // lines with 2 vertices per particle (instanced), otherwise points
+uniform bool collisions;                // hide the particles under the scene
+uniform sampler2D occlusionMap;         // depth of the scene seen from above the volume (occlusion map)
+uniform vec3 occlusionArea;             // x and z of the corner of the occlusion map, and its side
+uniform vec2 occlusionHeight;           // height of depth 0 and the height range of the depths
+#define MAX_SPRITES 4
+uniform vec4 spriteRects[MAX_SPRITES];  // (u0, v0, u1, v1) of the sprites of the points in the sprite atlas
+uniform int spriteCount;                // 0 until the atlas is loaded
+
+out float alpha;
+out vec4 tailPosition;                  // clip space tail of the streak, for streak.geom
+flat out vec4 spriteRect;
+
+// height of the first surface under the sky at the x and z of position
+float surfaceHeight(vec3 position)
+{
+    vec2 uv = (position.xz - occlusionArea.xy) / occlusionArea.z;
+    return occlusionHeight.x - texture(occlusionMap, uv).r * occlusionHeight.y;
+}
+
+void main()
+{
+    // the particles live in world space, every one of them is repeated every volumeSize in every direction, and the
+    // copy that falls inside the box centered on the camera is drawn; moving the camera or the offset never
+    // changes the seeds, the box just wraps around the particles
+    vec3 boxMin = cameraPosition - volumeSize * 0.5;
+    vec3 position = boxMin + mod(seed.xyz * volumeSize + offset - boxMin, volumeSize);
+
+    // fade the particles out close to the box faces, where they appear and disappear when they wrap
+    vec3 fromCamera = abs(position - cameraPosition) / (volumeSize * 0.5);
+    alpha = 1.0 - smoothstep(0.6, 1.0, max(fromCamera.x, max(fromCamera.y, fromCamera.z)));
+    alpha *= 0.6 + 0.4 * seed.w;
+    // the rain and snow stop on the floor and on the cubes
+    bool hidden = collisions && position.y < surfaceHeight(position);
+    if (hidden)
+        alpha = 0.0;
+
+    // the tail is where the particle was streakTime seconds ago, seen from the previous camera
+    tailPosition = previousViewProjection * vec4(position - velocity * streakTime, 1.0);
+    if (streaks && gl_VertexID == 1){
+        gl_Position = tailPosition;
+        alpha = 0.0;
+    }
+    else
+        gl_Position = viewProjection * vec4(position, 1.0);
+
+    // every seed keeps one of the sprites, picked by the low bits of its random value (the high bits set the size)
+    spriteRect = spriteCount > 0 ? spriteRects[int(seed.w * 65535.0) % spriteCount] : vec4(0.0);
+
+    // closer particles are bigger, gl_Position.w is the distance along the view direction
+    gl_PointSize = clamp(pointSize * (0.5 + seed.w) / max(gl_Position.w, 0.1), 1.0, 64.0);
+    // hidden particles are moved outside of the clip volume, so they are culled
+    if (hidden)
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+}
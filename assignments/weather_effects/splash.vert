@@ -0,0 +1,16 @@
+#version 330 core
+// a splash captured by splash_spawn.geom, expanded into droplets by splash.geom
+layout (location = 0) in vec3 splashPosition;
+layout (location = 1) in vec3 splashNormal;
+layout (location = 2) in vec2 splashData;
+
+out vec3 hitPosition;
+out vec3 hitNormal;
+out vec2 hitData;
+
+void main()
+{
+    hitPosition = splashPosition;
+    hitNormal = splashNormal;
+    hitData = splashData;
+}
@@ -0,0 +1,8 @@
+#version 330 core
+// the splashes are only captured, GL_RASTERIZER_DISCARD is enabled while they are spawned
+out vec4 fragColor;
+
+void main()
+{
+    fragColor = vec4(0.0);
+}
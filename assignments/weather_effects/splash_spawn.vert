@@ -0,0 +1,22 @@
+#version 330 core
+// rain drops that hit the scene in this frame: every drop is placed like in precipitation.vert, now and frameTime
+// seconds ago, and splash_spawn.geom appends the ones that went under the surface of the occlusion map
+layout (location = 0) in vec4 seed;
+
+uniform vec3 cameraPosition;
+uniform vec3 volumeSize;
+uniform vec3 offset;
+uniform vec3 velocity;
+uniform float frameTime;                // seconds since the previous frame
+
+out vec3 position;
+out vec3 previousPosition;              // not wrapped, a drop that wraps around the box never crosses the surface
+out float random;
+
+void main()
+{
+    vec3 boxMin = cameraPosition - volumeSize * 0.5;
+    position = boxMin + mod(seed.xyz * volumeSize + offset - boxMin, volumeSize);
+    previousPosition = position - velocity * frameTime;
+    random = seed.w;
+}
@@ -0,0 +1,14 @@
+#version 330 core
+in float streakAlpha;
+in vec2 streakCoord;
+
+uniform vec4 color;
+uniform sampler2D streakTexture;         // profile of a drop, across in u and tail (v = 0) to head (v = 1)
+
+out vec4 fragColor;
+
+void main()
+{
+    vec4 drop = texture(streakTexture, vec2(streakCoord.x * 0.5 + 0.5, streakCoord.y));
+    fragColor = vec4(color.rgb * drop.rgb, color.a * streakAlpha * drop.a);
+}
@@ -0,0 +1,73 @@
+#version 330 core
+// rain streaks as instanced quads: 4 vertices (a triangle strip) per particle, the seed is an instanced attribute;
+// the particle is placed like in precipitation.vert and the quad is expanded like in streak.geom
+layout (location = 0) in vec4 seed;
+
+uniform mat4 viewProjection;
+uniform mat4 previousViewProjection;
+uniform vec3 cameraPosition;
+uniform vec3 volumeSize;
+uniform vec3 offset;
+uniform vec3 velocity;
+uniform float streakTime;
+uniform vec2 viewportSize;
+uniform float streakWidth;              // width of a drop in world units
+uniform float pixelsPerUnit;            // pixels covered by one world unit at distance 1
+uniform bool collisions;                // hide the particles under the scene
+uniform sampler2D occlusionMap;         // depth of the scene seen from above the volume (occlusion map)
+uniform vec3 occlusionArea;             // x and z of the corner of the occlusion map, and its side
+uniform vec2 occlusionHeight;           // height of depth 0 and the height range of the depths
+
+out float streakAlpha;
+out vec2 streakCoord;                   // x across the streak (-1 to 1), y along it (0 at the tail, 1 at the head)
+
+// corner of the quad around the screen space segment tail - head, side is -1 or 1, end is 0 (tail) or 1 (head);
+// the quad is extended by half its width past both ends, so short streaks become round dots and not slivers
+vec4 streakCorner(vec4 tail, vec4 head, float side, float end, float halfWidth)
+{
+    vec2 halfViewport = viewportSize * 0.5;
+    vec2 direction = (head.xy / head.w - tail.xy / tail.w) * halfViewport;
+    direction = length(direction) > 0.001 ? normalize(direction) : vec2(0.0, 1.0);
+    vec2 normal = vec2(-direction.y, direction.x);
+    vec4 position = end > 0.5 ? head : tail;
+    vec2 offset = (normal * side + direction * (end * 2.0 - 1.0)) * halfWidth;
+    position.xy += offset / halfViewport * position.w;
+    return position;
+}
+
+// height of the first surface under the sky at the x and z of position
+float surfaceHeight(vec3 position)
+{
+    vec2 uv = (position.xz - occlusionArea.xy) / occlusionArea.z;
+    return occlusionHeight.x - texture(occlusionMap, uv).r * occlusionHeight.y;
+}
+
+void main()
+{
+    vec3 boxMin = cameraPosition - volumeSize * 0.5;
+    vec3 position = boxMin + mod(seed.xyz * volumeSize + offset - boxMin, volumeSize);
+    vec3 fromCamera = abs(position - cameraPosition) / (volumeSize * 0.5);
+    float alpha = 1.0 - smoothstep(0.6, 1.0, max(fromCamera.x, max(fromCamera.y, fromCamera.z)));
+    alpha *= 0.6 + 0.4 * seed.w;
+    if (collisions && position.y < surfaceHeight(position))
+        alpha = 0.0;
+
+    vec4 head = viewProjection * vec4(position, 1.0);
+    vec4 tail = previousViewProjection * vec4(position - velocity * streakTime, 1.0);
+    // faded out, under the scene, or behind the camera in this or the previous frame: outside of the clip volume, the quad is culled
+    if (alpha <= 0.0 || head.w < 0.1 || tail.w < 0.1){
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        streakAlpha = 0.0;
+        streakCoord = vec2(0.0);
+        return;
+    }
+
+    float width = streakWidth * pixelsPerUnit / head.w;
+    streakAlpha = alpha * min(width, 1.0);
+    float halfWidth = max(width, 1.0) * 0.5;
+
+    float side = (gl_VertexID & 1) == 0 ? -1.0 : 1.0;
+    float end = float(gl_VertexID >> 1);
+    streakCoord = vec2(side, end);
+    gl_Position = streakCorner(tail, head, side, end, halfWidth);
+}
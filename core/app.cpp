@@ -0,0 +1,142 @@
+#include "app.h"
+#include "texture_cache.h"
+
+#include <thread>
+#include <iostream>
+
+
+App &app(){
+    static App instance;
+    return instance;
+}
+
+
+int App::run(const char* title, unsigned int width, unsigned int height, int argc, char* argv[]){
+    // create the window and load all OpenGL function pointers, or a headless context if asked on the command line
+    if (!renderContext.create(title, width, height, parseRenderContextOptions(argc, argv)))
+        return -1;
+    installCallbacks();
+
+    if (onSetup){
+        CPU_SCOPE("setup");
+        onSetup();
+    }
+
+    float previousTime = renderContext.time();
+    while (!renderContext.shouldClose())
+    {
+        auto frameStart = std::chrono::high_resolution_clock::now();
+        currentTime = renderContext.time();
+        frameDeltaTime = currentTime - previousTime;
+        previousTime = currentTime;
+
+        dispatchInput();
+        // textures decoded since the last frame, see texture_cache.h
+        textureCache().update();
+        if (onUpdate){
+            CPU_SCOPE("update");
+            onUpdate(frameDeltaTime);
+        }
+        if (onRender){
+            CPU_SCOPE("render");
+            onRender();
+        }
+
+        // presents the frame and polls the input, which is queued for the next frame
+        renderContext.endFrame();
+        waitForFrameInterval(frameStart);
+    }
+
+    if (onShutdown)
+        onShutdown();
+    textureCache().printSummary(std::cout);
+    textureCache().release();
+    renderContext.destroy();
+    renderContext.printSummary(std::cout);
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    glfwTerminate();
+    return failed ? -1 : 0;
+}
+
+
+// through inputReplay(), so that recorded input is replayed to the same callbacks
+void App::installCallbacks(){
+    inputReplay().setKeyCallback(keyCallback);
+    inputReplay().setMouseButtonCallback(mouseButtonCallback);
+    inputReplay().setCursorPosCallback(cursorPosCallback);
+    inputReplay().setScrollCallback(scrollCallback);
+    if (window())
+        glfwSetFramebufferSizeCallback(window(), framebufferSizeCallback);
+}
+
+
+void App::dispatchInput(){
+    // events that arrive while dispatching (a hook polling GLFW) wait for the next frame
+    dispatchedInput.swap(inputQueue);
+    if (onInput)
+        for (const InputEvent &event : dispatchedInput)
+            onInput(event);
+    dispatchedInput.clear();
+}
+
+
+void App::waitForFrameInterval(std::chrono::high_resolution_clock::time_point frameStart) const{
+    if (frameInterval <= 0.0f || renderContext.isHeadless() || renderContext.isReplaying())
+        return;
+    auto frameEnd = frameStart + std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(
+            std::chrono::duration<float>(frameInterval));
+    // sleep for most of the interval, the scheduler may wake us up late, and spin for the rest
+    auto sleepUntil = frameEnd - std::chrono::milliseconds(1);
+    if (std::chrono::high_resolution_clock::now() < sleepUntil)
+        std::this_thread::sleep_until(sleepUntil);
+    while (std::chrono::high_resolution_clock::now() < frameEnd)
+        std::this_thread::yield();
+}
+
+
+void App::keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods){
+    InputEvent event{InputEvent::KEY};
+    event.key = key;
+    event.scancode = scancode;
+    event.action = action;
+    event.mods = mods;
+    app().inputQueue.push_back(event);
+}
+
+
+void App::mouseButtonCallback(GLFWwindow* window, int button, int action, int mods){
+    InputEvent event{InputEvent::MOUSE_BUTTON};
+    event.key = button;
+    event.action = action;
+    event.mods = mods;
+    app().inputQueue.push_back(event);
+}
+
+
+void App::cursorPosCallback(GLFWwindow* window, double x, double y){
+    InputEvent event{InputEvent::CURSOR_POS};
+    event.x = x;
+    event.y = y;
+    app().inputQueue.push_back(event);
+}
+
+
+void App::scrollCallback(GLFWwindow* window, double x, double y){
+    InputEvent event{InputEvent::SCROLL};
+    event.x = x;
+    event.y = y;
+    app().inputQueue.push_back(event);
+}
+
+
+void App::framebufferSizeCallback(GLFWwindow* window, int width, int height){
+    // make sure the viewport matches the new window dimensions; note that width and
+    // height will be significantly larger than specified on retina displays.
+    if (app().resizeViewport)
+        glViewport(0, 0, width, height);
+    InputEvent event{InputEvent::FRAMEBUFFER_SIZE};
+    event.x = width;
+    event.y = height;
+    app().inputQueue.push_back(event);
+}
@@ -0,0 +1,90 @@
+#include "mesh_upload.h"
+#include "index_buffer.h"
+#include "mesh_file.h"
+#include "cpu_profiler.h"
+
+
+unsigned int createVertexArray(const std::vector<float> &positions, const std::vector<float> &colors,
+                               const std::vector<unsigned int> &indices, unsigned int program, GLenum &indexType){
+    unsigned int VAO;
+    glGenVertexArrays(1, &VAO);
+    // bind vertex array object
+    glBindVertexArray(VAO);
+
+    // set vertex shader attribute "pos"
+    createArrayBuffer(positions); // creates and bind the VBO
+    int posAttributeLocation = glGetAttribLocation(program, "pos");
+    glEnableVertexAttribArray(posAttributeLocation);
+    glVertexAttribPointer(posAttributeLocation, 3, GL_FLOAT, GL_FALSE, 0, 0);
+
+    // set vertex shader attribute "color"
+    createArrayBuffer(colors); // creates and bind the VBO
+    int colorAttributeLocation = glGetAttribLocation(program, "color");
+    glEnableVertexAttribArray(colorAttributeLocation);
+    glVertexAttribPointer(colorAttributeLocation, 4, GL_FLOAT, GL_FALSE, 0, 0);
+
+    // creates and bind the EBO
+    createElementArrayBuffer(indices, indexType);
+
+    return VAO;
+}
+
+unsigned int createVertexArray(const MappedMeshFile &mesh, unsigned int program){
+    unsigned int VAO;
+    glGenVertexArrays(1, &VAO);
+    // bind vertex array object
+    glBindVertexArray(VAO);
+
+    // set vertex shader attribute "pos"
+    createArrayBuffer(mesh.positionData(), mesh.vertexCount() * mesh.positionStride()); // creates and bind  the VBO
+    int posAttributeLocation = glGetAttribLocation(program, "pos");
+    glEnableVertexAttribArray(posAttributeLocation);
+    glVertexAttribPointer(posAttributeLocation, 3, mesh.positionType(), mesh.positionNormalized(), mesh.positionStride(), 0);
+
+    // set vertex shader attribute "color"
+    createArrayBuffer(mesh.colorData(), mesh.vertexCount() * mesh.colorStride()); // creates and bind the VBO
+    int colorAttributeLocation = glGetAttribLocation(program, "color");
+    glEnableVertexAttribArray(colorAttributeLocation);
+    glVertexAttribPointer(colorAttributeLocation, 4, mesh.colorType(), mesh.colorNormalized(), mesh.colorStride(), 0);
+
+    // creates and bind the EBO
+    createElementArrayBuffer(mesh.indexData(), mesh.indexCount(), mesh.indexType());
+
+    return VAO;
+}
+
+
+unsigned int createArrayBuffer(const void* data, unsigned int size){
+    CPU_SCOPE("createArrayBuffer");
+    unsigned int VBO;
+    glGenBuffers(1, &VBO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+
+    return VBO;
+}
+
+
+unsigned int createArrayBuffer(const std::vector<float> &array){
+    return createArrayBuffer(array.data(), (unsigned int) (array.size() * sizeof(GLfloat)));
+}
+
+
+unsigned int createElementArrayBuffer(const void* data, unsigned int count, GLenum type){
+    CPU_SCOPE("createElementArrayBuffer");
+    unsigned int EBO;
+    glGenBuffers(1, &EBO);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * indexTypeSize(type), data, GL_STATIC_DRAW);
+
+    return EBO;
+}
+
+
+unsigned int createElementArrayBuffer(const std::vector<unsigned int> &array, GLenum &type){
+    type = chooseIndexType(array.data(), (unsigned int) array.size());
+    std::vector<unsigned char> packed = packIndices(array.data(), (unsigned int) array.size(), type);
+    return createElementArrayBuffer(packed.data(), (unsigned int) array.size(), type);
+}
@@ -0,0 +1,28 @@
+#include "png_writer.h"
+
+#include <vector>
+#include <cstring>
+#include <iostream>
+
+// the encoder is compiled in this file only, static so that it does not clash with other copies of stb
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#define STB_IMAGE_WRITE_STATIC
+#include <stb_image_write.h>
+
+
+bool writePng(const std::string &path, unsigned int width, unsigned int height,
+              const unsigned char* rgba, bool flipVertically){
+    const unsigned int stride = width * 4;
+    std::vector<unsigned char> flipped;
+    if (flipVertically){
+        flipped.resize(stride * height);
+        for (unsigned int y = 0; y < height; y++)
+            std::memcpy(&flipped[y * stride], rgba + (height - 1 - y) * stride, stride);
+        rgba = flipped.data();
+    }
+    if (!stbi_write_png(path.c_str(), (int) width, (int) height, 4, rgba, (int) stride)){
+        std::cout << "ERROR::PNG_WRITER::CANNOT_WRITE " << path << std::endl;
+        return false;
+    }
+    return true;
+}
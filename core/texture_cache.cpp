@@ -0,0 +1,401 @@
+#include "texture_cache.h"
+
+#include <chrono>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#include "cpu_profiler.h"
+#include "atlas_packer.h"
+
+// the decoder is compiled in this file only, static so that it does not clash with other copies of stb_image
+// (assimp has one)
+#define STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_STATIC
+#include <stb_image.h>
+
+
+TextureCache &textureCache(){
+    static TextureCache instance;
+    return instance;
+}
+
+
+Texture::Entry::~Entry(){
+    if (texture)
+        glDeleteTextures(1, &texture);
+}
+
+unsigned int Texture::id() const{
+    if (!entry)
+        return 0;
+    return entry->texture ? entry->texture : entry->cache->placeholder;
+}
+
+const std::string &Texture::path() const{
+    static const std::string none;
+    return entry ? entry->path : none;
+}
+
+const std::vector<AtlasSprite> &Texture::sprites() const{
+    static const std::vector<AtlasSprite> none;
+    return entry ? entry->sprites : none;
+}
+
+std::vector<float> Texture::spriteRectData() const{
+    std::vector<float> data;
+    for (const AtlasSprite &sprite : sprites()){
+        data.push_back(sprite.u0);
+        data.push_back(sprite.v0);
+        data.push_back(sprite.u1);
+        data.push_back(sprite.v1);
+    }
+    return data;
+}
+
+
+Texture TextureCache::load(const std::string &path, const TextureOptions &options){
+    Job job;
+    job.path = path;
+    job.flipVertically = options.flipVertically;
+    return request(path, options, job);
+}
+
+
+Texture TextureCache::loadAtlas(const std::vector<std::string> &spritePaths, const TextureOptions &options,
+                                unsigned int padding){
+    // the atlas is named after its sprites, newlines don't appear in paths
+    std::string key = "atlas " + std::to_string(padding);
+    for (const std::string &path : spritePaths)
+        key += "\n" + path;
+    Job job;
+    job.path = key;
+    job.flipVertically = options.flipVertically;
+    job.spritePaths = spritePaths;
+    job.padding = padding;
+    return request(key, options, job);
+}
+
+
+Texture TextureCache::request(const std::string &path, const TextureOptions &options, Job job){
+    // an entry that is still referenced is shared, expired ones are replaced
+    auto found = entries.find(path);
+    if (found != entries.end()){
+        std::shared_ptr<Texture::Entry> entry = found->second.lock();
+        if (entry)
+            return Texture(entry);
+    }
+    if (!placeholder)
+        createPlaceholder();
+    if (workers.empty())
+        startWorkers();
+
+    std::shared_ptr<Texture::Entry> entry = std::make_shared<Texture::Entry>();
+    entry->cache = this;
+    entry->path = path;
+    entry->options = options;
+    entries[path] = entry;
+    requested++;
+    pending++;
+    job.entry = entry;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        jobs.push_back(std::move(job));
+    }
+    queueChanged.notify_one();
+    return Texture(entry);
+}
+
+
+void TextureCache::update(){
+    if (!pending)
+        return;
+    CPU_SCOPE("textureUpload");
+    size_t budget = 0;
+    while (budget < maxUploadBytesPerFrame){
+        DecodedImage image;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (decoded.empty())
+                return;
+            image = std::move(decoded.front());
+            decoded.pop_front();
+        }
+        budget += image.pixels.size();
+        upload(image);
+    }
+}
+
+
+void TextureCache::finishLoading(){
+    CPU_SCOPE("finishLoading");
+    // every job ends in the decoded queue, failed or not
+    while (pending){
+        DecodedImage image;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueChanged.wait(lock, [this]{ return !decoded.empty(); });
+            image = std::move(decoded.front());
+            decoded.pop_front();
+        }
+        upload(image);
+    }
+}
+
+
+unsigned int TextureCache::pendingCount() const{
+    return pending;
+}
+
+
+void TextureCache::release(){
+    stopWorkers();
+    for (auto &path : entries){
+        std::shared_ptr<Texture::Entry> entry = path.second.lock();
+        if (entry && entry->texture){
+            glDeleteTextures(1, &entry->texture);
+            entry->texture = 0;
+        }
+    }
+    entries.clear();
+    if (placeholder)
+        glDeleteTextures(1, &placeholder);
+    if (pixelBuffer)
+        glDeleteBuffers(1, &pixelBuffer);
+    placeholder = pixelBuffer = 0;
+}
+
+
+void TextureCache::printSummary(std::ostream &out) const{
+    if (!requested)
+        return;
+    std::lock_guard<std::mutex> lock(queueMutex);
+    out << "textures: " << uploaded << " loaded, " << failed << " failed, "
+        << (double) uploadedBytes / (1024.0 * 1024.0) << " MB uploaded, "
+        << (decodedCount ? decodeSeconds * 1000.0 / decodedCount : 0.0) << " ms average decode" << std::endl;
+}
+
+
+void TextureCache::startWorkers(){
+    stopping = false;
+    for (unsigned int i = 0; i < std::max(1u, workerCount); i++)
+        workers.emplace_back(&TextureCache::decodeImages, this);
+}
+
+
+void TextureCache::stopWorkers(){
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+        jobs.clear();
+        decoded.clear();
+    }
+    queueChanged.notify_all();
+    for (std::thread &worker : workers)
+        worker.join();
+    workers.clear();
+    pending = 0;
+}
+
+
+// decode threads
+void TextureCache::decodeImages(){
+    cpuProfiler().setThreadName("texture decoder");
+    std::unique_lock<std::mutex> lock(queueMutex);
+    while (true){
+        queueChanged.wait(lock, [this]{ return stopping || !jobs.empty(); });
+        if (stopping)
+            return;
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+
+        DecodedImage image;
+        image.entry = job.entry;
+        auto start = std::chrono::steady_clock::now();
+        // nobody holds the texture any more, the result is only needed to end the request
+        if (!job.entry.expired())
+            image.failed = job.spritePaths.empty() ? !decodeImage(job, image) : !buildAtlas(job, image);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        lock.lock();
+        decodeSeconds += seconds;
+        decodedCount++;
+        decoded.push_back(std::move(image));
+        // wakes finishLoading()
+        queueChanged.notify_all();
+    }
+}
+
+
+bool TextureCache::decodeImage(const Job &job, DecodedImage &image){
+    CPU_SCOPE("decodeImage");
+    int width, height, channels;
+    unsigned char* pixels = stbi_load(job.path.c_str(), &width, &height, &channels, 0);
+    if (!pixels){
+        std::cout << "ERROR::TEXTURE::CANNOT_LOAD " << job.path << " " << stbi_failure_reason() << std::endl;
+        return false;
+    }
+    image.width = (unsigned int) width;
+    image.height = (unsigned int) height;
+    image.channels = (unsigned int) channels;
+    size_t rowSize = (size_t) width * channels;
+    image.pixels.resize(rowSize * height);
+    for (int row = 0; row < height; row++){
+        int source = job.flipVertically ? height - 1 - row : row;
+        std::memcpy(&image.pixels[rowSize * row], pixels + rowSize * source, rowSize);
+    }
+    stbi_image_free(pixels);
+    return true;
+}
+
+
+// decodes the sprites, packs them with their padding and copies them into one RGBA image
+bool TextureCache::buildAtlas(const Job &job, DecodedImage &image){
+    CPU_SCOPE("buildAtlas");
+    struct Sprite {
+        unsigned char* pixels;
+        unsigned int width, height;
+    };
+    std::vector<Sprite> sprites;
+    std::vector<AtlasRect> rects;
+    bool ok = true;
+    for (const std::string &path : job.spritePaths){
+        int width, height, channels;
+        unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &channels, 4);
+        if (!pixels){
+            std::cout << "ERROR::TEXTURE::CANNOT_LOAD " << path << " " << stbi_failure_reason() << std::endl;
+            ok = false;
+            break;
+        }
+        sprites.push_back(Sprite{pixels, (unsigned int) width, (unsigned int) height});
+        AtlasRect rect;
+        rect.width = (unsigned int) width + 2 * job.padding;
+        rect.height = (unsigned int) height + 2 * job.padding;
+        rects.push_back(rect);
+    }
+    if (ok && !packAtlas(rects, MAX_ATLAS_SIZE, image.width, image.height)){
+        std::cout << "ERROR::TEXTURE::ATLAS_TOO_LARGE " << sprites.size() << " sprites don't fit in "
+                  << MAX_ATLAS_SIZE << "x" << MAX_ATLAS_SIZE << std::endl;
+        ok = false;
+    }
+
+    if (ok){
+        image.channels = 4;
+        image.pixels.assign((size_t) image.width * image.height * 4, 0);
+        for (size_t i = 0; i < sprites.size(); i++){
+            const Sprite &sprite = sprites[i];
+            const AtlasRect &rect = rects[i];
+            // every texel of the padded rectangle takes the closest texel of the sprite
+            for (unsigned int y = 0; y < rect.height; y++){
+                unsigned int row = (unsigned int) std::min(std::max((int) y - (int) job.padding, 0), (int) sprite.height - 1);
+                if (job.flipVertically)
+                    row = sprite.height - 1 - row;
+                unsigned char* target = &image.pixels[((size_t) (rect.y + y) * image.width + rect.x) * 4];
+                const unsigned char* source = sprite.pixels + (size_t) row * sprite.width * 4;
+                for (unsigned int x = 0; x < job.padding; x++)
+                    std::memcpy(target + x * 4, source, 4);
+                std::memcpy(target + job.padding * 4, source, (size_t) sprite.width * 4);
+                for (unsigned int x = job.padding + sprite.width; x < rect.width; x++)
+                    std::memcpy(target + x * 4, source + (sprite.width - 1) * 4, 4);
+            }
+
+            AtlasSprite region;
+            region.x = rect.x + job.padding;
+            region.y = rect.y + job.padding;
+            region.width = sprite.width;
+            region.height = sprite.height;
+            region.u0 = (float) region.x / image.width;
+            region.v0 = (float) region.y / image.height;
+            region.u1 = (float) (region.x + region.width) / image.width;
+            region.v1 = (float) (region.y + region.height) / image.height;
+            image.sprites.push_back(region);
+        }
+        // at mipmap level n the padding between two sprites is 2 * padding / 2^n texels
+        image.maxLevel = job.padding ? (unsigned int) std::log2((float) job.padding) : 0;
+    }
+
+    for (const Sprite &sprite : sprites)
+        stbi_image_free(sprite.pixels);
+    return ok;
+}
+
+
+// GL thread: copies the pixels into the pixel buffer and creates the texture from it, so glTexImage2D reads from
+// driver memory and returns without waiting for the copy to the GPU
+void TextureCache::upload(DecodedImage &image){
+    pending--;
+    std::shared_ptr<Texture::Entry> entry = image.entry.lock();
+    if (!entry)
+        return;
+    if (image.failed || image.pixels.empty()){
+        entry->failed = true;
+        failed++;
+        return;
+    }
+
+    static const GLenum formats[] = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
+    static const GLenum linearFormats[] = {GL_R8, GL_RG8, GL_RGB8, GL_RGBA8};
+    GLenum format = formats[image.channels - 1];
+    GLenum internalFormat = linearFormats[image.channels - 1];
+    if (entry->options.srgb && image.channels >= 3)
+        internalFormat = image.channels == 4 ? GL_SRGB8_ALPHA8 : GL_SRGB8;
+
+    if (!pixelBuffer)
+        glGenBuffers(1, &pixelBuffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+    // new storage for every image, the driver keeps the old one until the previous upload has read it
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr) image.pixels.size(), nullptr, GL_STREAM_DRAW);
+    void* data = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr) image.pixels.size(),
+                                  GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (!data){
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        std::cout << "ERROR::TEXTURE::MAP_FAILED " << entry->path << std::endl;
+        entry->failed = true;
+        failed++;
+        return;
+    }
+    std::memcpy(data, image.pixels.data(), image.pixels.size());
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    glGenTextures(1, &entry->texture);
+    glBindTexture(GL_TEXTURE_2D, entry->texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, (GLint) internalFormat, (GLsizei) image.width, (GLsizei) image.height, 0,
+                 format, GL_UNSIGNED_BYTE, nullptr);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    // gray and gray + alpha images are sampled as (gray, gray, gray, alpha), e.g. particle sprite masks
+    if (image.channels <= 2){
+        GLint swizzle[] = {GL_RED, GL_RED, GL_RED, (GLint) (image.channels == 2 ? GL_GREEN : GL_ONE)};
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, (GLint) entry->options.wrap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, (GLint) entry->options.wrap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, entry->options.mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    if (!image.sprites.empty())
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint) image.maxLevel);
+    if (entry->options.mipmaps)
+        glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    entry->width = image.width;
+    entry->height = image.height;
+    entry->sprites = std::move(image.sprites);
+    entry->ready = true;
+    uploaded++;
+    uploadedBytes += image.pixels.size();
+}
+
+
+void TextureCache::createPlaceholder(){
+    const unsigned char white[] = {255, 255, 255, 255};
+    glGenTextures(1, &placeholder);
+    glBindTexture(GL_TEXTURE_2D, placeholder);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
@@ -5,6 +5,8 @@
 #include <vector>
 #include <cmath>
 
+#include "cpu_profiler.h"
+
 
 // function declarations
 // ---------------------
@@ -168,6 +170,9 @@ int main()
 
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
+    // GP_CPU_TRACE=trace.json shows the per frame setupShape in a timeline
+    cpuProfiler().writeRequestedTrace();
+
     glfwTerminate();
     return 0;
 }
@@ -176,6 +181,7 @@ int main()
 // create a vertex buffer object (VBO) from an array of values, return VBO handle (set as reference)
 // -------------------------------------------------------------------------------------------------
 void createArrayBuffer(const std::vector<float> &array, unsigned int &VBO){
+    CPU_SCOPE("createArrayBuffer");
     // create the VBO on OpenGL and get a handle to it
     if (VBO == 0)
         glGenBuffers(1, &VBO);
@@ -191,6 +197,7 @@ void createArrayBuffer(const std::vector<float> &array, unsigned int &VBO){
 // create the geometry, a vertex array object representing it, and set how a shader program should read it
 // -------------------------------------------------------------------------------------------------------
 void setupShape(const unsigned int shaderProgram, float time, unsigned int &posVBO, unsigned int &colorVBO, unsigned int &VAO, unsigned int &vertexCount){
+    CPU_SCOPE("setupShape");
 
 
 
@@ -264,6 +271,7 @@ void draw(const unsigned int shaderProgram, const unsigned int VAO, const unsign
 // ---------------------------------------------------------------------------------------------------------
 void processInput(GLFWwindow *window)
 {
+    CPU_SCOPE("processInput");
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
 }
@@ -5,13 +5,15 @@
 #include <vector>
 #include <cmath>
 
+#include "index_buffer.h"
+
 
 // function declarations
 // ---------------------
-void setupShape(unsigned int shaderProgram, unsigned int &VAO, unsigned int &vertexCount);
-void draw(unsigned int shaderProgram, unsigned int VAO, unsigned int vertexCount);
-void createArrayBuffer(const std::vector<float> &array, const std::vector<GLint> &indices,
-                       unsigned int &VBO, unsigned int &EBO);
+void setupShape(unsigned int shaderProgram, unsigned int &VAO, unsigned int &vertexCount, GLenum &indexType);
+void draw(unsigned int shaderProgram, unsigned int VAO, unsigned int vertexCount, GLenum indexType);
+void createArrayBuffer(const std::vector<float> &array, const std::vector<unsigned int> &indices,
+                       unsigned int &VBO, unsigned int &EBO, GLenum &indexType);
 
 
 // glfw functions
@@ -131,9 +133,10 @@ int main()
     // setup vertex array object (VAO)
     // -------------------------------
     unsigned int VAO, vertexCount;
-    // generate geometry in a vertex array object (VAO), record the number of vertices in the mesh,
-    // tells the shader how to read it
-    setupShape(shaderProgram, VAO, vertexCount);
+    GLenum indexType;
+    // generate geometry in a vertex array object (VAO), record the number of vertices in the mesh and the type of
+    // its indices, tells the shader how to read it
+    setupShape(shaderProgram, VAO, vertexCount, indexType);
 
 
     // render loop
@@ -148,7 +151,7 @@ int main()
         glClearColor(.2f, .2f, .2f, 1.0f); // background
         glClear(GL_COLOR_BUFFER_BIT); // clear the framebuffer
 
-        draw(shaderProgram, VAO, vertexCount);
+        draw(shaderProgram, VAO, vertexCount, indexType);
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
@@ -163,10 +166,11 @@ int main()
 }
 
 
-// create a vertex buffer object (VBO) from an array of values, return VBO handle (set as reference)
+// create a vertex buffer object (VBO) from an array of values, return VBO handle (set as reference); the indices
+// are stored with the narrowest type that holds them (see index_buffer.h), returned in indexType
 // -------------------------------------------------------------------------------------------------
-void createArrayBuffer(const std::vector<float> &array, const std::vector<GLint> &indices,
-        unsigned int &VBO, unsigned int &EBO){
+void createArrayBuffer(const std::vector<float> &array, const std::vector<unsigned int> &indices,
+        unsigned int &VBO, unsigned int &EBO, GLenum &indexType){
     // create the VBO on OpenGL and get a handle to it
     glGenBuffers(1, &VBO);
     glGenBuffers(1, &EBO);
@@ -175,18 +179,20 @@ void createArrayBuffer(const std::vector<float> &array, const std::vector<GLint>
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
     // set the content of the VBO (type, size, pointer to start, and how it is used)
     glBufferData(GL_ARRAY_BUFFER, array.size() * sizeof(GLfloat), &array[0], GL_STATIC_DRAW);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLint), &indices[0], GL_STATIC_DRAW);
+    indexType = chooseIndexType(indices.data(), (unsigned int) indices.size());
+    std::vector<unsigned char> packedIndices = packIndices(indices.data(), (unsigned int) indices.size(), indexType);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, packedIndices.size(), packedIndices.data(), GL_STATIC_DRAW);
 }
 
 
 // create the geometry, a vertex array object representing it, and set how a shader program should read it
 // -------------------------------------------------------------------------------------------------------
-void setupShape(const unsigned int shaderProgram,unsigned int &VAO, unsigned int &vertexCount){
+void setupShape(const unsigned int shaderProgram,unsigned int &VAO, unsigned int &vertexCount, GLenum &indexType){
 
     unsigned int vertexDataVBO, vertexIndicesEBO;// posVBO, colorVBO;
 
     std::vector<float> vertexData;
-    std::vector<GLint> vertexIndices;
+    std::vector<unsigned int> vertexIndices;
 
     int triangleCount = 16;
     float PI = 3.14159265;
@@ -226,7 +232,7 @@ void setupShape(const unsigned int shaderProgram,unsigned int &VAO, unsigned int
         vertexIndices.push_back(i + 2);
     }
 
-    createArrayBuffer(vertexData, vertexIndices, vertexDataVBO, vertexIndicesEBO);
+    createArrayBuffer(vertexData, vertexIndices, vertexDataVBO, vertexIndicesEBO, indexType);
 
 
     // tell how many vertices to draw
@@ -263,13 +269,13 @@ void setupShape(const unsigned int shaderProgram,unsigned int &VAO, unsigned int
 
 // tell opengl to draw a vertex array object (VAO) using a give shaderProgram
 // --------------------------------------------------------------------------
-void draw(const unsigned int shaderProgram, const unsigned int VAO, const unsigned int vertexCount){
+void draw(const unsigned int shaderProgram, const unsigned int VAO, const unsigned int vertexCount, const GLenum indexType){
     // set active shader program
     glUseProgram(shaderProgram);
     // bind vertex array object
     glBindVertexArray(VAO);
     // draw geometry
-    glDrawElements(GL_TRIANGLES, vertexCount, GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLES, vertexCount, indexType, 0);
 }
 
 
@@ -1,18 +1,20 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
-#include <shader_s.h>
+#include <shader.h>
+#include "app.h"
 
 #include <iostream>
 #include <vector>
-#include <chrono>
 
 void bindAttributes();
 void createVertexBufferObject();
 void emitParticle(float x, float y, float velocityX, float velocityY, float currentTime);
-// glfw functions
-void framebufferSizeCallback(GLFWwindow* window, int width, int height);
-void processInput(GLFWwindow *window);
+void setup();
+void render();
+void shutdown();
+// input functions
+void processInput(float dt);
 
 // const settings
 const unsigned int SCR_WIDTH = 600;
@@ -28,40 +30,20 @@ const unsigned int sizeOfFloat = 4;             // bytes in a float
 unsigned int particleId = 0;                    // keep track of last particle to be updated
 Shader *shaderProgram;                          // our shader program
 
-int main()
+int main(int argc, char* argv[])
 {
-    // glfw: initialize and configure
-    // ------------------------------
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-#ifdef __APPLE__
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); // uncomment this statement to fix compilation on OS X
-#endif
-
-    // glfw window creation
-    // --------------------
-    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
-    if (window == NULL)
-    {
-        std::cout << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
-        return -1;
-    }
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
-
-
-    // glad: load all OpenGL function pointers
-    // ---------------------------------------
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
-    {
-        std::cout << "Failed to initialize GLAD" << std::endl;
-        return -1;
-    }
+    // the runtime creates the window and loads the OpenGL functions, or a headless context if asked on the
+    // command line, and runs the frames (see app.h); render every 20 ms
+    // ----------------------------------------------------------------------------------------------------
+    app().onSetup = setup;
+    app().onUpdate = processInput;
+    app().onRender = render;
+    app().onShutdown = shutdown;
+    app().frameInterval = 0.02f;
+    return app().run("LearnOpenGL", SCR_WIDTH, SCR_HEIGHT, argc, argv);
+}
 
+void setup(){
     // build and compile our shader program
     // ------------------------------------
     shaderProgram = new Shader("shader.vert", "shader.frag");
@@ -73,57 +55,28 @@ int main()
 
 
     createVertexBufferObject();
+}
 
-    // render every loopInterval seconds
-    float loopInterval = 0.02f;
-    auto begin = std::chrono::high_resolution_clock::now();
-
-    // render loop
-    // -----------
-    while (!glfwWindowShouldClose(window))
-    {
-        // update current time
-        auto frameStart = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<float> appTime = frameStart - begin;
-        currentTime = appTime.count();
-
-        // glfw input
-        processInput(window);
-
-        // set background color and replace frame buffer colors with the clear color
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        // set shader program and the uniform value "currentTime"
-        shaderProgram->use();
-        // TODO 2.3 set uniform variable related to current time
-
+void render(){
+    // set background color and replace frame buffer colors with the clear color
+    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
 
-        // render particles
-        glBindVertexArray(VAO);
-        glDrawArrays(GL_POINTS, 0, vertexBufferSize);
+    // set shader program and the uniform value "currentTime"
+    shaderProgram->use();
+    // TODO 2.3 set uniform variable related to current time
 
-        // show the frame buffer
-        glfwSwapBuffers(window);
-        glfwPollEvents();
 
-        // control render loop frequency
-        std::chrono::duration<float> elapsed = std::chrono::high_resolution_clock::now()-frameStart;
-        while (loopInterval > elapsed.count()) {
-            // busy waiting
-            elapsed = std::chrono::high_resolution_clock::now() - frameStart;
-        }
-    }
+    // render particles
+    glBindVertexArray(VAO);
+    glDrawArrays(GL_POINTS, 0, vertexBufferSize);
+}
 
+void shutdown(){
     // optional: de-allocate all resources once they've outlived their purpose:
     // ------------------------------------------------------------------------
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
-
-    // glfw: terminate, clearing all previously allocated GLFW resources.
-    // ------------------------------------------------------------------
-    glfwTerminate();
-    return 0;
 }
 
 void bindAttributes(){
@@ -169,16 +122,19 @@ void emitParticle(float x, float y, float velocityX, float velocityY, float time
 
 // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
 // ---------------------------------------------------------------------------------------------------------
-void processInput(GLFWwindow *window)
+void processInput(float dt)
 {
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-        glfwSetWindowShouldClose(window, true);
-    if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS) {
+    // update current time
+    currentTime = app().time();
+    // the input is read through inputReplay(), so that it can be recorded and replayed (see input_replay.h)
+    if (inputReplay().getKey(GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        app().close();
+    if (inputReplay().getMouseButton(GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS) {
         // get screen size and click coordinates
         double xPos, yPos;
         int xScreen, yScreen;
-        glfwGetCursorPos(window, &xPos, &yPos);
-        glfwGetWindowSize(window, &xScreen, &yScreen);
+        inputReplay().getCursorPos(&xPos, &yPos);
+        inputReplay().getWindowSize(&xScreen, &yScreen);
         // convert from screen space to normalized display coordinates
         float xNdc = (float) xPos/(float) xScreen * 2.0f -1.0f;
         float yNdc = (float) yPos/(float) yScreen * 2.0f -1.0f;
@@ -202,13 +158,3 @@ void processInput(GLFWwindow *window)
         lastY = yNdc;
     }
 }
-
-
-// glfw: whenever the window size changed (by OS or user resize) this callback function executes
-// ---------------------------------------------------------------------------------------------
-void framebufferSizeCallback(GLFWwindow* window, int width, int height)
-{
-    // make sure the viewport matches the new window dimensions; note that width and
-    // height will be significantly larger than specified on retina displays.
-    glViewport(0, 0, width, height);
-}
\ No newline at end of file
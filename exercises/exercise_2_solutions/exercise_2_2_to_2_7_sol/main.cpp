@@ -1,70 +1,105 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
-#include <shader_s.h>
+#include <shader.h>
+#include "app.h"
+#include "debug_ui.h"
+#include "perf_hud.h"
+#include "particle_emitters.h"
 
 #include <iostream>
 #include <vector>
-#include <chrono>
+#include <deque>
+#include <algorithm>
+#include <cmath>
 
 void bindAttributes();
 void createVertexBufferObject();
-void emitParticle(float x, float y, float velocityX, float velocityY, float currentTime);
-// glfw functions
-void framebufferSizeCallback(GLFWwindow* window, int width, int height);
-void processInput(GLFWwindow *window);
+void createEmitters();
+void uploadParticles();
+void moveCursor(float xNdc, float yNdc, bool emit);
+void expireParticles();
+void reserveParticles(unsigned int count);
+void growPool(unsigned int newCapacity);
+void drawAliveParticles();
+void setup();
+void update(float dt);
+void render();
+void shutdown();
+// input functions
+void processInput();
+void processScriptedInput();
 
 // const settings
 const unsigned int SCR_WIDTH = 600;
 const unsigned int SCR_HEIGHT = 600;
 
+// one particle in the vertex buffer, the attributes set in bindAttributes
+struct Particle {
+    float x, y;
+    float velocityX, velocityY;
+    float timeOfBirth;
+};
+
+// the cursor movement of this frame, read by the emitters
+struct CursorEmission {
+    float x = 0, y = 0;
+    float velocityX = 0, velocityY = 0;
+    bool emitting = false;
+};
+
 // application global variables
 float lastX, lastY;                             // used to compute delta movement of the mouse
 float currentTime;
 unsigned int VAO, VBO;                          // vertex array and buffer objects
-const unsigned int vertexBufferSize = 65536;    // # of particles
+unsigned int vertexBufferSize = 16384;          // # of particles in the pool, doubled when the alive ones fill it
+const unsigned int maxVertexBufferSize = 1 << 22;   // the oldest particles are overwritten beyond this
 const unsigned int particleSize = 5;            // particle attributes, TODO 2.2 update the number of attributes in a particle
 const unsigned int sizeOfFloat = 4;             // bytes in a float
+static_assert(sizeof(Particle) == particleSize * sizeOfFloat, "Particle must match the vertex attributes");
 unsigned int particleId = 0;                    // keep track of last particle to be updated
+int emissionRate = 10;                          // particles emitted per frame and emitter while the mouse button is pressed
+int emitterCount = 1;                           // emitters at the cursor, each with its own random generator
+int emitterThreads = (int) std::max(1u, std::thread::hardware_concurrency());
+ParticleEmitters<Particle> particleEmitters(1); // runs the emitters on emitterThreads threads
+CursorEmission cursor;
+const float particleMaxAge = 10.0f;             // maxAge in shader.vert
+std::deque<std::pair<float, unsigned int>> emissions;   // time and number of particles of the recent emissions
+unsigned int aliveCount = 0;                    // particles in emissions, the slots before particleId in the ring
 Shader *shaderProgram;                          // our shader program
+GLCallOverlay glCallOverlay;                    // GL calls per frame, shown when run with --gl-stats
+PerfHud perfHud;                                // frame times, counters and the emission rate slider
+bool debugUi = false;                           // ImGui windows, only with a window
 
-int main()
+int main(int argc, char* argv[])
 {
-    // glfw: initialize and configure
-    // ------------------------------
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-#ifdef __APPLE__
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); // uncomment this statement to fix compilation on OS X
-#endif
-
-    // glfw window creation
-    // --------------------
-    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
-    if (window == NULL)
-    {
-        std::cout << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
-        return -1;
-    }
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
-
+    // the runtime creates the window, or a headless context if asked on the command line, and runs the frames
+    // (see app.h); render every 20 ms
+    // -----------------------------------------------------------------------------------------------------
+    app().onSetup = setup;
+    app().onUpdate = update;
+    app().onRender = render;
+    app().onShutdown = shutdown;
+    app().frameInterval = 0.02f;
+    return app().run("LearnOpenGL", SCR_WIDTH, SCR_HEIGHT, argc, argv);
+}
 
-    // glad: load all OpenGL function pointers
-    // ---------------------------------------
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
-    {
-        std::cout << "Failed to initialize GLAD" << std::endl;
-        return -1;
-    }
+void setup(){
+    debugUi = app().window() != nullptr;
+    if (debugUi)
+        initDebugUi(app().window());
+    perfHud.addSlider("emission rate", &emissionRate, 0, 500);
+    perfHud.addSlider("emitters", &emitterCount, 1, 256, createEmitters);
+    perfHud.addSlider("emitter threads", &emitterThreads, 1, 32, []{ particleEmitters.setThreadCount((unsigned int) emitterThreads); });
+    particleEmitters.setThreadCount((unsigned int) emitterThreads);
+    createEmitters();
 
     // build and compile our shader program
     // ------------------------------------
-    shaderProgram = new Shader("shader.vert", "shader.frag");
+    {
+        CPU_SCOPE("compile shaders");
+        shaderProgram = new Shader("shader.vert", "shader.frag");
+    }
 
     // NEW!
     // enable built in variable gl_PointSize in the vertex shader
@@ -74,57 +109,61 @@ int main()
     glBlendFunc(GL_SRC_ALPHA, GL_DST_ALPHA);
 
     createVertexBufferObject();
+}
 
-    // render every loopInterval seconds
-    float loopInterval = 0.02f;
-    auto begin = std::chrono::high_resolution_clock::now();
+void update(float dt){
+    // update current time (a fixed step per frame when headless)
+    currentTime = app().time();
+    expireParticles();
+
+    // glfw input (or the replayed input of a recording), a scripted cursor when there is no window
+    if (app().window() || app().context().isReplaying())
+        processInput();
+    else
+        processScriptedInput();
+    uploadParticles();
+}
 
-    // render loop
-    // -----------
-    while (!glfwWindowShouldClose(window))
+void render(){
+    // set background color and replace frame buffer colors with the clear color
+    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
     {
-        // update current time
-        auto frameStart = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<float> appTime = frameStart - begin;
-        currentTime = appTime.count();
+        GPU_SCOPE("clear");
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
 
-        // glfw input
-        processInput(window);
+    // set shader program and the uniform value "currentTime"
+    shaderProgram->use();
+    // TODO 2.3 set uniform variable related to current time
+    shaderProgram->setFloat("currentTime", currentTime);
 
-        // set background color and replace frame buffer colors with the clear color
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
+    // render particles, the GPU time of the blended points is reported as "particles"
+    {
+        GPU_SCOPE("particles");
+        drawAliveParticles();
+    }
 
-        // set shader program and the uniform value "currentTime"
-        shaderProgram->use();
-        // TODO 2.3 set uniform variable related to current time
-        shaderProgram->setFloat("currentTime", currentTime);
-
-        // render particles
-        glBindVertexArray(VAO);
-        glDrawArrays(GL_POINTS, 0, vertexBufferSize);
-
-        // show the frame buffer
-        glfwSwapBuffers(window);
-        glfwPollEvents();
-
-        // control render loop frequency
-        std::chrono::duration<float> elapsed = std::chrono::high_resolution_clock::now()-frameStart;
-        while (loopInterval > elapsed.count()) {
-            // busy waiting
-            elapsed = std::chrono::high_resolution_clock::now() - frameStart;
-        }
+    // performance window, and the GL calls of the last frame (one upload of the emitted particles per frame)
+    if (debugUi) {
+        perfHud.newFrame();
+        perfHud.setCounter("particles", (double) aliveCount);
+        perfHud.setCounter("pool size", (double) vertexBufferSize);
+        perfHud.setBufferBytes(vertexBufferSize * particleSize * sizeOfFloat);
+        beginDebugUi();
+        perfHud.draw();
+        if (glCallCounter().isInstalled())
+            glCallOverlay.draw(glCallCounter());
+        endDebugUi();
     }
+}
 
+void shutdown(){
     // optional: de-allocate all resources once they've outlived their purpose:
     // ------------------------------------------------------------------------
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
-
-    // glfw: terminate, clearing all previously allocated GLFW resources.
-    // ------------------------------------------------------------------
-    glfwTerminate();
-    return 0;
+    if (debugUi)
+        shutdownDebugUi();
 }
 
 void bindAttributes(){
@@ -148,6 +187,7 @@ void bindAttributes(){
 }
 
 void createVertexBufferObject(){
+    CPU_SCOPE("createVertexBufferObject");
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
 
@@ -164,66 +204,175 @@ void createVertexBufferObject(){
     bindAttributes();
 }
 
-void emitParticle(float x, float y, float velocityX, float velocityY, float timeOfBirth){
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    float data[particleSize];
-            data[0] = x,
-            data[1] = y,
-            data[2] = velocityX,
-            data[3] = velocityY,
-            data[4] = timeOfBirth;
-    // TODO 2.2 , add velocity and timeOfBirth to the particle data
+// every emitter adds emissionRate particles around the cursor while it emits, on one of the emitter threads
+// -----------------------------------------------------------------------------------------------------------
+void createEmitters(){
+    particleEmitters.clear();
+    for (int emitter = 0; emitter < emitterCount; emitter++)
+        particleEmitters.add([](Pcg32 &random, std::vector<Particle> &out){
+            if (!cursor.emitting)
+                return;
+            for (int i = 0; i < emissionRate; i++) {
+                // add some randomness to the movement parameters
+                Particle particle;
+                particle.x = cursor.x + random.nextFloat(-.05f, .05f);
+                particle.y = cursor.y + random.nextFloat(-.05f, .05f);
+                particle.velocityX = cursor.velocityX + random.nextFloat(-.05f, .05f);
+                particle.velocityY = cursor.velocityY + random.nextFloat(-.05f, .05f);
+                particle.timeOfBirth = currentTime;
+                out.push_back(particle);
+            }
+        });
+}
+
 
-    // upload only parts of the buffer
-    glBufferSubData(GL_ARRAY_BUFFER, particleId * particleSize * sizeOfFloat, particleSize * sizeOfFloat, data);
-    particleId = (particleId + 1) % vertexBufferSize;
+// writes the particles of all the emitters after particleId, one upload per frame, two when the ring wraps
+// ----------------------------------------------------------------------------------------------------------
+void uploadParticles(){
+    const std::vector<Particle> &emitted = particleEmitters.emit();
+    if (emitted.empty())
+        return;
+    CPU_SCOPE("uploadParticles");
+    reserveParticles((unsigned int) emitted.size());
+    // only the newest particles fit when the pool can't grow anymore
+    unsigned int count = std::min((unsigned int) emitted.size(), vertexBufferSize);
+    const Particle* data = emitted.data() + (emitted.size() - count);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    unsigned int tail = std::min(count, vertexBufferSize - particleId);
+    glBufferSubData(GL_ARRAY_BUFFER, particleId * sizeof(Particle), tail * sizeof(Particle), data);
+    if (count > tail)
+        glBufferSubData(GL_ARRAY_BUFFER, 0, (count - tail) * sizeof(Particle), data + tail);
+    particleId = (particleId + count) % vertexBufferSize;
+
+    // the particles overwritten in a full pool are taken from the oldest emissions, so that they are not
+    // subtracted again when those emissions expire
+    unsigned int overwritten = aliveCount + count > vertexBufferSize ? aliveCount + count - vertexBufferSize : 0;
+    while (overwritten > 0 && !emissions.empty()){
+        unsigned int removed = std::min(overwritten, emissions.front().second);
+        emissions.front().second -= removed;
+        aliveCount -= removed;
+        overwritten -= removed;
+        if (emissions.front().second == 0)
+            emissions.pop_front();
+    }
+    emissions.emplace_back(currentTime, count);
+    aliveCount += count;
 }
 
 
 // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
 // ---------------------------------------------------------------------------------------------------------
-void processInput(GLFWwindow *window)
+void processInput()
 {
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-        glfwSetWindowShouldClose(window, true);
+    CPU_SCOPE("processInput");
+    // the input is read through inputReplay(), so that it can be recorded and replayed (see input_replay.h)
+    if (inputReplay().getKey(GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        app().close();
         // get screen size and click coordinates
     double xPos, yPos;
     int xScreen, yScreen;
-    glfwGetCursorPos(window, &xPos, &yPos);
-    glfwGetWindowSize(window, &xScreen, &yScreen);
+    inputReplay().getCursorPos(&xPos, &yPos);
+    inputReplay().getWindowSize(&xScreen, &yScreen);
     // convert from screen space to normalized display coordinates
     float xNdc = (float) xPos/(float) xScreen * 2.0f -1.0f;
     float yNdc = (float) yPos/(float) yScreen * 2.0f -1.0f;
     yNdc = -yNdc;
-    if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS) {
-        // compute velocity based on two consecutive updates
-        float velocityX = xNdc - lastX;
-        float velocityY = yNdc - lastY;
-        float max_rand = (float) (RAND_MAX);
-        // create 5 to 10 particles per frame
-        int i = (int) ((float) (rand()) / max_rand) * 5;
-        for (; i < 10; i++) {
-            // add some randomness to the movement parameters
-            float offsetX = ((float) (rand()) / max_rand - .5f) * .1f;
-            float offsetY = ((float) (rand()) / max_rand - .5f) * .1f;
-            float offsetVelX = ((float) (rand()) / max_rand - .5f) * .1f;
-            float offsetVelY = ((float) (rand()) / max_rand - .5f) * .1f;
-            // create the particle
-            emitParticle(xNdc + offsetX, yNdc + offsetY, velocityX + offsetVelX, velocityY + offsetVelY, currentTime);
-        }
-    }
+    moveCursor(xNdc, yNdc, inputReplay().getMouseButton(GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS);
+}
+
+
+// headless runs: the cursor draws a circle with the button pressed, so every run emits the same particles
+// --------------------------------------------------------------------------------------------------------
+void processScriptedInput()
+{
+    CPU_SCOPE("processScriptedInput");
+    moveCursor(.5f * cos(currentTime * 2.0f), .5f * sin(currentTime * 2.0f), true);
+}
+
+
+// the emitters emit along the cursor movement while emit is set
+// ---------------------------------------------------------------
+void moveCursor(float xNdc, float yNdc, bool emit)
+{
+    // compute velocity based on two consecutive updates
+    cursor.x = xNdc;
+    cursor.y = yNdc;
+    cursor.velocityX = xNdc - lastX;
+    cursor.velocityY = yNdc - lastY;
+    cursor.emitting = emit;
     lastX = xNdc;
     lastY = yNdc;
+}
+
 
+// all the particles live for particleMaxAge and are written in birth order, so the alive ones are the aliveCount
+// slots before particleId in the ring and the dead ones are never drawn
+// ---------------------------------------------------------------------------------------------------------------
+void expireParticles()
+{
+    while (!emissions.empty() && currentTime - emissions.front().first > particleMaxAge){
+        aliveCount -= emissions.front().second;
+        emissions.pop_front();
+    }
+    if (emissions.empty())
+        aliveCount = 0;
 }
 
 
-// glfw: whenever the window size changed (by OS or user resize) this callback function executes
-// ---------------------------------------------------------------------------------------------
-void framebufferSizeCallback(GLFWwindow* window, int width, int height)
+// grows the pool before count new particles would overwrite alive ones
+// ---------------------------------------------------------------------
+void reserveParticles(unsigned int count)
 {
-    // make sure the viewport matches the new window dimensions; note that width and
-    // height will be significantly larger than specified on retina displays.
-    glViewport(0, 0, width, height);
-}
\ No newline at end of file
+    unsigned int newCapacity = vertexBufferSize;
+    while (aliveCount + count > newCapacity && newCapacity < maxVertexBufferSize)
+        newCapacity *= 2;
+    if (newCapacity != vertexBufferSize)
+        growPool(newCapacity);
+}
+
+
+// copies the alive particles to the start of a larger buffer, the ring continues after them
+// ------------------------------------------------------------------------------------------
+void growPool(unsigned int newCapacity)
+{
+    CPU_SCOPE("growPool");
+    unsigned int newVBO;
+    glGenBuffers(1, &newVBO);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newVBO);
+    glBufferData(GL_COPY_WRITE_BUFFER, newCapacity * particleSize * sizeOfFloat, nullptr, GL_DYNAMIC_DRAW);
+
+    glBindBuffer(GL_COPY_READ_BUFFER, VBO);
+    unsigned int first = (particleId + vertexBufferSize - aliveCount) % vertexBufferSize;
+    unsigned int tail = std::min(aliveCount, vertexBufferSize - first);
+    const unsigned int stride = particleSize * sizeOfFloat;
+    if (tail > 0)
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, first * stride, 0, tail * stride);
+    if (aliveCount > tail)
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, tail * stride, (aliveCount - tail) * stride);
+
+    glDeleteBuffers(1, &VBO);
+    VBO = newVBO;
+    vertexBufferSize = newCapacity;
+    particleId = aliveCount % vertexBufferSize;
+
+    // the attributes of the VAO point to the buffer bound when they were set
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    bindAttributes();
+}
+
+
+// one draw of the alive range, two when it wraps around the end of the ring
+// --------------------------------------------------------------------------
+void drawAliveParticles()
+{
+    if (aliveCount == 0)
+        return;
+    glBindVertexArray(VAO);
+    unsigned int first = (particleId + vertexBufferSize - aliveCount) % vertexBufferSize;
+    unsigned int tail = std::min(aliveCount, vertexBufferSize - first);
+    glDrawArrays(GL_POINTS, (GLint) first, (GLsizei) tail);
+    if (aliveCount > tail)
+        glDrawArrays(GL_POINTS, 0, (GLsizei) (aliveCount - tail));
+}
@@ -3,12 +3,14 @@
 #include <iostream>
 #include <vector>
 #include <chrono>
-#include <shader_s.h>
+#include <shader.h>
+#include "app.h"
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "glmutils.h"
+#include "mesh_upload.h"
 
 // the plane model is stored in the file so that we do not need to deal with model loading yet
 #include "plane_model.h"
@@ -17,21 +19,19 @@
 struct SceneObject{
     unsigned int VAO;
     unsigned int vertexCount;
+    GLenum indexType;       // narrowest type of the indices, chosen by createVertexArray
 };
 
 // function declarations
 // ---------------------
-unsigned int createArrayBuffer(const std::vector<float> &array);
-unsigned int createElementArrayBuffer(const std::vector<unsigned int> &array);
-unsigned int createVertexArray(const std::vector<float> &positions, const std::vector<float> &colors, const std::vector<unsigned int> &indices);
 void setup();
+void render();
 void drawSceneObject(SceneObject obj);
 void drawPlane();
 
-// glfw functions
-// --------------
-void framebuffer_size_callback(GLFWwindow* window, int width, int height);
-void processInput(GLFWwindow *window);
+// input functions
+// ---------------
+void processInput(float dt);
 
 // settings
 // --------
@@ -44,7 +44,6 @@ SceneObject planeBody;
 SceneObject planeWing;
 SceneObject planePropeller;
 
-float currentTime;
 Shader* shaderProgram;
 
 // global variables used to set the plane and communicate
@@ -54,98 +53,34 @@ glm::vec2 planePosition = glm::vec2(0.0,0.0);
 float planeRotation = 0.0f;
 float tilt = 0;
 
-int main()
+int main(int argc, char* argv[])
 {
-    // glfw: initialize and configure
-    // ------------------------------
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-#ifdef __APPLE__
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); // uncomment this statement to fix compilation on OS X
-#endif
-
-    // glfw window creation
-    // --------------------
-    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Exercise 3", NULL, NULL);
-    if (window == NULL)
-    {
-        std::cout << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
-        return -1;
-    }
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-
-    // glad: load all OpenGL function pointers
-    // ---------------------------------------
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
-    {
-        std::cout << "Failed to initialize GLAD" << std::endl;
-        return -1;
-    }
-
-    // build and compile our shader program
-    // ------------------------------------
-    shaderProgram = new Shader("shader.vert", "shader.frag");
+    // the runtime creates the window, or a headless context if asked on the command line, and runs the frames
+    // (see app.h); render every 20 ms
+    // -----------------------------------------------------------------------------------------------------
+    app().onSetup = setup;
+    app().onUpdate = processInput;
+    app().onRender = render;
+    app().frameInterval = 0.02f;
+    return app().run("Exercise 3", SCR_WIDTH, SCR_HEIGHT, argc, argv);
+}
 
-    // the model was originally baked with lights for a left handed coordinate system, we are "fixing" the z-coordinate
-    // so we can work with a right handed coordinate system
-    invertModelZ(planeBodyVertices);
-    invertModelZ(planeWingVertices);
-    invertModelZ(planePropellerVertices);
 
-    // setup mesh objects
-    // ---------------------------------------
-    setup();
+void render(){
+    glClearColor(0.5f, 0.5f, 1.0f, 1.0f);
 
     // NEW!
-    // set up the z-buffer
-    glDepthRange(1,-1); // make the NDC a right handed coordinate system, with the camera pointing towards -z
-    glEnable(GL_DEPTH_TEST); // turn on z-buffer depth test
-    glDepthFunc(GL_LESS); // draws fragments that are closer to the screen in NDC
-
-
-    // render loop
-    // -----------
-    // render every loopInterval seconds
-    float loopInterval = 0.02f;
-    auto begin = std::chrono::high_resolution_clock::now();
-
-    while (!glfwWindowShouldClose(window))
+    // notice that we also need to clear the depth buffer (aka z-buffer) every new frame
     {
-        // update current time
-        auto frameStart = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<float> appTime = frameStart - begin;
-        currentTime = appTime.count();
-
-        processInput(window);
-
-        glClearColor(0.5f, 0.5f, 1.0f, 1.0f);
-
-        // NEW!
-        // notice that we also need to clear the depth buffer (aka z-buffer) every new frame
+        GPU_SCOPE("clear");
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
 
+    {
+        GPU_SCOPE("plane");
         shaderProgram->use();
         drawPlane();
-
-        glfwSwapBuffers(window);
-        glfwPollEvents();
-
-        // control render loop frequency
-        std::chrono::duration<float> elapsed = std::chrono::high_resolution_clock::now()-frameStart;
-        while (loopInterval > elapsed.count()) {
-            elapsed = std::chrono::high_resolution_clock::now() - frameStart;
-        }
     }
-
-    // glfw: terminate, clearing all previously allocated GLFW resources.
-    // ------------------------------------------------------------------
-    glfwTerminate();
-    return 0;
 }
 
 
@@ -183,7 +118,7 @@ void drawPlane(){
     glm::mat4 translateProp = glm::translate(0, 0.5, 0);
     glm::mat4 rotateProp = glm::rotateX(glm::half_pi<float>());
     glm::mat4 scaleHalf = glm::scale(0.5, 0.5, 0.5);
-    glm::mat4 animateProp = glm::rotateY(currentTime * 10);
+    glm::mat4 animateProp = glm::rotateY(app().time() * 10);
 
     // get the id of the uniform called model
     unsigned int uniformID = glGetUniformLocation(shaderProgram->ID, "model");
@@ -213,97 +148,64 @@ void drawPlane(){
 
 void drawSceneObject(SceneObject obj){
     glBindVertexArray(obj.VAO);
-    glDrawElements(GL_TRIANGLES,  obj.vertexCount, GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLES,  obj.vertexCount, obj.indexType, 0);
 }
 
 void setup(){
+    // build and compile our shader program
+    // ------------------------------------
+    {
+        CPU_SCOPE("compile shaders");
+        shaderProgram = new Shader("shader.vert", "shader.frag");
+    }
+
+    // the model was originally baked with lights for a left handed coordinate system, we are "fixing" the z-coordinate
+    // so we can work with a right handed coordinate system
+    invertModelZ(planeBodyVertices);
+    invertModelZ(planeWingVertices);
+    invertModelZ(planePropellerVertices);
+
+    // NEW!
+    // set up the z-buffer
+    glDepthRange(1,-1); // make the NDC a right handed coordinate system, with the camera pointing towards -z
+    glEnable(GL_DEPTH_TEST); // turn on z-buffer depth test
+    glDepthFunc(GL_LESS); // draws fragments that are closer to the screen in NDC
 
     // TODO 3.3 you will need to load one additional object.
 
     // initialize plane body mesh objects
-    planeBody.VAO = createVertexArray(planeBodyVertices, planeBodyColors, planeBodyIndices);
+    planeBody.VAO = createVertexArray(planeBodyVertices, planeBodyColors, planeBodyIndices, shaderProgram->ID, planeBody.indexType);
     planeBody.vertexCount = planeBodyIndices.size();
 
     // initialize plane wing mesh objects
-    planeWing.VAO = createVertexArray(planeWingVertices, planeWingColors, planeWingIndices);
+    planeWing.VAO = createVertexArray(planeWingVertices, planeWingColors, planeWingIndices, shaderProgram->ID, planeWing.indexType);
     planeWing.vertexCount = planeWingIndices.size();
 
     // initialize plane propeller mesh object
-    planePropeller.VAO = createVertexArray(planePropellerVertices, planePropellerColors, planePropellerIndices);
+    planePropeller.VAO = createVertexArray(planePropellerVertices, planePropellerColors, planePropellerIndices, shaderProgram->ID, planePropeller.indexType);
     planePropeller.vertexCount = planePropellerIndices.size();
 }
 
 
-unsigned int createVertexArray(const std::vector<float> &positions, const std::vector<float> &colors, const std::vector<unsigned int> &indices){
-    unsigned int VAO;
-    glGenVertexArrays(1, &VAO);
-    // bind vertex array object
-    glBindVertexArray(VAO);
-
-    // set vertex shader attribute "pos"
-    createArrayBuffer(positions); // creates and bind  the VBO
-    int posAttributeLocation = glGetAttribLocation(shaderProgram->ID, "pos");
-    glEnableVertexAttribArray(posAttributeLocation);
-    glVertexAttribPointer(posAttributeLocation, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-    // set vertex shader attribute "color"
-    createArrayBuffer(colors); // creates and bind the VBO
-    int colorAttributeLocation = glGetAttribLocation(shaderProgram->ID, "color");
-    glEnableVertexAttribArray(colorAttributeLocation);
-    glVertexAttribPointer(colorAttributeLocation, 4, GL_FLOAT, GL_FALSE, 0, 0);
-
-    // creates and bind the EBO
-    createElementArrayBuffer(indices);
-
-    return VAO;
-}
-
-unsigned int createArrayBuffer(const std::vector<float> &array){
-    unsigned int VBO;
-    glGenBuffers(1, &VBO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, array.size() * sizeof(GLfloat), &array[0], GL_STATIC_DRAW);
-
-    return VBO;
-}
-
-unsigned int createElementArrayBuffer(const std::vector<unsigned int> &array){
-    unsigned int EBO;
-    glGenBuffers(1, &EBO);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, array.size() * sizeof(unsigned int), &array[0], GL_STATIC_DRAW);
-
-    return EBO;
-}
-
 // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
 // ---------------------------------------------------------------------------------------------------------
-void processInput(GLFWwindow *window)
+void processInput(float dt)
 {
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-        glfwSetWindowShouldClose(window, true);
+    CPU_SCOPE("processInput");
+    // the input is read through inputReplay(), so that it can be recorded and replayed (see input_replay.h)
+    if (inputReplay().getKey(GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        app().close();
     // TODO 3.4 control the plane (turn left and right) using the A and D keys
     // you will need to read A and D key press inputs
     // if GLFW_KEY_A is GLFW_PRESS, plane turn left
     // if GLFW_KEY_D is GLFW_PRESS, plane turn right
     tilt =  0;
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) {
+    if (inputReplay().getKey(GLFW_KEY_A) == GLFW_PRESS) {
         planeRotation += 0.02f;
         tilt = -45;
     }
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) {
+    if (inputReplay().getKey(GLFW_KEY_D) == GLFW_PRESS) {
         planeRotation -= 0.02f;
         tilt = +45;
     }
 }
-
-// glfw: whenever the window size changed (by OS or user resize) this callback function executes
-// ---------------------------------------------------------------------------------------------
-void framebuffer_size_callback(GLFWwindow* window, int width, int height)
-{
-    // make sure the viewport matches the new window dimensions; note that width and
-    // height will be significantly larger than specified on retina displays.
-    glViewport(0, 0, width, height);
-}
\ No newline at end of file
@@ -3,13 +3,15 @@
 #include <iostream>
 
 #include <vector>
-#include <chrono>
 #include <shader.h>
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "glmutils.h"
+#include "mesh_upload.h"
+#include "app.h"
+#include "mesh_upload.h"
 
 #include "plane_model.h"
 #include "primitives.h"
@@ -20,15 +22,15 @@
 struct SceneObject{
     unsigned int VAO;
     unsigned int vertexCount;
+    GLenum indexType;       // narrowest type of the indices, chosen by createVertexArray
 };
 
 
 // function declarations
 // ---------------------
-unsigned int createArrayBuffer(const std::vector<float> &array);
-unsigned int createElementArrayBuffer(const std::vector<unsigned int> &array);
-unsigned int createVertexArray(const std::vector<float> &positions, const std::vector<float> &colors, const std::vector<unsigned int> &indices);
 void setup();
+void render();
+void shutdown();
 void drawSceneObject(SceneObject obj);
 void drawArrow();
 void drawPlane();
@@ -37,7 +39,7 @@ void drawPlane();
 // glfw and input functions
 // ------------------------
 void cursorInNdc(float screenX, float screenY, int screenW, int screenH, float &x, float &y);
-void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void handleInput(const InputEvent &event);
 void button_input_callback(GLFWwindow* window, int button, int action, int mods);
 void key_input_callback(GLFWwindow* window, int button, int other, int action, int mods);
 void cursor_input_callback(GLFWwindow* window, double posX, double posY);
@@ -58,105 +60,38 @@ Shader* shaderProgram;
 
 // global variables used for control
 // -----------------------------------
-float currentTime;
 glm::vec2 clickStart(0.0f), clickEnd(0.0f);
 
 // TODO 4.1 and 4.2 - global variables you might need
 
-int main()
+int main(int argc, char* argv[])
 {
-    // glfw: initialize and configure
-    // ------------------------------
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-#ifdef __APPLE__
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); // uncomment this statement to fix compilation on OS X
-#endif
-
-    // glfw window creation
-    // --------------------
-    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Exercise 4", NULL, NULL);
-    if (window == NULL)
-    {
-        std::cout << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
-        return -1;
-    }
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-    // NEW!
-    // callbacks for all inputs
-    glfwSetMouseButtonCallback(window, button_input_callback);
-    glfwSetCursorPosCallback(window, cursor_input_callback);
-    glfwSetKeyCallback(window, key_input_callback);
-
-    // glad: load all OpenGL function pointers
-    // ---------------------------------------
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
-    {
-        std::cout << "Failed to initialize GLAD" << std::endl;
-        return -1;
-    }
-
-    // the model was originally baked with lights for a left handed coordinate system, we are "fixing" the z-coordinate
-    // so we can work with a right handed coordinate system
-    invertModelZ(planeBodyVertices);
-    invertModelZ(planeWingVertices);
-    invertModelZ(planePropellerVertices);
-
-    // setup mesh objects
-    // ---------------------------------------
-    setup();
-
-    // set up the z-buffer
-    glDepthRange(1,-1); // make the NDC a right handed coordinate system, with the camera pointing towards -z
-    glEnable(GL_DEPTH_TEST); // turn on z-buffer depth test
-    glDepthFunc(GL_LESS); // draws fragments that are closer to the screen in NDC
-
-
-    // render loop
-    // -----------
-    // render every loopInterval seconds
-    float loopInterval = 0.02f;
-    auto begin = std::chrono::high_resolution_clock::now();
-
-    while (!glfwWindowShouldClose(window))
-    {
-        // update current time
-        auto frameStart = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<float> appTime = frameStart - begin;
-        currentTime = appTime.count();
-
-        glClearColor(0.5f, 0.5f, 1.0f, 1.0f);
-
-        // notice that we also need to clear the depth buffer (aka z-buffer) every new frame
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    // the runtime creates the window and loads the OpenGL functions, or a headless context if asked on the
+    // command line, and runs the frames (see app.h); render every 20 ms
+    // ----------------------------------------------------------------------------------------------------
+    app().onSetup = setup;
+    app().onInput = handleInput;
+    app().onRender = render;
+    app().onShutdown = shutdown;
+    app().frameInterval = 0.02f;
+    return app().run("Exercise 4", SCR_WIDTH, SCR_HEIGHT, argc, argv);
+}
 
-        shaderProgram->use();
-        // NEW!
-        // we now have a function to draw the arrow too
-        drawArrow();
-        drawPlane();
+void render(){
+    glClearColor(0.5f, 0.5f, 1.0f, 1.0f);
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+    // notice that we also need to clear the depth buffer (aka z-buffer) every new frame
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // control render loop frequency
-        std::chrono::duration<float> elapsed = std::chrono::high_resolution_clock::now()-frameStart;
-        while (loopInterval > elapsed.count()) {
-            elapsed = std::chrono::high_resolution_clock::now() - frameStart;
-        }
-    }
+    shaderProgram->use();
+    // NEW!
+    // we now have a function to draw the arrow too
+    drawArrow();
+    drawPlane();
+}
 
+void shutdown(){
     delete shaderProgram;
-
-    // glfw: terminate, clearing all previously allocated GLFW resources.
-    // ------------------------------------------------------------------
-    glfwTerminate();
-    return 0;
 }
 
 void drawArrow(){
@@ -186,7 +121,7 @@ void drawPlane(){
     // propeller,
     // half size -> make perpendicular to plane forward axis -> rotate around plane forward axis -> move to the tip of the plane
     glm::mat4 propeller = model * glm::translate(.0f, .5f, .0f) *
-                          glm::rotate(currentTime * 10.0f, glm::vec3(0.0,1.0,0.0)) *
+                          glm::rotate(app().time() * 10.0f, glm::vec3(0.0,1.0,0.0)) *
                           glm::rotate(glm::half_pi<float>(), glm::vec3(1.0,0.0,0.0)) *
                           glm::scale(.5f, .5f, .5f);
 
@@ -217,75 +152,40 @@ void drawPlane(){
 
 void drawSceneObject(SceneObject obj){
     glBindVertexArray(obj.VAO);
-    glDrawElements(GL_TRIANGLES,  obj.vertexCount, GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLES,  obj.vertexCount, obj.indexType, 0);
 }
 
 void setup(){
     // initialize shaders
     shaderProgram = new Shader("shader.vert", "shader.frag");
 
+    // the model was originally baked with lights for a left handed coordinate system, we are "fixing" the z-coordinate
+    // so we can work with a right handed coordinate system
+    invertModelZ(planeBodyVertices);
+    invertModelZ(planeWingVertices);
+    invertModelZ(planePropellerVertices);
+
+    // set up the z-buffer
+    glDepthRange(1,-1); // make the NDC a right handed coordinate system, with the camera pointing towards -z
+    glEnable(GL_DEPTH_TEST); // turn on z-buffer depth test
+    glDepthFunc(GL_LESS); // draws fragments that are closer to the screen in NDC
+
     // initialize plane body mesh objects
-    planeBody.VAO = createVertexArray(planeBodyVertices, planeBodyColors, planeBodyIndices);
+    planeBody.VAO = createVertexArray(planeBodyVertices, planeBodyColors, planeBodyIndices, shaderProgram->ID, planeBody.indexType);
     planeBody.vertexCount = planeBodyIndices.size();
 
     // initialize plane wing mesh objects
-    planeWing.VAO = createVertexArray(planeWingVertices, planeWingColors, planeWingIndices);
+    planeWing.VAO = createVertexArray(planeWingVertices, planeWingColors, planeWingIndices, shaderProgram->ID, planeWing.indexType);
     planeWing.vertexCount = planeWingIndices.size();
 
     // initialize plane wing mesh objects
-    planePropeller.VAO = createVertexArray(planePropellerVertices, planePropellerColors, planePropellerIndices);
+    planePropeller.VAO = createVertexArray(planePropellerVertices, planePropellerColors, planePropellerIndices, shaderProgram->ID, planePropeller.indexType);
     planePropeller.vertexCount = planePropellerIndices.size();
 
     // TODO 4.2 - load the arrow mesh
 }
 
 
-unsigned int createVertexArray(const std::vector<float> &positions, const std::vector<float> &colors, const std::vector<unsigned int> &indices){
-    unsigned int VAO;
-    glGenVertexArrays(1, &VAO);
-    // bind vertex array object
-    glBindVertexArray(VAO);
-
-    // set vertex shader attribute "pos"
-    createArrayBuffer(positions); // creates and bind  the VBO
-    int posAttributeLocation = glGetAttribLocation(shaderProgram->ID, "pos");
-    glEnableVertexAttribArray(posAttributeLocation);
-    glVertexAttribPointer(posAttributeLocation, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-    // set vertex shader attribute "color"
-    createArrayBuffer(colors); // creates and bind the VBO
-    int colorAttributeLocation = glGetAttribLocation(shaderProgram->ID, "color");
-    glEnableVertexAttribArray(colorAttributeLocation);
-    glVertexAttribPointer(colorAttributeLocation, 4, GL_FLOAT, GL_FALSE, 0, 0);
-
-    // creates and bind the EBO
-    createElementArrayBuffer(indices);
-
-    return VAO;
-}
-
-unsigned int createArrayBuffer(const std::vector<float> &array){
-    unsigned int VBO;
-    glGenBuffers(1, &VBO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, array.size() * sizeof(GLfloat), &array[0], GL_STATIC_DRAW);
-
-    return VBO;
-}
-
-unsigned int createElementArrayBuffer(const std::vector<unsigned int> &array){
-    unsigned int EBO;
-    glGenBuffers(1, &EBO);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, array.size() * sizeof(unsigned int), &array[0], GL_STATIC_DRAW);
-
-    return EBO;
-}
-
-
-
 void cursorInNdc(float screenX, float screenY, int screenW, int screenH, float &x, float &y){
     float xNdc = (float) screenX / (float) screenW * 2.0f - 1.0f;
     float yNdc = (float) screenY / (float) screenH * 2.0f - 1.0f;
@@ -295,9 +195,9 @@ void cursorInNdc(float screenX, float screenY, int screenW, int screenH, float &
 
 
 void cursor_input_callback(GLFWwindow* window, double posX, double posY){
-    if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS){
+    if (inputReplay().getMouseButton(GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS){
         int screenW, screenH;
-        glfwGetWindowSize(window, &screenW, &screenH);
+        inputReplay().getWindowSize(&screenW, &screenH);
         cursorInNdc(posX, posY, screenW, screenH, clickEnd.x, clickEnd.y);
     }
 }
@@ -306,8 +206,8 @@ void cursor_input_callback(GLFWwindow* window, double posX, double posY){
 void button_input_callback(GLFWwindow* window, int button, int action, int mods){
     double screenX, screenY;
     int screenW, screenH;
-    glfwGetCursorPos(window, &screenX, &screenY);
-    glfwGetWindowSize(window, &screenW, &screenH);
+    inputReplay().getCursorPos(&screenX, &screenY);
+    inputReplay().getWindowSize(&screenW, &screenH);
 
     // TODO 4.1 and 4.2 - you may wish to update some of your global variables here
 
@@ -329,14 +229,17 @@ void button_input_callback(GLFWwindow* window, int button, int action, int mods)
 
 void key_input_callback(GLFWwindow* window, int button, int other,int action, int mods){
     if (button == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
-        glfwSetWindowShouldClose(window, true);
+        app().close();
 }
 
-// glfw: whenever the window size changed (by OS or user resize) this callback function executes
-// ---------------------------------------------------------------------------------------------
-void framebuffer_size_callback(GLFWwindow* window, int width, int height)
-{
-    // make sure the viewport matches the new window dimensions; note that width and
-    // height will be significantly larger than specified on retina displays.
-    glViewport(0, 0, width, height);
-}
\ No newline at end of file
+
+// the input events of the frame, passed on to the glfw callbacks above (the window is null in headless replays)
+// -------------------------------------------------------------------------------------------------------------
+void handleInput(const InputEvent &event){
+    if (event.type == InputEvent::MOUSE_BUTTON)
+        button_input_callback(app().window(), event.key, event.action, event.mods);
+    else if (event.type == InputEvent::CURSOR_POS)
+        cursor_input_callback(app().window(), event.x, event.y);
+    else if (event.type == InputEvent::KEY)
+        key_input_callback(app().window(), event.key, event.scancode, event.action, event.mods);
+}
@@ -3,13 +3,15 @@
 #include <iostream>
 
 #include <vector>
-#include <chrono>
 #include <shader.h>
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "glmutils.h"
+#include "mesh_upload.h"
+#include "app.h"
+#include "mesh_upload.h"
 
 #include "primitives.h"
 
@@ -18,22 +20,22 @@
 struct SceneObject{
     unsigned int VAO;
     unsigned int vertexCount;
+    GLenum indexType;       // narrowest type of the indices, chosen by createVertexArray
 };
 
 // function declarations
 // ---------------------
-unsigned int createArrayBuffer(const std::vector<float> &array);
-unsigned int createElementArrayBuffer(const std::vector<unsigned int> &array);
-unsigned int createVertexArray(const std::vector<float> &positions, const std::vector<float> &colors, const std::vector<unsigned int> &indices);
 void setup();
+void render();
+void shutdown();
 void drawSceneObject(SceneObject obj);
 void drawObject();
 
 // glfw and input functions
 // ------------------------
-void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void handleInput(const InputEvent &event);
 void button_input_callback(GLFWwindow* window, int button, int action, int mods);
-void processInput(GLFWwindow *window);
+void processInput(float dt);
 
 // screen settings
 // ---------------
@@ -47,94 +49,36 @@ Shader* shaderProgram;
 
 // global variables used for control
 // ---------------------------------
-float currentTime;
 glm::vec3 clickStart(0.0f), clickEnd(0.0f);
 glm::mat4 storedRotation(1.0f);
 
 
-int main()
+int main(int argc, char* argv[])
 {
-    // glfw: initialize and configure
-    // ------------------------------
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-#ifdef __APPLE__
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); // uncomment this statement to fix compilation on OS X
-#endif
-
-    // glfw window creation
-    // --------------------
-    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Exercise 4", NULL, NULL);
-    if (window == NULL)
-    {
-        std::cout << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
-        return -1;
-    }
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-    glfwSetMouseButtonCallback(window, button_input_callback);
-
-    // glad: load all OpenGL function pointers
-    // ---------------------------------------
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
-    {
-        std::cout << "Failed to initialize GLAD" << std::endl;
-        return -1;
-    }
-
-    // setup mesh objects
-    // ---------------------------------------
-    setup();
-
-    // set up the z-buffer
-    glDepthRange(1,-1); // make the NDC a right handed coordinate system, with the camera pointing towards -z
-    glEnable(GL_DEPTH_TEST); // turn on z-buffer depth test
-    glDepthFunc(GL_LESS); // draws fragments that are closer to the screen in NDC
-
-
-    // render loop
-    // -----------
-    // render every loopInterval seconds
-    float loopInterval = 0.02f;
-    auto begin = std::chrono::high_resolution_clock::now();
-
-    while (!glfwWindowShouldClose(window))
-    {
-        // update current time
-        auto frameStart = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<float> appTime = frameStart - begin;
-        currentTime = appTime.count();
-
-        processInput(window);
-
-        glClearColor(0.6f, 0.6f, 0.6f, 1.0f);
-
-        // notice that we also need to clear the depth buffer (aka z-buffer) every new frame
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    // the runtime creates the window and loads the OpenGL functions, or a headless context if asked on the
+    // command line, and runs the frames (see app.h); render every 20 ms
+    // ----------------------------------------------------------------------------------------------------
+    app().onSetup = setup;
+    app().onInput = handleInput;
+    app().onUpdate = processInput;
+    app().onRender = render;
+    app().onShutdown = shutdown;
+    app().frameInterval = 0.02f;
+    return app().run("Exercise 4", SCR_WIDTH, SCR_HEIGHT, argc, argv);
+}
 
-        shaderProgram->use();
-        drawObject();
+void render(){
+    glClearColor(0.6f, 0.6f, 0.6f, 1.0f);
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+    // notice that we also need to clear the depth buffer (aka z-buffer) every new frame
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // control render loop frequency
-        std::chrono::duration<float> elapsed = std::chrono::high_resolution_clock::now()-frameStart;
-        while (loopInterval > elapsed.count()) {
-            elapsed = std::chrono::high_resolution_clock::now() - frameStart;
-        }
-    }
+    shaderProgram->use();
+    drawObject();
+}
 
+void shutdown(){
     delete shaderProgram;
-
-    // glfw: terminate, clearing all previously allocated GLFW resources.
-    // ------------------------------------------------------------------
-    glfwTerminate();
-    return 0;
 }
 
 glm::mat4 trackballRotation(){
@@ -189,68 +133,28 @@ void drawObject(){
 
 void drawSceneObject(SceneObject obj){
     glBindVertexArray(obj.VAO);
-    glDrawElements(GL_TRIANGLES,  obj.vertexCount, GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLES,  obj.vertexCount, obj.indexType, 0);
 }
 
 void setup(){
     // initialize shaders
     shaderProgram = new Shader("shader.vert", "shader.frag");
 
-    cube.VAO = createVertexArray(cubeVertices, cubeColors, cubeIndices);
-    cube.vertexCount = cubeIndices.size();
-}
-
-
-unsigned int createVertexArray(const std::vector<float> &positions, const std::vector<float> &colors, const std::vector<unsigned int> &indices){
-    unsigned int VAO;
-    glGenVertexArrays(1, &VAO);
-    // bind vertex array object
-    glBindVertexArray(VAO);
-
-    // set vertex shader attribute "pos"
-    createArrayBuffer(positions); // creates and bind the VBO
-    int posAttributeLocation = glGetAttribLocation(shaderProgram->ID, "pos");
-    glEnableVertexAttribArray(posAttributeLocation);
-    glVertexAttribPointer(posAttributeLocation, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-    // set vertex shader attribute "color"
-    createArrayBuffer(colors); // creates and bind the VBO
-    int colorAttributeLocation = glGetAttribLocation(shaderProgram->ID, "color");
-    glEnableVertexAttribArray(colorAttributeLocation);
-    glVertexAttribPointer(colorAttributeLocation, 4, GL_FLOAT, GL_FALSE, 0, 0);
-
-    // creates and bind the EBO
-    createElementArrayBuffer(indices);
-
-    return VAO;
-}
-
-unsigned int createArrayBuffer(const std::vector<float> &array){
-    unsigned int VBO;
-    glGenBuffers(1, &VBO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, array.size() * sizeof(GLfloat), &array[0], GL_STATIC_DRAW);
-
-    return VBO;
-}
-
-unsigned int createElementArrayBuffer(const std::vector<unsigned int> &array){
-    unsigned int EBO;
-    glGenBuffers(1, &EBO);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, array.size() * sizeof(unsigned int), &array[0], GL_STATIC_DRAW);
+    // set up the z-buffer
+    glDepthRange(1,-1); // make the NDC a right handed coordinate system, with the camera pointing towards -z
+    glEnable(GL_DEPTH_TEST); // turn on z-buffer depth test
+    glDepthFunc(GL_LESS); // draws fragments that are closer to the screen in NDC
 
-    return EBO;
+    cube.VAO = createVertexArray(cubeVertices, cubeColors, cubeIndices, shaderProgram->ID, cube.indexType);
+    cube.vertexCount = cubeIndices.size();
 }
 
 
-void cursorInNdc(GLFWwindow* window, float &x, float &y){
+void cursorInNdc(float &x, float &y){
     double xPos, yPos;
     int xScreen, yScreen;
-    glfwGetCursorPos(window, &xPos, &yPos);
-    glfwGetWindowSize(window, &xScreen, &yScreen);
+    inputReplay().getCursorPos(&xPos, &yPos);
+    inputReplay().getWindowSize(&xScreen, &yScreen);
     float xNdc = (float) xPos / (float) xScreen * 2.0f - 1.0f;
     float yNdc = (float) yPos / (float) yScreen * 2.0f - 1.0f;
     yNdc = -yNdc;
@@ -261,13 +165,13 @@ void cursorInNdc(GLFWwindow* window, float &x, float &y){
 
 
 
-void processInput(GLFWwindow *window)
+void processInput(float dt)
 {
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-        glfwSetWindowShouldClose(window, true);
+    if (inputReplay().getKey(GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        app().close();
 
-    if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS){
-        cursorInNdc(window, clickEnd.x, clickEnd.y);
+    if (inputReplay().getMouseButton(GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS){
+        cursorInNdc(clickEnd.x, clickEnd.y);
     }
 }
 
@@ -275,10 +179,10 @@ void processInput(GLFWwindow *window)
 
 void button_input_callback(GLFWwindow* window, int button, int action, int mods){
     if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
-        cursorInNdc(window, clickStart.x, clickStart.y);
+        cursorInNdc(clickStart.x, clickStart.y);
     }
     if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_RELEASE) {
-        cursorInNdc(window, clickEnd.x, clickEnd.y);
+        cursorInNdc(clickEnd.x, clickEnd.y);
         // store current rotation at the end of a click
         storedRotation = trackballRotation() * storedRotation;
         // reset click positions
@@ -287,12 +191,9 @@ void button_input_callback(GLFWwindow* window, int button, int action, int mods)
 }
 
 
-
-// glfw: whenever the window size changed (by OS or user resize) this callback function executes
-// ---------------------------------------------------------------------------------------------
-void framebuffer_size_callback(GLFWwindow* window, int width, int height)
-{
-    // make sure the viewport matches the new window dimensions; note that width and
-    // height will be significantly larger than specified on retina displays.
-    glViewport(0, 0, width, height);
-}
\ No newline at end of file
+// the input events of the frame, passed on to the glfw callbacks above (the window is null in headless replays)
+// -------------------------------------------------------------------------------------------------------------
+void handleInput(const InputEvent &event){
+    if (event.type == InputEvent::MOUSE_BUTTON)
+        button_input_callback(app().window(), event.key, event.action, event.mods);
+}
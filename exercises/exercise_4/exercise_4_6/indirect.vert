@@ -0,0 +1,11 @@
+#version 330 core
+layout (location = 0) in vec3 pos;
+layout (location = 1) in vec4 color;
+layout (location = 2) in mat4 instanceModel; // per instance, takes locations 2 to 5
+out vec4 vtxColor;
+
+void main()
+{
+   gl_Position = instanceModel * vec4(pos, 1.0);
+   vtxColor = color;
+}
\ No newline at end of file
@@ -4,40 +4,84 @@
 
 #include <vector>
 #include <chrono>
+#include <algorithm>
+#include <cstring>
 
 #include "shader.h"
 #include "glmutils.h"
-
-#include "plane_model.h"
-#include "primitives.h"
+#include "mesh_upload.h"
+#include "bounds.h"
+#include "frustum_culling.h"
+#include "render_queue.h"
+#include "mesh_buffer.h"
+#include "indirect_draw.h"
+#include "lod_selection.h"
+#include "gpu_profiler.h"
+#include "cpu_profiler.h"
+#include "debug_ui.h"
+#include "perf_hud.h"
+#include "app.h"
+
+#include "mesh_file.h"
+
+// draws are collected in a render queue, sorted and then submitted through a cache of the GL state
+// ------------------------------------------------------------------------------------------------
+RenderQueue renderQueue;
+RenderStateCache stateCache;
+
+// alternatively, all meshes share one buffer and are drawn with a single indirect draw call (--indirect)
+// -----------------------------------------------------------------------------------------------------
+bool useIndirectDraw = false;
+SharedMeshBuffer sharedMeshes;
+IndirectDrawBatch indirectBatch;
 
 // structure to hold render info
 // -----------------------------
 struct SceneObject{
     unsigned int VAO;
     unsigned int vertexCount;
-    void drawSceneObject() const{
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES,  vertexCount, GL_UNSIGNED_INT, 0);
+    GLenum indexType = GL_UNSIGNED_INT;    // narrowest type that fits the mesh, see index_buffer.h
+    MeshRange lods[MAX_MESH_LODS];  // levels of detail, in the element buffer of VAO or in sharedMeshes
+    unsigned int lodCount = 1;
+    AABB bounds;                // mesh bounds in model space
+    BoundingSphere sphere;
+    glm::mat4 dequantization = glm::mat4(1.0f); // decodes quantized positions, identity for float meshes
+    // queue a draw of the object at the given level of detail, model transforms from model space to clip space
+    void drawSceneObject(unsigned int program, const glm::mat4 &model, int lod = 0) const{
+        const MeshRange &range = lods[lod < (int) lodCount ? lod : lodCount - 1];
+        // the shared buffer holds decoded float positions, see setup
+        if (useIndirectDraw){
+            indirectBatch.add(range, model);
+            return;
+        }
+        // the bounding sphere is in model space, before the dequantization
+        glm::vec4 clipCenter = model * glm::vec4(sphere.center, 1.0f);
+        float depth = clipCenter.w > 0.0f ? clipCenter.z / clipCenter.w * .5f + .5f : 0.0f;
+        renderQueue.submit(DrawPacket{makeSortKey(program, VAO, depth), program, VAO,
+                                      range.firstIndex, range.indexCount, indexType, model * dequantization});
     }
 };
 
 // function declarations
 // ---------------------
-unsigned int createArrayBuffer(const std::vector<float> &array);
-unsigned int createElementArrayBuffer(const std::vector<unsigned int> &array);
-unsigned int createVertexArray(const std::vector<float> &positions, const std::vector<float> &colors, const std::vector<unsigned int> &indices);
 void setup();
+void update(float dt);
+void render();
+void shutdown();
 void drawObjects();
+void parseOptions(int argc, char* argv[]);
 
 // glfw and input functions
 // ------------------------
 void cursorInRange(float screenX, float screenY, int screenW, int screenH, float min, float max, float &x, float &y);
-void framebuffer_size_callback(GLFWwindow* window, int width, int height);
-void processInput(GLFWwindow* window);
+void handleInput(const InputEvent &event);
+void processInput(float dt);
 void cursor_input_callback(GLFWwindow* window, double posX, double posY);
-void drawCube(glm::mat4 model);
-void drawPlane(glm::mat4 model);
+void drawCube(glm::mat4 model, int lod);
+void drawPlane(glm::mat4 model, int lod);
+void addWorldObject(int type, const glm::mat4 &model);
+unsigned int worldObjectLodCount(int type);
+void placeWorldObjects();
 
 // screen settings
 // ---------------
@@ -52,6 +96,31 @@ SceneObject planeBody;
 SceneObject planeWing;
 SceneObject planePropeller;
 Shader* shaderProgram;
+Shader* indirectShaderProgram = nullptr;
+
+// global variables used for culling
+// ---------------------------------
+enum WorldObjectType { FLOOR, CUBE, PLANE };
+struct WorldObject{
+    int type;                   // WorldObjectType
+    glm::mat4 model;
+    int lod = 0;                // level of detail used in the last frame
+};
+std::vector<WorldObject> worldObjects;
+std::vector<AABB> worldBounds;              // world space bounds of each entry in worldObjects
+std::vector<unsigned int> visibleObjects;   // indices in worldObjects, filled every frame
+FrustumCuller frustumCuller;
+BoundingVolumeHierarchy worldBVH;
+CullingStats cullingStats;
+AABB planeBounds;               // encloses all the parts of a plane, including the spinning propeller
+bool useBVH = false;                        // use the hierarchy instead of the flat list, for very large worlds (--bvh)
+int extraCubeCount = 0;                     // additional cubes scattered in the world, to stress test culling
+
+// global variables used for the level of detail selection
+// -------------------------------------------------------
+const bool useLods = true;
+LodSelector lodSelector;
+unsigned int lodObjectCounts[MAX_MESH_LODS];    // visible objects at each level, in the last frame
 
 // global variables used for control
 // ---------------------------------
@@ -59,98 +128,86 @@ float currentTime;
 glm::vec3 camForward(.0f, .0f, -1.0f);
 glm::vec3 camPosition(.0f, 1.6f, 0.0f);
 float linearSpeed = 0.15f, rotationGain = 30.0f;
+bool cursorCaptured = true;     // the mouse turns the camera, TAB releases the cursor to use the performance window
+
+// performance window, the extra cube count can be changed there while the exercise runs
+// -------------------------------------------------------------------------------------
+PerfHud perfHud;
 
 
-int main()
+int main(int argc, char* argv[])
 {
-    // glfw: initialize and configure
-    // ------------------------------
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-#ifdef __APPLE__
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); // uncomment this statement to fix compilation on OS X
-#endif
-
-    // glfw window creation
-    // --------------------
-    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Exercise 4", NULL, NULL);
-    if (window == NULL)
-    {
-        std::cout << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
-        return -1;
-    }
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-    glfwSetCursorPosCallback(window, cursor_input_callback);
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-
-    // glad: load all OpenGL function pointers
-    // ---------------------------------------
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
-    {
-        std::cout << "Failed to initialize GLAD" << std::endl;
-        return -1;
-    }
+    // the runtime creates the window and loads the OpenGL functions, or a headless context if asked on the
+    // command line, and runs the frames (see app.h); render every 20 ms
+    // ----------------------------------------------------------------------------------------------------
+    app().onSetup = setup;
+    app().onInput = handleInput;
+    app().onUpdate = update;
+    app().onRender = render;
+    app().onShutdown = shutdown;
+    app().frameInterval = 0.02f;
+    parseOptions(argc, argv);
+    return app().run("Exercise 4", SCR_WIDTH, SCR_HEIGHT, argc, argv);
+}
 
-    // setup mesh objects
-    // ---------------------------------------
-    setup();
 
-    // set up the z-buffer
-    glDepthRange(-1,1); // make the NDC a right handed coordinate system, with the camera pointing towards -z
-    glEnable(GL_DEPTH_TEST); // turn on z-buffer depth test
-    glDepthFunc(GL_LESS); // draws fragments that are closer to the screen in NDC
+void update(float dt){
+    currentTime = app().time();
+    processInput(dt);
+
+    // report the culling counters of the last frame once per second
+    static float lastStatsTime = 0;
+    if (currentTime - lastStatsTime > 1.0f){
+        lastStatsTime = currentTime;
+        std::cout << "culling: tested " << cullingStats.tested << ", culled " << cullingStats.culled
+                  << ", drawn " << cullingStats.drawn << std::endl;
+        std::cout << "objects per lod:";
+        for (unsigned int count : lodObjectCounts)
+            std::cout << " " << count;
+        std::cout << std::endl;
+        if (useIndirectDraw)
+            indirectBatch.printStats(std::cout);
+        else
+            stateCache.printStats(std::cout);
+        // GPU time of the last second
+        gpuProfiler().printStats(std::cout);
+        gpuProfiler().resetStats();
+    }
+}
 
 
-    // render loop
-    // -----------
-    // render every loopInterval seconds
-    float loopInterval = 0.02f;
-    auto begin = std::chrono::high_resolution_clock::now();
+void render(){
+    glClearColor(0.3f, 0.3f, 0.3f, 1.0f);
 
-    while (!glfwWindowShouldClose(window))
+    // notice that we also need to clear the depth buffer (aka z-buffer) every new frame
     {
-        // update current time
-        auto frameStart = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<float> appTime = frameStart - begin;
-        currentTime = appTime.count();
-
-        processInput(window);
-
-        glClearColor(0.3f, 0.3f, 0.3f, 1.0f);
-
-        // notice that we also need to clear the depth buffer (aka z-buffer) every new frame
+        GPU_SCOPE("clear");
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
 
-        shaderProgram->use();
-        drawObjects();
-
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+    drawObjects();
 
-        // control render loop frequency
-        std::chrono::duration<float> elapsed = std::chrono::high_resolution_clock::now()-frameStart;
-        while (loopInterval > elapsed.count()) {
-            elapsed = std::chrono::high_resolution_clock::now() - frameStart;
-        }
+    if (app().window()) {
+        perfHud.newFrame();
+        perfHud.setCounter("objects", (double) worldObjects.size());
+        perfHud.setCounter("visible", (double) cullingStats.drawn);
+        beginDebugUi();
+        perfHud.draw();
+        endDebugUi();
     }
+}
 
-    delete shaderProgram;
 
-    // glfw: terminate, clearing all previously allocated GLFW resources.
-    // ------------------------------------------------------------------
-    glfwTerminate();
-    return 0;
+void shutdown(){
+    delete shaderProgram;
+    delete indirectShaderProgram;
+    if (app().window())
+        shutdownDebugUi();
 }
 
 
 void drawObjects(){
-
-    glm::mat4 scale = glm::scale(1.f, 1.f, 1.f);
+    CPU_SCOPE("drawObjects");
 
     // TODO
     // update the camera pose and projection
@@ -160,34 +217,68 @@ void drawObjects(){
     // perspective_projection_from_view <- view_from_world
     glm::mat4 viewProjection(1.0f);
 
-    // draw floor (the floor was built so that it does not need to be transformed)
-    shaderProgram->setMat4("model", viewProjection);
-    floorObj.drawSceneObject();
-
-    // draw 2 cubes and 2 planes in different location and with different orientations
-    drawCube(viewProjection * glm::translate(2.0f, 1.f, 2.0f) * glm::rotateY(glm::half_pi<float>()) * scale);
-    drawCube(viewProjection * glm::translate(-2.0f, 1.f, -2.0f) * glm::rotateY(glm::quarter_pi<float>()) * scale);
+    // keep only the objects whose world bounds intersect the view frustum
+    Frustum frustum = extractFrustum(viewProjection);
+    visibleObjects.clear();
+    cullingStats = CullingStats();
+    if (useBVH)
+        worldBVH.cull(frustum, visibleObjects, cullingStats);
+    else
+        frustumCuller.cull(frustum, visibleObjects, cullingStats);
+
+    renderQueue.clear();
+    indirectBatch.clear();
+    for (unsigned int &count : lodObjectCounts)
+        count = 0;
+    for (unsigned int index : visibleObjects){
+        WorldObject &object = worldObjects[index];
+        // pick the level of detail from the size of the object on screen
+        if (useLods){
+            float screenSize = projectedSphereSize(aabbSphere(worldBounds[index]), viewProjection, (float) SCR_HEIGHT);
+            object.lod = lodSelector.select(object.lod, screenSize, (int) worldObjectLodCount(object.type));
+        }
+        lodObjectCounts[object.lod]++;
+        switch (object.type) {
+            case FLOOR:
+                floorObj.drawSceneObject(shaderProgram->ID, viewProjection * object.model, object.lod);
+                break;
+            case CUBE:
+                drawCube(viewProjection * object.model, object.lod);
+                break;
+            case PLANE:
+                drawPlane(viewProjection * object.model, object.lod);
+                break;
+        }
+    }
 
-    drawPlane(viewProjection * glm::translate(-2.0f, .5f, 2.0f) * glm::rotateX(glm::quarter_pi<float>()) * scale);
-    drawPlane(viewProjection * glm::translate(2.0f, .5f, -2.0f) * glm::rotateX(glm::quarter_pi<float>()*3.f) * scale);
+    if (useIndirectDraw){
+        GPU_SCOPE("indirect batch");
+        indirectShaderProgram->use();
+        indirectBatch.submit();
+        return;
+    }
 
+    // sort by program, VAO and depth, so that consecutive draws share as much state as possible
+    renderQueue.sort();
+    stateCache.invalidate();
+    stateCache.resetStats();
+    GPU_SCOPE("render queue");
+    renderQueue.flush(stateCache);
 }
 
 
-void drawCube(glm::mat4 model){
+void drawCube(glm::mat4 model, int lod){
     // draw object
-    shaderProgram->setMat4("model", model);
-    cube.drawSceneObject();
+    cube.drawSceneObject(shaderProgram->ID, model, lod);
 }
 
 
-void drawPlane(glm::mat4 model){
+void drawPlane(glm::mat4 model, int lod){
     //model = camera->getViewProjectionMatrix() * model;// * scale;
 
     // draw plane body and right wing
-    shaderProgram->setMat4("model", model);
-    planeBody.drawSceneObject();
-    planeWing.drawSceneObject();
+    planeBody.drawSceneObject(shaderProgram->ID, model, lod);
+    planeWing.drawSceneObject(shaderProgram->ID, model, lod);
 
     // propeller,
     glm::mat4 propeller = model * glm::translate(.0f, .5f, .0f) *
@@ -195,97 +286,168 @@ void drawPlane(glm::mat4 model){
                           glm::rotate(glm::half_pi<float>(), glm::vec3(1.0,0.0,0.0)) *
                           glm::scale(.5f, .5f, .5f);
 
-    shaderProgram->setMat4("model", propeller);
-    planePropeller.drawSceneObject();
+    planePropeller.drawSceneObject(shaderProgram->ID, propeller, lod);
 
     // right wing back,
     glm::mat4 wingRightBack = model * glm::translate(0.0f, -0.5f, 0.0f) * glm::scale(.5f,.5f,.5f);
-    shaderProgram->setMat4("model", wingRightBack);
-    planeWing.drawSceneObject();
+    planeWing.drawSceneObject(shaderProgram->ID, wingRightBack, lod);
 
     // left wing,
     glm::mat4 wingLeft = model * glm::scale(-1.0f, 1.0f, 1.0f);
-    shaderProgram->setMat4("model", wingLeft);
-    planeWing.drawSceneObject();
+    planeWing.drawSceneObject(shaderProgram->ID, wingLeft, lod);
 
     // left wing back,
     glm::mat4 wingLeftBack =  model *  glm::translate(0.0f, -0.5f, 0.0f) * glm::scale(-.5f,.5f,.5f);
-    shaderProgram->setMat4("model", wingLeftBack);
-    planeWing.drawSceneObject();
+    planeWing.drawSceneObject(shaderProgram->ID, wingLeftBack, lod);
 }
 
 
 
 void setup(){
-    // initialize shaders
-    shaderProgram = new Shader("shader.vert", "shader.frag");
+    if (app().window()) {
+        glfwSetInputMode(app().window(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+        // after the input callbacks of the runtime, the ImGui backend forwards the events to them
+        initDebugUi(app().window());
+    }
+    // count the GL calls for the draw call and triangle counts of the performance window
+    glCallCounter().install();
+    perfHud.addSlider("extra cubes", &extraCubeCount, 0, 50000, placeWorldObjects);
 
-    // load floor mesh into openGL
-    floorObj.VAO = createVertexArray(floorVertices, floorColors, floorIndices);
-    floorObj.vertexCount = floorIndices.size();
+    // set up the z-buffer
+    glDepthRange(-1,1); // make the NDC a right handed coordinate system, with the camera pointing towards -z
+    glEnable(GL_DEPTH_TEST); // turn on z-buffer depth test
+    glDepthFunc(GL_LESS); // draws fragments that are closer to the screen in NDC
 
-    // load cube mesh into openGL
-    cube.VAO = createVertexArray(cubeVertices, cubeColors, cubeIndices);
-    cube.vertexCount = cubeIndices.size();
+    // initialize shaders
+    {
+        CPU_SCOPE("compile shaders");
+        shaderProgram = new Shader("shader.vert", "shader.frag");
+    }
 
-    // load plane meshes into openGL
-    planeBody.VAO = createVertexArray(planeBodyVertices, planeBodyColors, planeBodyIndices);
-    planeBody.vertexCount = planeBodyIndices.size();
+    // map the binary mesh files, written next to the executable by mesh_converter at build time;
+    // the bounding volumes were precomputed by the converter and are stored in the file headers
+    SceneObject* meshes[] = {&floorObj, &cube, &planeBody, &planeWing, &planePropeller};
+    const char* meshPaths[] = {"floor.mesh", "cube.mesh", "plane_body.mesh", "plane_wing.mesh", "plane_propeller.mesh"};
+    MappedMeshFile meshFiles[5];
+    for (int i = 0; i < 5; i++){
+        if (!meshFiles[i].open(meshPaths[i])){
+            // the files are written by the mesh_converter step of the build, next to the executable
+            std::cout << "ERROR::EXERCISE_4_6::MESH_NOT_LOADED " << meshPaths[i]
+                      << " (run the exercise from its build directory)" << std::endl;
+            app().fail();
+            return;
+        }
+        meshes[i]->bounds = meshFiles[i].bounds();
+        meshes[i]->sphere = meshFiles[i].sphere();
+        meshes[i]->vertexCount = meshFiles[i].lod(0).indexCount;
+        meshes[i]->indexType = meshFiles[i].indexType();
+        meshes[i]->dequantization = meshFiles[i].dequantizationMatrix();
+        // the levels of detail, relative to the element buffer of the mesh for now
+        meshes[i]->lodCount = meshFiles[i].lodCount();
+        for (unsigned int lod = 0; lod < meshes[i]->lodCount; lod++){
+            meshes[i]->lods[lod].firstIndex = meshFiles[i].lod(lod).firstIndex;
+            meshes[i]->lods[lod].indexCount = meshFiles[i].lod(lod).indexCount;
+        }
+    }
 
-    planeWing.VAO = createVertexArray(planeWingVertices, planeWingColors, planeWingIndices);
-    planeWing.vertexCount = planeWingIndices.size();
+    if (useIndirectDraw){
+        // pack all meshes in one buffer for the indirect draw path; it has a single float vertex layout, so
+        // quantized meshes are decoded and drawn without their dequantization matrix
+        indirectShaderProgram = new Shader("indirect.vert", "shader.frag");
+        for (int i = 0; i < 5; i++){
+            std::vector<float> positions = meshFiles[i].decodePositions(), colors = meshFiles[i].decodeColors();
+            MeshRange range = sharedMeshes.addMesh(positions.data(), colors.data(), meshFiles[i].vertexCount(),
+                                                   meshFiles[i].indexData(), meshFiles[i].indexType(), meshFiles[i].indexCount());
+            // every level of detail is a range of the mesh indices
+            for (unsigned int lod = 0; lod < meshes[i]->lodCount; lod++){
+                meshes[i]->lods[lod].firstIndex += range.firstIndex;
+                meshes[i]->lods[lod].baseVertex = range.baseVertex;
+            }
+        }
+        sharedMeshes.upload(indirectShaderProgram->ID);
+        indirectBatch.init(sharedMeshes, indirectShaderProgram->ID, app().context().procAddressLoader());
+    }
+    else {
+        // load the meshes into openGL, straight from the mapped files
+        for (int i = 0; i < 5; i++)
+            meshes[i]->VAO = createVertexArray(meshFiles[i], shaderProgram->ID);
+    }
 
-    planePropeller.VAO = createVertexArray(planePropellerVertices, planePropellerColors, planePropellerIndices);
-    planePropeller.vertexCount = planePropellerIndices.size();
+    // the plane bounds must enclose every part, with the same transforms used in drawPlane;
+    // the propeller spins around the y axis, so it is bounded by a sphere around its pivot
+    planeBounds = planeBody.bounds;
+    planeBounds.expand(planeWing.bounds);
+    planeBounds.expand(transformAABB(planeWing.bounds, glm::translate(0.0f, -0.5f, 0.0f) * glm::scale(.5f,.5f,.5f)));
+    planeBounds.expand(transformAABB(planeWing.bounds, glm::scale(-1.0f, 1.0f, 1.0f)));
+    planeBounds.expand(transformAABB(planeWing.bounds, glm::translate(0.0f, -0.5f, 0.0f) * glm::scale(-.5f,.5f,.5f)));
+    BoundingSphere propellerSphere;
+    propellerSphere.center = glm::vec3(.0f, .5f, .0f);
+    propellerSphere.radius = .5f * (glm::length(planePropeller.sphere.center) + planePropeller.sphere.radius);
+    planeBounds.expand(sphereAABB(propellerSphere));
+
+    placeWorldObjects();
 }
 
 
-unsigned int createVertexArray(const std::vector<float> &positions, const std::vector<float> &colors, const std::vector<unsigned int> &indices){
-    unsigned int VAO;
-    glGenVertexArrays(1, &VAO);
-    // bind vertex array object
-    glBindVertexArray(VAO);
-
-    // set vertex shader attribute "pos"
-    createArrayBuffer(positions); // creates and bind  the VBO
-    int posAttributeLocation = glGetAttribLocation(shaderProgram->ID, "pos");
-    glEnableVertexAttribArray(posAttributeLocation);
-    glVertexAttribPointer(posAttributeLocation, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-    // set vertex shader attribute "color"
-    createArrayBuffer(colors); // creates and bind the VBO
-    int colorAttributeLocation = glGetAttribLocation(shaderProgram->ID, "color");
-    glEnableVertexAttribArray(colorAttributeLocation);
-    glVertexAttribPointer(colorAttributeLocation, 4, GL_FLOAT, GL_FALSE, 0, 0);
-
-    // creates and bind the EBO
-    createElementArrayBuffer(indices);
-
-    return VAO;
-}
-
+// places the floor, 2 cubes, 2 planes and the extra cubes, the same ones for a given extraCubeCount
+// -------------------------------------------------------------------------------------------------
+void placeWorldObjects(){
+    CPU_SCOPE("placeWorldObjects");
+    worldObjects.clear();
+    worldBounds.clear();
+    frustumCuller.clear();
+
+    // place the floor, 2 cubes and 2 planes in different location and with different orientations
+    addWorldObject(FLOOR, glm::mat4(1.0f)); // the floor was built so that it does not need to be transformed
+    addWorldObject(CUBE, glm::translate(2.0f, 1.f, 2.0f) * glm::rotateY(glm::half_pi<float>()));
+    addWorldObject(CUBE, glm::translate(-2.0f, 1.f, -2.0f) * glm::rotateY(glm::quarter_pi<float>()));
+    addWorldObject(PLANE, glm::translate(-2.0f, .5f, 2.0f) * glm::rotateX(glm::quarter_pi<float>()));
+    addWorldObject(PLANE, glm::translate(2.0f, .5f, -2.0f) * glm::rotateX(glm::quarter_pi<float>()*3.f));
+
+    srand(1);
+    for (int i = 0; i < extraCubeCount; i++){
+        float x = ((float) rand() / (float) RAND_MAX - .5f) * 400.0f;
+        float z = ((float) rand() / (float) RAND_MAX - .5f) * 400.0f;
+        addWorldObject(CUBE, glm::translate(x, 1.f, z) * glm::rotateY((float) rand() / (float) RAND_MAX * glm::pi<float>()));
+    }
 
-unsigned int createArrayBuffer(const std::vector<float> &array){
-    unsigned int VBO;
-    glGenBuffers(1, &VBO);
+    // the world is static, so the hierarchy is only built when the objects are placed
+    if (useBVH)
+        worldBVH.build(worldBounds);
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, array.size() * sizeof(GLfloat), &array[0], GL_STATIC_DRAW);
 
-    return VBO;
+void addWorldObject(int type, const glm::mat4 &model){
+    const AABB &localBounds = type == FLOOR ? floorObj.bounds : type == CUBE ? cube.bounds : planeBounds;
+    worldObjects.push_back(WorldObject{type, model});
+    worldBounds.push_back(transformAABB(localBounds, model));
+    frustumCuller.add(worldBounds.back());
 }
 
 
-unsigned int createElementArrayBuffer(const std::vector<unsigned int> &array){
-    unsigned int EBO;
-    glGenBuffers(1, &EBO);
+// levels of detail of a world object, a plane has the levels of its most detailed part (the other parts clamp)
+unsigned int worldObjectLodCount(int type){
+    if (type == FLOOR)
+        return floorObj.lodCount;
+    if (type == CUBE)
+        return cube.lodCount;
+    return std::max(planeBody.lodCount, std::max(planeWing.lodCount, planePropeller.lodCount));
+}
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, array.size() * sizeof(unsigned int), &array[0], GL_STATIC_DRAW);
 
-    return EBO;
+// the options of the exercise, the other options are read by the runtime:
+//   --indirect   draw all the meshes from one shared buffer with a single indirect draw call
+//   --bvh        cull with the bounding volume hierarchy instead of the flat list of bounds
+void parseOptions(int argc, char* argv[]){
+    for (int i = 1; i < argc; i++){
+        if (std::strcmp(argv[i], "--indirect") == 0)
+            useIndirectDraw = true;
+        else if (std::strcmp(argv[i], "--bvh") == 0)
+            useBVH = true;
+    }
 }
 
+
 // NEW!
 // instead of using the NDC to transform from screen space you now can define the range using the
 // min and max parameters
@@ -299,14 +461,25 @@ void cursorInRange(float screenX, float screenY, int screenW, int screenH, float
 
 void cursor_input_callback(GLFWwindow* window, double posX, double posY){
     // TODO
-    // rotate the camera position based on mouse movements
+    // rotate the camera position based on mouse movements (only while cursorCaptured)
     // if you decide to use the lookAt function, make sure that the up vector and the
     // vector from the camera position to the lookAt target are not collinear
 }
 
-void processInput(GLFWwindow *window) {
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-        glfwSetWindowShouldClose(window, true);
+void processInput(float dt) {
+    CPU_SCOPE("processInput");
+    if (inputReplay().getKey(GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        app().close();
+
+    // TAB toggles between turning the camera and using the performance window
+    static bool tabWasPressed = false;
+    bool tabPressed = inputReplay().getKey(GLFW_KEY_TAB) == GLFW_PRESS;
+    if (tabPressed && !tabWasPressed){
+        cursorCaptured = !cursorCaptured;
+        if (app().window())
+            glfwSetInputMode(app().window(), GLFW_CURSOR, cursorCaptured ? GLFW_CURSOR_DISABLED : GLFW_CURSOR_NORMAL);
+    }
+    tabWasPressed = tabPressed;
 
     // TODO
     // move the camera position based on keys pressed (use either WASD or the arrow keys)
@@ -314,11 +487,9 @@ void processInput(GLFWwindow *window) {
 }
 
 
-// glfw: whenever the window size changed (by OS or user resize) this callback function executes
-// ---------------------------------------------------------------------------------------------
-void framebuffer_size_callback(GLFWwindow* window, int width, int height)
-{
-    // make sure the viewport matches the new window dimensions; note that width and
-    // height will be significantly larger than specified on retina displays.
-    glViewport(0, 0, width, height);
-}
\ No newline at end of file
+// the input events of the frame, passed on to the glfw callbacks above (the window is null in headless replays)
+// -------------------------------------------------------------------------------------------------------------
+void handleInput(const InputEvent &event){
+    if (event.type == InputEvent::CURSOR_POS)
+        cursor_input_callback(app().window(), event.x, event.y);
+}
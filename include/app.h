@@ -0,0 +1,86 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_APP_H
+#define GRAPHICSPROGRAMMINGEXERCISES_APP_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <vector>
+#include <chrono>
+#include <functional>
+
+#include "render_context.h"
+
+// runtime of the exercises: owns the window or headless context (render_context.h), the input (recorded and
+// replayed through input_replay.h), the frame pacing and the profiler frames, and calls the hooks of the exercise:
+//
+//     int main(int argc, char* argv[]){
+//         app().onSetup = setup;              // after the context is created, before the first frame
+//         app().onInput = handleInput;        // every queued input event, at the start of the frame
+//         app().onUpdate = update;            // once per frame with the time since the previous frame
+//         app().onRender = render;            // once per frame, before the frame is presented
+//         return app().run("Exercise 3", SCR_WIDTH, SCR_HEIGHT, argc, argv);
+//     }
+//
+// the GLFW callbacks are installed by the runtime, the events they deliver in a frame are queued and passed to
+// onInput at the start of the next one, so the exercise sees them at a fixed point of the frame; the polled state
+// (inputReplay().getKey ...) can be read in onUpdate. The options of render_context.h (--headless, --replay,
+// --benchmark ...) work for every exercise that uses the runtime.
+// -------------------------------------------------------------------------------------------------------------
+
+struct InputEvent {
+    enum Type { KEY, MOUSE_BUTTON, CURSOR_POS, SCROLL, FRAMEBUFFER_SIZE };
+    Type type;
+    int key = 0;        // key, or mouse button
+    int scancode = 0, action = 0, mods = 0;
+    double x = 0, y = 0;  // cursor position, scroll offset or framebuffer size
+};
+
+class App {
+public:
+    std::function<void()> onSetup;
+    std::function<void(const InputEvent &event)> onInput;
+    std::function<void(float dt)> onUpdate;
+    std::function<void()> onRender;
+    std::function<void()> onShutdown;  // before the context is destroyed
+
+    // minimum seconds between two frames of a window (0 only waits for the swap interval), headless runs and
+    // replays go as fast as possible
+    float frameInterval = 0.0f;
+    // the framebuffer size callback sets the viewport to the new size
+    bool resizeViewport = true;
+
+    // creates the context, runs the hooks until the context should close and releases it; returns the exit code
+    int run(const char* title, unsigned int width, unsigned int height, int argc, char* argv[]);
+
+    RenderContext &context() { return renderContext; }
+    // nullptr for headless contexts
+    GLFWwindow* window() const { return renderContext.getWindow(); }
+    // application time of the current frame, see RenderContext::time
+    float time() const { return currentTime; }
+    float deltaTime() const { return frameDeltaTime; }
+    // ends the run after the current frame
+    void close() { renderContext.requestClose(); }
+    // same, and run returns an error code; for a setup that can't load what the exercise needs
+    void fail() { failed = true; close(); }
+
+private:
+    void installCallbacks();
+    void dispatchInput();
+    void waitForFrameInterval(std::chrono::high_resolution_clock::time_point frameStart) const;
+
+    static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+    static void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
+    static void cursorPosCallback(GLFWwindow* window, double x, double y);
+    static void scrollCallback(GLFWwindow* window, double x, double y);
+    static void framebufferSizeCallback(GLFWwindow* window, int width, int height);
+
+    RenderContext renderContext;
+    std::vector<InputEvent> inputQueue, dispatchedInput;
+    float currentTime = 0.0f, frameDeltaTime = 0.0f;
+    bool failed = false;
+};
+
+// runtime of the exercise, see above
+App &app();
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_APP_H
@@ -0,0 +1,184 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_ASSET_IMPORT_H
+#define GRAPHICSPROGRAMMINGEXERCISES_ASSET_IMPORT_H
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+
+#include "mesh_file.h"
+#include "mesh_processing.h"
+#include "mesh_optimizer.h"
+#include "mesh_simplifier.h"
+
+// import stage: models are loaded through assimp once, processed (vertex deduplication, index and vertex
+// order optimization, levels of detail, quantization) and written to a cache as a binary mesh file named after the hash
+// of the source file contents; later loads of the same file only map the cached mesh and skip assimp
+// ---------------------------------------------------------------------------------------------------
+
+// bump when the processing changes, so that stale cache entries are not used
+const uint64_t ASSET_PIPELINE_VERSION = 4;
+
+struct ImportTimings {
+    bool cacheHit = false;
+    double hashSeconds = 0;         // hashing the source file
+    double importSeconds = 0;       // assimp
+    double processSeconds = 0;      // deduplication, optimization and quantization
+    double writeSeconds = 0;        // writing the cache entry
+    double loadSeconds = 0;         // mapping the cache entry
+    unsigned int sourceVertices = 0, vertices = 0, triangles = 0;
+
+    double totalSeconds() const { return hashSeconds + importSeconds + processSeconds + writeSeconds + loadSeconds; }
+
+    void print(std::ostream &out) const{
+        out << (cacheHit ? "cached load: " : "import: ") << triangles << " triangles, " << vertices << " vertices";
+        if (!cacheHit)
+            out << " (" << sourceVertices << " before deduplication)";
+        out << "\n  hash " << hashSeconds * 1000.0 << " ms";
+        if (!cacheHit)
+            out << ", assimp " << importSeconds * 1000.0 << " ms, process " << processSeconds * 1000.0
+                << " ms, write " << writeSeconds * 1000.0 << " ms";
+        out << ", map " << loadSeconds * 1000.0 << " ms, total " << totalSeconds() * 1000.0 << " ms" << std::endl;
+    }
+};
+
+
+// 64 bit FNV-1a, continued from hash over size more bytes
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+inline uint64_t hashBytes(uint64_t hash, const void* data, size_t size){
+    const unsigned char* bytes = (const unsigned char*) data;
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    return hash;
+}
+
+// hash of the file contents, returns false if the file can't be read
+inline bool hashFileContents(const std::string &path, uint64_t &hash){
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    hash = FNV_OFFSET_BASIS;
+    std::vector<char> buffer(1 << 20);
+    while (file){
+        file.read(buffer.data(), buffer.size());
+        hash = hashBytes(hash, buffer.data(), (size_t) file.gcount());
+    }
+    return true;
+}
+
+// the pipeline version is hashed after the contents, a new version gives unrelated names for every file
+inline std::string processedMeshCachePath(const std::string &cacheDirectory, uint64_t contentHash){
+    unsigned char version[8];
+    for (int i = 0; i < 8; i++)
+        version[i] = (unsigned char) (ASSET_PIPELINE_VERSION >> (8 * i));
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.mesh", (unsigned long long) hashBytes(contentHash, version, sizeof(version)));
+    return cacheDirectory + "/" + name;
+}
+
+
+// loads every triangle of the model into a single mesh, with the node transforms applied;
+// vertex colors come from the first color set, or from the material diffuse color
+inline bool importModel(const std::string &path, MeshData &mesh){
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_PreTransformVertices | aiProcess_SortByPType);
+    if (!scene || !scene->mRootNode || (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE)){
+        std::cout << "ERROR::ASSET_IMPORT::" << importer.GetErrorString() << std::endl;
+        return false;
+    }
+
+    for (unsigned int m = 0; m < scene->mNumMeshes; m++){
+        const aiMesh* source = scene->mMeshes[m];
+        if (!(source->mPrimitiveTypes & aiPrimitiveType_TRIANGLE))
+            continue;
+
+        aiColor4D diffuse(1.0f, 1.0f, 1.0f, 1.0f);
+        if (source->mMaterialIndex < scene->mNumMaterials)
+            scene->mMaterials[source->mMaterialIndex]->Get(AI_MATKEY_COLOR_DIFFUSE, diffuse);
+
+        unsigned int baseVertex = mesh.vertexCount();
+        for (unsigned int v = 0; v < source->mNumVertices; v++){
+            const aiVector3D &p = source->mVertices[v];
+            mesh.positions.insert(mesh.positions.end(), {p.x, p.y, p.z});
+            const aiColor4D &c = source->HasVertexColors(0) ? source->mColors[0][v] : diffuse;
+            mesh.colors.insert(mesh.colors.end(), {c.r, c.g, c.b, c.a});
+        }
+        for (unsigned int f = 0; f < source->mNumFaces; f++){
+            const aiFace &face = source->mFaces[f];
+            if (face.mNumIndices != 3)
+                continue;
+            for (unsigned int i = 0; i < 3; i++)
+                mesh.indices.push_back(baseVertex + face.mIndices[i]);
+        }
+    }
+    return !mesh.indices.empty();
+}
+
+// the processing applied before a mesh is written to the cache
+inline void processImportedMesh(MeshData &mesh){
+    snapToQuantizationGrid(mesh);
+    deduplicateVertices(mesh);
+    removeDegenerateTriangles(mesh);
+    optimizeVertexCache(mesh.indices, mesh.vertexCount());
+    optimizeVertexFetch(mesh);
+    generateMeshLods(mesh);
+}
+
+
+// maps the processed version of a model, importing and caching it first if needed
+inline bool loadModelCached(const std::string &sourcePath, const std::string &cacheDirectory,
+                            MappedMeshFile &mesh, ImportTimings* timings = nullptr){
+    typedef std::chrono::high_resolution_clock Clock;
+    ImportTimings localTimings;
+    ImportTimings &t = timings ? *timings : localTimings;
+    t = ImportTimings();
+
+    auto start = Clock::now();
+    uint64_t contentHash;
+    if (!hashFileContents(sourcePath, contentHash)){
+        std::cout << "ERROR::ASSET_IMPORT::CANNOT_READ " << sourcePath << std::endl;
+        return false;
+    }
+    std::string cachePath = processedMeshCachePath(cacheDirectory, contentHash);
+    auto hashed = Clock::now();
+    t.hashSeconds = std::chrono::duration<double>(hashed - start).count();
+
+    // cache hit, assimp is not involved at all
+    if (std::ifstream(cachePath).good() && mesh.open(cachePath)){
+        t.cacheHit = true;
+        t.loadSeconds = std::chrono::duration<double>(Clock::now() - hashed).count();
+        t.vertices = t.sourceVertices = mesh.vertexCount();
+        t.triangles = mesh.lod(0).indexCount / 3;
+        return true;
+    }
+
+    MeshData data;
+    if (!importModel(sourcePath, data))
+        return false;
+    auto imported = Clock::now();
+    t.sourceVertices = data.vertexCount();
+
+    processImportedMesh(data);
+    auto processed = Clock::now();
+
+    if (!writeMeshFile(cachePath, data.positions, data.colors, data.indices, true, data.lods))
+        return false;
+    auto written = Clock::now();
+
+    bool loaded = mesh.open(cachePath);
+    t.importSeconds = std::chrono::duration<double>(imported - hashed).count();
+    t.processSeconds = std::chrono::duration<double>(processed - imported).count();
+    t.writeSeconds = std::chrono::duration<double>(written - processed).count();
+    t.loadSeconds = std::chrono::duration<double>(Clock::now() - written).count();
+    t.vertices = data.vertexCount();
+    t.triangles = data.lods[0].indexCount / 3;
+    return loaded;
+}
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_ASSET_IMPORT_H
@@ -0,0 +1,154 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_ATLAS_PACKER_H
+#define GRAPHICSPROGRAMMINGEXERCISES_ATLAS_PACKER_H
+
+#include <vector>
+#include <algorithm>
+#include <climits>
+
+// rectangle packing for texture atlases (texture_cache.h packs particle sprites with it):
+// - SkylinePacker places rectangles bottom-left on a skyline, the top edge of the rectangles placed so far, and
+//   picks the position with the lowest top, then the one that wastes the least area under the rectangle
+//   (Jylänki, "A Thousand Ways to Pack the Bin")
+// - packAtlas sorts the rectangles by height and grows a power of two atlas until all of them fit
+// ---------------------------------------------------------------------------------------------------------------------
+
+struct AtlasRect {
+    unsigned int x = 0, y = 0, width = 0, height = 0;
+};
+
+class SkylinePacker {
+public:
+    explicit SkylinePacker(unsigned int width = 0, unsigned int height = 0) { reset(width, height); }
+
+    void reset(unsigned int width, unsigned int height){
+        atlasWidth = width;
+        atlasHeight = height;
+        skyline.assign(1, Segment{0, 0, width});
+    }
+
+    // false if the rectangle does not fit, the packer is unchanged then
+    bool pack(unsigned int width, unsigned int height, AtlasRect &rect){
+        size_t best = skyline.size();
+        unsigned int bestTop = UINT_MAX, bestWaste = UINT_MAX;
+        for (size_t i = 0; i < skyline.size(); i++){
+            unsigned int y, waste;
+            if (!fits(i, width, height, y, waste))
+                continue;
+            if (y + height < bestTop || (y + height == bestTop && waste < bestWaste)){
+                best = i;
+                bestTop = y + height;
+                bestWaste = waste;
+            }
+        }
+        if (best == skyline.size())
+            return false;
+
+        rect.x = skyline[best].x;
+        rect.y = bestTop - height;
+        rect.width = width;
+        rect.height = height;
+        insert(best, rect);
+        return true;
+    }
+
+private:
+    struct Segment {
+        unsigned int x, y, width;
+    };
+
+    // the rectangle starting at segment i rests on the highest segment it spans
+    bool fits(size_t i, unsigned int width, unsigned int height, unsigned int &y, unsigned int &waste) const{
+        unsigned int x = skyline[i].x;
+        if (x + width > atlasWidth)
+            return false;
+        y = 0;
+        unsigned int covered = 0;
+        for (size_t j = i; covered < width; j++){
+            y = std::max(y, skyline[j].y);
+            covered += skyline[j].width;
+        }
+        if (y + height > atlasHeight)
+            return false;
+        waste = 0;
+        covered = 0;
+        for (size_t j = i; covered < width; j++){
+            unsigned int spanned = std::min(skyline[j].width, width - covered);
+            waste += (y - skyline[j].y) * spanned;
+            covered += spanned;
+        }
+        return true;
+    }
+
+    // the new segment covers the top of the rectangle, the segments under it are cut or removed
+    void insert(size_t i, const AtlasRect &rect){
+        skyline.insert(skyline.begin() + i, Segment{rect.x, rect.y + rect.height, rect.width});
+        unsigned int right = rect.x + rect.width;
+        for (size_t j = i + 1; j < skyline.size();){
+            if (skyline[j].x >= right)
+                break;
+            unsigned int end = skyline[j].x + skyline[j].width;
+            if (end <= right)
+                skyline.erase(skyline.begin() + j);
+            else {
+                skyline[j].width = end - right;
+                skyline[j].x = right;
+                break;
+            }
+        }
+        // neighbours at the same height are merged, so later rectangles see one wide segment
+        for (size_t j = 0; j + 1 < skyline.size();){
+            if (skyline[j].y == skyline[j + 1].y){
+                skyline[j].width += skyline[j + 1].width;
+                skyline.erase(skyline.begin() + j + 1);
+            }
+            else
+                j++;
+        }
+    }
+
+    unsigned int atlasWidth = 0, atlasHeight = 0;
+    std::vector<Segment> skyline;
+};
+
+
+// packs rectangles of the given sizes (rects[i].width/height are read, x/y are written) into the smallest power of
+// two atlas found, growing the shorter side first; false if they don't fit in maxSize x maxSize
+inline bool packAtlas(std::vector<AtlasRect> &rects, unsigned int maxSize, unsigned int &atlasWidth, unsigned int &atlasHeight){
+    // tall rectangles first, the skyline stays flat longer
+    std::vector<size_t> order(rects.size());
+    unsigned long long area = 0;
+    for (size_t i = 0; i < rects.size(); i++){
+        order[i] = i;
+        area += (unsigned long long) rects[i].width * rects[i].height;
+    }
+    std::sort(order.begin(), order.end(), [&rects](size_t a, size_t b){
+        return rects[a].height != rects[b].height ? rects[a].height > rects[b].height : rects[a].width > rects[b].width;
+    });
+
+    // start at the smallest power of two square that has the area
+    atlasWidth = atlasHeight = 1;
+    while ((unsigned long long) atlasWidth * atlasHeight < area){
+        if (atlasWidth <= atlasHeight)
+            atlasWidth *= 2;
+        else
+            atlasHeight *= 2;
+    }
+    while (atlasWidth <= maxSize && atlasHeight <= maxSize){
+        SkylinePacker packer(atlasWidth, atlasHeight);
+        bool packed = true;
+        for (size_t i : order)
+            if (!packer.pack(rects[i].width, rects[i].height, rects[i])){
+                packed = false;
+                break;
+            }
+        if (packed)
+            return true;
+        if (atlasWidth <= atlasHeight)
+            atlasWidth *= 2;
+        else
+            atlasHeight *= 2;
+    }
+    return false;
+}
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_ATLAS_PACKER_H
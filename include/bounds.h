@@ -0,0 +1,84 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_BOUNDS_H
+#define GRAPHICSPROGRAMMINGEXERCISES_BOUNDS_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cmath>
+#include <cfloat>
+
+// axis aligned bounding box, stored as min and max corners
+// --------------------------------------------------------
+struct AABB {
+    glm::vec3 min = glm::vec3(FLT_MAX);
+    glm::vec3 max = glm::vec3(-FLT_MAX);
+
+    bool isEmpty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+    glm::vec3 center() const { return (min + max) * .5f; }
+    glm::vec3 extents() const { return (max - min) * .5f; }
+
+    void expand(const glm::vec3 &point){
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+    void expand(const AABB &other){
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+};
+
+// bounding sphere, center and radius
+// ----------------------------------
+struct BoundingSphere {
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+};
+
+
+// computes the AABB of a list of positions packed as x,y,z,x,y,z...
+inline AABB computeAABB(const std::vector<float> &positions){
+    AABB box;
+    for (unsigned int i = 0; i + 2 < positions.size(); i += 3)
+        box.expand(glm::vec3(positions[i], positions[i+1], positions[i+2]));
+    return box;
+}
+
+// bounding sphere centered at the AABB center, with the radius of the farthest vertex
+// (tighter than the sphere around the box, and cheap to compute at load time)
+inline BoundingSphere computeBoundingSphere(const std::vector<float> &positions){
+    BoundingSphere sphere;
+    sphere.center = computeAABB(positions).center();
+    float radiusSq = 0.0f;
+    for (unsigned int i = 0; i + 2 < positions.size(); i += 3){
+        glm::vec3 d = glm::vec3(positions[i], positions[i+1], positions[i+2]) - sphere.center;
+        radiusSq = glm::max(radiusSq, glm::dot(d, d));
+    }
+    sphere.radius = std::sqrt(radiusSq);
+    return sphere;
+}
+
+// transforms a box and returns the AABB that encloses the result (Arvo's method)
+inline AABB transformAABB(const AABB &box, const glm::mat4 &transform){
+    if (box.isEmpty())
+        return box;
+    glm::vec3 center = glm::vec3(transform * glm::vec4(box.center(), 1.0f));
+    glm::vec3 extents = box.extents();
+    glm::vec3 newExtents(0.0f);
+    for (int row = 0; row < 3; row++)
+        for (int col = 0; col < 3; col++)
+            newExtents[row] += std::abs(transform[col][row]) * extents[col];
+    AABB result;
+    result.min = center - newExtents;
+    result.max = center + newExtents;
+    return result;
+}
+
+// AABB that encloses a sphere
+inline AABB sphereAABB(const BoundingSphere &sphere){
+    AABB result;
+    result.min = sphere.center - glm::vec3(sphere.radius);
+    result.max = sphere.center + glm::vec3(sphere.radius);
+    return result;
+}
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_BOUNDS_H
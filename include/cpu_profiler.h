@@ -0,0 +1,219 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_CPU_PROFILER_H
+#define GRAPHICSPROGRAMMINGEXERCISES_CPU_PROFILER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define GP_CPU_PROFILER_TSC
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define GP_CPU_PROFILER_TSC
+#endif
+
+// CPU timeline of named scopes, exported as Chrome tracing JSON (open it in chrome://tracing or ui.perfetto.dev):
+//
+//     void drawObjects(){
+//         CPU_SCOPE("drawObjects");
+//         ...
+//     }
+//
+// a scope reads the clock when it opens and when it closes and appends one event to a ring buffer owned by the
+// calling thread, so recording takes no lock and threads never wait on each other; the rings keep the last
+// RING_CAPACITY events of every thread. On x86 the clock is the time stamp counter, which costs a fraction of a
+// steady_clock read, and ticks are converted to nanoseconds on export against steady_clock, so a scope costs
+// a few tens of ns. The names must outlive the profiler (string literals), only the pointer is stored.
+// Define GP_DISABLE_CPU_PROFILER to compile the scopes out. The GP_CPU_TRACE environment variable names the file
+// of the trace: programs that use the runtime (app.h) write it when their context is destroyed, the others call
+// writeRequestedTrace() at the end of the run
+// ----------------------------------------------------------------------------------------------------------
+
+struct CpuEvent {
+    const char* name;
+    uint64_t begin, end;    // clock ticks, see CpuProfiler::now()
+};
+
+class CpuProfiler {
+public:
+    static const unsigned int RING_CAPACITY = 1u << 16;     // power of two
+
+    // events of one thread, written by that thread only; the exporter reads the ring while it is being written
+    // and drops the events that were overwritten during the copy
+    struct ThreadRing {
+        std::vector<CpuEvent> events = std::vector<CpuEvent>(RING_CAPACITY);
+        std::atomic<uint64_t> written{0};
+        unsigned int threadId = 0;
+        std::string threadName;
+
+        void push(const CpuEvent &event){
+            uint64_t index = written.load(std::memory_order_relaxed);
+            events[index & (RING_CAPACITY - 1)] = event;
+            written.store(index + 1, std::memory_order_release);
+        }
+    };
+
+    CpuProfiler() : epoch(std::chrono::steady_clock::now()), epochTicks(now()), mainThread(std::this_thread::get_id()) {}
+    CpuProfiler(const CpuProfiler &) = delete;
+    CpuProfiler &operator=(const CpuProfiler &) = delete;
+
+    // scopes opened while disabled are not recorded
+    std::atomic<bool> enabled{true};
+
+    // clock ticks, time stamp counter cycles or steady_clock nanoseconds
+    static uint64_t now(){
+#ifdef GP_CPU_PROFILER_TSC
+        return (uint64_t) __rdtsc();
+#else
+        return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    // nanoseconds since the profiler was created, for ticks returned by now()
+    double toNanoseconds(uint64_t ticks) const{
+        return (double) (int64_t) (ticks - epochTicks) * nanosecondsPerTick;
+    }
+
+    // adds an event measured by the caller, e.g. a frame that starts in one call and ends in another
+    void record(const char* name, uint64_t begin, uint64_t end){
+        if (enabled.load(std::memory_order_relaxed))
+            threadRing().push(CpuEvent{name, begin, end});
+    }
+
+    // name of the calling thread in the trace
+    void setThreadName(const std::string &name){
+        ThreadRing &ring = threadRing();
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        ring.threadName = name;
+    }
+
+    // ring of the calling thread, created and registered on the first event of the thread
+    ThreadRing &threadRing(){
+        thread_local ThreadRing* ring = nullptr;
+        if (!ring)
+            ring = registerThread();
+        return *ring;
+    }
+
+    // copies the events currently in the rings, sorted by start time
+    std::vector<std::pair<unsigned int, CpuEvent>> collectEvents(){
+        std::vector<std::pair<unsigned int, CpuEvent>> collected;
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        for (const std::shared_ptr<ThreadRing> &ring : rings){
+            uint64_t end = ring->written.load(std::memory_order_acquire);
+            uint64_t begin = end > RING_CAPACITY ? end - RING_CAPACITY : 0;
+            size_t first = collected.size();
+            for (uint64_t i = begin; i < end; i++)
+                collected.emplace_back(ring->threadId, ring->events[i & (RING_CAPACITY - 1)]);
+            // the owning thread kept writing, drop the slots it may have overwritten in the meantime (including
+            // the one it is writing now, which is published only after the write)
+            uint64_t overwritten = ring->written.load(std::memory_order_acquire);
+            if (overwritten >= begin + RING_CAPACITY){
+                size_t lost = (size_t) std::min<uint64_t>(overwritten - begin - RING_CAPACITY + 1, end - begin);
+                collected.erase(collected.begin() + first, collected.begin() + first + lost);
+            }
+        }
+        std::sort(collected.begin(), collected.end(), [](const std::pair<unsigned int, CpuEvent> &a, const std::pair<unsigned int, CpuEvent> &b){
+            return a.second.begin < b.second.begin;
+        });
+        return collected;
+    }
+
+    // Chrome trace event format: complete ("X") events with microsecond timestamps and nanosecond decimals
+    bool writeChromeTrace(const std::string &path){
+        calibrate();
+        std::vector<std::pair<unsigned int, CpuEvent>> events = collectEvents();
+        FILE* file = std::fopen(path.c_str(), "w");
+        if (!file){
+            std::cout << "ERROR::CPU_PROFILER::CANNOT_WRITE " << path << std::endl;
+            return false;
+        }
+        std::fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+        {
+            std::lock_guard<std::mutex> lock(ringsMutex);
+            for (const std::shared_ptr<ThreadRing> &ring : rings)
+                std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}},\n",
+                             ring->threadId, ring->threadName.c_str());
+        }
+        for (size_t i = 0; i < events.size(); i++){
+            const CpuEvent &event = events[i].second;
+            std::fprintf(file, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+                         event.name, events[i].first, toNanoseconds(event.begin) / 1000.0,
+                         (double) (event.end - event.begin) * nanosecondsPerTick / 1000.0, i + 1 < events.size() ? "," : "");
+        }
+        std::fprintf(file, "]}\n");
+        std::fclose(file);
+        return true;
+    }
+
+    // writes the trace to the file named by GP_CPU_TRACE, if set
+    bool writeRequestedTrace(){
+        const char* path = std::getenv("GP_CPU_TRACE");
+        return path && *path && writeChromeTrace(path);
+    }
+
+private:
+    // the rings are owned by the profiler, so that the events of finished threads can still be exported
+    ThreadRing* registerThread(){
+        std::shared_ptr<ThreadRing> created = std::make_shared<ThreadRing>();
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        created->threadId = (unsigned int) rings.size() + 1;
+        created->threadName = std::this_thread::get_id() == mainThread ? "main" : "thread " + std::to_string(created->threadId);
+        rings.push_back(created);
+        return created.get();
+    }
+
+    // rate of the time stamp counter, measured over the lifetime of the profiler (at least 10 ms)
+    void calibrate(){
+#ifdef GP_CPU_PROFILER_TSC
+        while (std::chrono::steady_clock::now() - epoch < std::chrono::milliseconds(10)) {}
+        double nanoseconds = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+        nanosecondsPerTick = nanoseconds / (double) (now() - epochTicks);
+#endif
+    }
+
+    std::chrono::steady_clock::time_point epoch;
+    uint64_t epochTicks;
+    std::thread::id mainThread;     // the thread that created the profiler
+    double nanosecondsPerTick = 1.0;
+    std::mutex ringsMutex;
+    std::vector<std::shared_ptr<ThreadRing>> rings;
+};
+
+// profiler used by CPU_SCOPE
+inline CpuProfiler &cpuProfiler(){
+    static CpuProfiler instance;
+    return instance;
+}
+
+// records the time until the end of the enclosing block
+class CpuScope {
+public:
+    explicit CpuScope(const char* name) : name(name), begin(cpuProfiler().now()) {}
+    ~CpuScope() { cpuProfiler().record(name, begin, cpuProfiler().now()); }
+    CpuScope(const CpuScope &) = delete;
+    CpuScope &operator=(const CpuScope &) = delete;
+private:
+    const char* name;
+    uint64_t begin;
+};
+
+#ifndef GP_DISABLE_CPU_PROFILER
+#define CPU_SCOPE_CONCAT_IMPL(a, b) a##b
+#define CPU_SCOPE_CONCAT(a, b) CPU_SCOPE_CONCAT_IMPL(a, b)
+#define CPU_SCOPE(name) CpuScope CPU_SCOPE_CONCAT(cpuScope, __LINE__)(name)
+#else
+#define CPU_SCOPE(name) do {} while (0)
+#endif
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_CPU_PROFILER_H
@@ -0,0 +1,103 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_DEBUG_UI_H
+#define GRAPHICSPROGRAMMINGEXERCISES_DEBUG_UI_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <imgui.h>
+#include <imgui_impl_glfw.h>
+#include <imgui_impl_opengl3.h>
+
+#include <cfloat>
+
+#include "gl_call_counter.h"
+
+// ImGui windows drawn on top of the exercises, the target needs to link imgui:
+//
+//     initDebugUi(window);                 // after the glfw callbacks of the exercise are set
+//     while (...) {
+//         ... render the frame ...
+//         beginDebugUi();
+//         ImGui::Begin("...") ...
+//         endDebugUi();
+//         glfwSwapBuffers(window);
+//     }
+//     shutdownDebugUi();
+//
+// the GL calls of ImGui are not counted by the GL call counter (see gl_call_counter.h)
+// -----------------------------------------------------------------------------------------
+
+inline void initDebugUi(GLFWwindow* window){
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGui::StyleColorsDark();
+    ImGui_ImplGlfw_InitForOpenGL(window, true);
+    ImGui_ImplOpenGL3_Init("#version 330 core");
+}
+
+inline void beginDebugUi(){
+    ImGui_ImplOpenGL3_NewFrame();
+    ImGui_ImplGlfw_NewFrame();
+    ImGui::NewFrame();
+}
+
+inline void endDebugUi(){
+    ImGui::Render();
+    GLCallCounterPause pause;
+    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    // the backend restores the state it changes, possibly through its own loader
+    glCallCounter().invalidate();
+}
+
+inline void shutdownDebugUi(){
+    ImGui_ImplOpenGL3_Shutdown();
+    ImGui_ImplGlfw_Shutdown();
+    ImGui::DestroyContext();
+}
+
+
+// window with the GL calls of the last frame, the total over the last HISTORY_SIZE frames as a graph and the calls
+// of each function, most called first; the redundant state changes are shown in red when there are any
+// ----------------------------------------------------------------------------------------------------------------
+class GLCallOverlay {
+public:
+    static const unsigned int HISTORY_SIZE = 120;
+
+    void draw(const GLCallCounter &counter){
+        const GLCallStats &stats = counter.lastFrame();
+        if (counter.frameCount() != lastFrame){
+            lastFrame = counter.frameCount();
+            history[next] = (float) stats.totalCalls;
+            next = (next + 1) % HISTORY_SIZE;
+        }
+
+        ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_FirstUseEver);
+        ImGui::Begin("GL calls");
+        if (!counter.isInstalled()){
+            ImGui::Text("the GL call counter is not installed");
+            ImGui::End();
+            return;
+        }
+        ImGui::PlotLines("##calls", history, HISTORY_SIZE, (int) next, nullptr, 0.0f, FLT_MAX, ImVec2(0, 60));
+        ImGui::Text("calls          %u", stats.totalCalls);
+        ImGui::Text("draw calls     %u (%u instances)", stats.drawCalls, stats.instances);
+        ImGui::Text("uniforms       %u", stats.uniformCalls);
+        ImGui::Text("uploads        %u (%.1f KB)", stats.uploads, (double) stats.bytesUploaded / 1024.0);
+        ImGui::Text("state changes  %u", stats.stateChanges);
+        if (stats.redundantStateChanges)
+            ImGui::TextColored(ImVec4(1.0f, .3f, .3f, 1.0f), "redundant      %u", stats.redundantStateChanges);
+        else
+            ImGui::Text("redundant      0");
+        if (ImGui::CollapsingHeader("per function", ImGuiTreeNodeFlags_DefaultOpen))
+            for (GLFunction function : stats.calledFunctions())
+                ImGui::Text("%-34s %u", glFunctionName(function), stats.count(function));
+        ImGui::End();
+    }
+
+private:
+    float history[HISTORY_SIZE] = {};
+    unsigned int next = 0;
+    unsigned int lastFrame = ~0u;
+};
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_DEBUG_UI_H
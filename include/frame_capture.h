@@ -0,0 +1,249 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_FRAME_CAPTURE_H
+#define GRAPHICSPROGRAMMINGEXERCISES_FRAME_CAPTURE_H
+
+#include <glad/glad.h>
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include "png_writer.h"
+#include "cpu_profiler.h"
+
+// asynchronous frame capture: glReadPixels into a pixel buffer object returns as soon as the copy is queued,
+// so every frame is read into the next PBO of a ring and the PBO filled two frames earlier (N - 2) is mapped,
+// by then the GPU has finished the copy and mapping does not stall the pipeline. The pixels are copied out of
+// the mapped buffer and handed to an encoder thread that writes the files, so compressing a PNG never blocks
+// the render loop. Frames are never dropped: when the encoder falls behind by more than maxQueuedFrames the
+// render thread waits for it (the number of waits is reported by printSummary)
+// -------------------------------------------------------------------------------------------------------------
+
+enum class CaptureFormat { PNG, RAW };
+
+inline bool parseCaptureFormat(const char* name, CaptureFormat &format){
+    if (std::strcmp(name, "png") == 0)
+        format = CaptureFormat::PNG;
+    else if (std::strcmp(name, "raw") == 0)
+        format = CaptureFormat::RAW;
+    else {
+        std::cout << "ERROR::FRAME_CAPTURE::UNKNOWN_FORMAT " << name << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+class FrameCapture {
+public:
+    // PBOs in flight, frame N is read into slot N % RING_SIZE while the slot of frame N - 2 is mapped
+    static const unsigned int RING_SIZE = 3;
+    static const unsigned int READ_LATENCY = 2;
+
+    FrameCapture() = default;
+    FrameCapture(const FrameCapture &) = delete;
+    FrameCapture &operator=(const FrameCapture &) = delete;
+    ~FrameCapture() { finish(); }
+
+    // needs a current context; files are written as <directory>/frame_<index>.png (or .raw, tightly packed RGBA
+    // rows from bottom to top, as returned by OpenGL)
+    void init(unsigned int width, unsigned int height, const std::string &directory,
+              CaptureFormat captureFormat = CaptureFormat::PNG, unsigned int maxQueuedFrames = 8){
+        finish();
+        frameWidth = width;
+        frameHeight = height;
+        outputDirectory = directory;
+        format = captureFormat;
+        maxQueued = maxQueuedFrames;
+        issued = mapped = written = waits = 0;
+
+        glGenBuffers(RING_SIZE, PBOs);
+        for (unsigned int i = 0; i < RING_SIZE; i++){
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, PBOs[i]);
+            glBufferData(GL_PIXEL_PACK_BUFFER, frameSize(), nullptr, GL_STREAM_READ);
+            slots[i] = Slot();
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        stopping = false;
+        encoder = std::thread(&FrameCapture::encodeFrames, this);
+    }
+
+    bool isActive() const { return encoder.joinable(); }
+
+    // queues the readback of the color attachment 0 of readFramebuffer (0 for the window), call it after the
+    // frame is rendered and before the buffers are swapped
+    void capture(unsigned int readFramebuffer, unsigned int frameIndex){
+        if (!isActive())
+            return;
+        Slot &slot = slots[issued % RING_SIZE];
+        // the ring is full, the oldest readback has to be consumed before its PBO is reused
+        if (slot.pending)
+            mapSlot(slot);
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, readFramebuffer);
+        glReadBuffer(readFramebuffer ? GL_COLOR_ATTACHMENT0 : GL_BACK);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, PBOs[issued % RING_SIZE]);
+        glReadPixels(0, 0, (GLsizei) frameWidth, (GLsizei) frameHeight, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        slot.frameIndex = frameIndex;
+        slot.pending = true;
+        issued++;
+
+        // consume the readback issued READ_LATENCY captures ago
+        if (issued > READ_LATENCY){
+            Slot &old = slots[(issued - 1 - READ_LATENCY) % RING_SIZE];
+            if (old.pending)
+                mapSlot(old);
+        }
+    }
+
+    // maps the readbacks still in flight, waits until the encoder has written every frame and stops it
+    void finish(){
+        if (!isActive())
+            return;
+        for (unsigned int i = 0; i < RING_SIZE; i++){
+            Slot &slot = slots[(issued + i) % RING_SIZE];
+            if (slot.pending)
+                mapSlot(slot);
+        }
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopping = true;
+        }
+        queueChanged.notify_all();
+        encoder.join();
+        glDeleteBuffers(RING_SIZE, PBOs);
+    }
+
+    void printSummary(std::ostream &out) const{
+        out << "captured " << mapped << " frames, " << written << " written, "
+            << waits << " waits for the encoder" << std::endl;
+    }
+
+private:
+    struct Slot {
+        GLsync fence = nullptr;
+        unsigned int frameIndex = 0;
+        bool pending = false;
+    };
+
+    struct EncodedFrame {
+        unsigned int frameIndex;
+        std::vector<unsigned char> pixels;
+    };
+
+    size_t frameSize() const { return (size_t) frameWidth * frameHeight * 4; }
+
+    // copies the pixels of a finished readback to the encoder queue
+    void mapSlot(Slot &slot){
+        CPU_SCOPE("mapSlot");
+        // the fence is signaled already unless the GPU is more than READ_LATENCY frames behind
+        glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+        slot.pending = false;
+
+        EncodedFrame encoded;
+        encoded.frameIndex = slot.frameIndex;
+        {
+            // wait for the encoder instead of dropping the frame, and reuse the buffers it has written
+            std::unique_lock<std::mutex> lock(queueMutex);
+            if (queue.size() >= maxQueued){
+                waits++;
+                queueChanged.wait(lock, [this]{ return queue.size() < maxQueued; });
+            }
+            if (!freeBuffers.empty()){
+                encoded.pixels.swap(freeBuffers.back());
+                freeBuffers.pop_back();
+            }
+        }
+        encoded.pixels.resize(frameSize());
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, PBOs[&slot - slots]);
+        void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr) frameSize(), GL_MAP_READ_BIT);
+        if (data){
+            std::memcpy(encoded.pixels.data(), data, frameSize());
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        else
+            std::cout << "ERROR::FRAME_CAPTURE::MAP_FAILED " << slot.frameIndex << std::endl;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        if (!data)
+            return;
+
+        mapped++;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            queue.push_back(std::move(encoded));
+        }
+        queueChanged.notify_all();
+    }
+
+    // encoder thread
+    void encodeFrames(){
+        cpuProfiler().setThreadName("frame encoder");
+        std::unique_lock<std::mutex> lock(queueMutex);
+        while (true){
+            queueChanged.wait(lock, [this]{ return stopping || !queue.empty(); });
+            if (queue.empty())
+                return;
+            EncodedFrame encoded = std::move(queue.front());
+            queue.pop_front();
+            lock.unlock();
+            queueChanged.notify_all();
+
+            bool ok = writeFrame(encoded);
+
+            lock.lock();
+            if (ok)
+                written++;
+            freeBuffers.push_back(std::move(encoded.pixels));
+        }
+    }
+
+    bool writeFrame(const EncodedFrame &encoded) const{
+        CPU_SCOPE("writeFrame");
+        char name[32];
+        std::snprintf(name, sizeof(name), "/frame_%05u.%s", encoded.frameIndex, format == CaptureFormat::PNG ? "png" : "raw");
+        std::string path = outputDirectory + name;
+        if (format == CaptureFormat::PNG)
+            return writePng(path, frameWidth, frameHeight, encoded.pixels.data(), true);
+
+        FILE* file = std::fopen(path.c_str(), "wb");
+        bool ok = file && std::fwrite(encoded.pixels.data(), 1, encoded.pixels.size(), file) == encoded.pixels.size();
+        if (file)
+            std::fclose(file);
+        if (!ok)
+            std::cout << "ERROR::FRAME_CAPTURE::CANNOT_WRITE " << path << std::endl;
+        return ok;
+    }
+
+    unsigned int frameWidth = 0, frameHeight = 0;
+    std::string outputDirectory;
+    CaptureFormat format = CaptureFormat::PNG;
+    unsigned int maxQueued = 8;
+
+    // render thread
+    unsigned int PBOs[RING_SIZE] = {0, 0, 0};
+    Slot slots[RING_SIZE];
+    unsigned int issued = 0, mapped = 0, waits = 0;
+
+    // shared with the encoder thread, guarded by queueMutex
+    std::thread encoder;
+    std::mutex queueMutex;
+    std::condition_variable queueChanged;
+    std::deque<EncodedFrame> queue;
+    std::vector<std::vector<unsigned char>> freeBuffers;
+    unsigned int written = 0;
+    bool stopping = false;
+};
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_FRAME_CAPTURE_H
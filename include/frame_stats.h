@@ -0,0 +1,33 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_FRAME_STATS_H
+#define GRAPHICSPROGRAMMINGEXERCISES_FRAME_STATS_H
+
+#include <vector>
+#include <algorithm>
+
+// summary of a series of frame times, the percentiles use the nearest rank
+// -----------------------------------------------------------------------
+
+struct FrameTimeStats {
+    float averageMs = 0, p50Ms = 0, p95Ms = 0, p99Ms = 0, maxMs = 0;
+};
+
+inline FrameTimeStats computeFrameTimeStats(std::vector<float> frameTimesMs){
+    FrameTimeStats stats;
+    if (frameTimesMs.empty())
+        return stats;
+    std::sort(frameTimesMs.begin(), frameTimesMs.end());
+    auto percentile = [&frameTimesMs](float p){
+        size_t rank = (size_t) (p * (float) frameTimesMs.size() + .999f);
+        return frameTimesMs[std::min(std::max<size_t>(rank, 1), frameTimesMs.size()) - 1];
+    };
+    for (float ms : frameTimesMs)
+        stats.averageMs += ms;
+    stats.averageMs /= (float) frameTimesMs.size();
+    stats.p50Ms = percentile(.50f);
+    stats.p95Ms = percentile(.95f);
+    stats.p99Ms = percentile(.99f);
+    stats.maxMs = frameTimesMs.back();
+    return stats;
+}
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_FRAME_STATS_H
@@ -0,0 +1,322 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_FRUSTUM_CULLING_H
+#define GRAPHICSPROGRAMMINGEXERCISES_FRUSTUM_CULLING_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FRUSTUM_CULLING_SSE
+#endif
+
+#include "bounds.h"
+
+// view frustum as 6 planes (left, right, bottom, top, near, far), each stored as (normal, distance)
+// with the normal pointing inside the frustum, so that dot(normal, p) + distance >= 0 for points inside
+// -------------------------------------------------------------------------------------------------------
+struct Frustum {
+    glm::vec4 planes[6];
+};
+
+// extract the frustum planes from a view projection matrix (Gribb and Hartmann),
+// the planes are in the space the matrix transforms from (world space for projection * view)
+inline Frustum extractFrustum(const glm::mat4 &viewProjection){
+    // rows of the matrix, glm is column major so m[col][row]
+    glm::vec4 row[4];
+    for (int i = 0; i < 4; i++)
+        row[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+
+    Frustum frustum;
+    frustum.planes[0] = row[3] + row[0]; // left
+    frustum.planes[1] = row[3] - row[0]; // right
+    frustum.planes[2] = row[3] + row[1]; // bottom
+    frustum.planes[3] = row[3] - row[1]; // top
+    frustum.planes[4] = row[3] + row[2]; // near
+    frustum.planes[5] = row[3] - row[2]; // far
+    for (glm::vec4 &plane : frustum.planes){
+        float length = glm::length(glm::vec3(plane));
+        if (length > 0.0f)
+            plane /= length;
+    }
+    return frustum;
+}
+
+// result of testing a volume against the frustum
+enum class FrustumTest { OUTSIDE, INTERSECTS, INSIDE };
+
+inline FrustumTest testSphere(const Frustum &frustum, const BoundingSphere &sphere){
+    FrustumTest result = FrustumTest::INSIDE;
+    for (const glm::vec4 &plane : frustum.planes){
+        float d = glm::dot(glm::vec3(plane), sphere.center) + plane.w;
+        if (d < -sphere.radius)
+            return FrustumTest::OUTSIDE;
+        if (d < sphere.radius)
+            result = FrustumTest::INTERSECTS;
+    }
+    return result;
+}
+
+inline FrustumTest testAABB(const Frustum &frustum, const AABB &box){
+    glm::vec3 center = box.center(), extents = box.extents();
+    FrustumTest result = FrustumTest::INSIDE;
+    for (const glm::vec4 &plane : frustum.planes){
+        glm::vec3 normal(plane);
+        float d = glm::dot(normal, center) + plane.w;
+        float r = glm::dot(glm::abs(normal), extents);
+        if (d < -r)
+            return FrustumTest::OUTSIDE;
+        if (d < r)
+            result = FrustumTest::INTERSECTS;
+    }
+    return result;
+}
+
+
+// 8 boxes in structure of arrays layout (center and extents), so that they can be tested in a single pass
+// -------------------------------------------------------------------------------------------------------
+struct AABBBatch8 {
+    float centerX[8] = {}, centerY[8] = {}, centerZ[8] = {};
+    float extentX[8] = {}, extentY[8] = {}, extentZ[8] = {};
+    unsigned int count = 0; // number of lanes in use
+
+    void set(unsigned int lane, const AABB &box){
+        glm::vec3 c = box.center(), e = box.extents();
+        centerX[lane] = c.x; centerY[lane] = c.y; centerZ[lane] = c.z;
+        extentX[lane] = e.x; extentY[lane] = e.y; extentZ[lane] = e.z;
+    }
+};
+
+// tests the 8 boxes of the batch against the frustum, bit i of the return value is set if box i is (partially) visible
+// uses AVX when available (8 boxes per instruction), two SSE halves otherwise, and plain C++ as the last resort
+inline unsigned int testAABBBatch8(const Frustum &frustum, const AABBBatch8 &batch){
+    unsigned int laneMask = (1u << batch.count) - 1u;
+#if defined(__AVX__)
+    __m256 cx = _mm256_loadu_ps(batch.centerX), cy = _mm256_loadu_ps(batch.centerY), cz = _mm256_loadu_ps(batch.centerZ);
+    __m256 ex = _mm256_loadu_ps(batch.extentX), ey = _mm256_loadu_ps(batch.extentY), ez = _mm256_loadu_ps(batch.extentZ);
+    __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (const glm::vec4 &plane : frustum.planes){
+        __m256 nx = _mm256_set1_ps(plane.x), ny = _mm256_set1_ps(plane.y), nz = _mm256_set1_ps(plane.z);
+        // distance of the center to the plane, and projected radius of the box on the plane normal
+        __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, cx), _mm256_mul_ps(ny, cy)),
+                                 _mm256_add_ps(_mm256_mul_ps(nz, cz), _mm256_set1_ps(plane.w)));
+        __m256 r = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(std::abs(plane.x)), ex),
+                                               _mm256_mul_ps(_mm256_set1_ps(std::abs(plane.y)), ey)),
+                                 _mm256_mul_ps(_mm256_set1_ps(std::abs(plane.z)), ez));
+        visible = _mm256_and_ps(visible, _mm256_cmp_ps(_mm256_add_ps(d, r), _mm256_setzero_ps(), _CMP_GE_OQ));
+    }
+    return (unsigned int) _mm256_movemask_ps(visible) & laneMask;
+#elif defined(FRUSTUM_CULLING_SSE)
+    unsigned int mask = 0;
+    for (int half = 0; half < 8; half += 4){
+        __m128 cx = _mm_loadu_ps(batch.centerX + half), cy = _mm_loadu_ps(batch.centerY + half), cz = _mm_loadu_ps(batch.centerZ + half);
+        __m128 ex = _mm_loadu_ps(batch.extentX + half), ey = _mm_loadu_ps(batch.extentY + half), ez = _mm_loadu_ps(batch.extentZ + half);
+        __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const glm::vec4 &plane : frustum.planes){
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), cx), _mm_mul_ps(_mm_set1_ps(plane.y), cy)),
+                                  _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), cz), _mm_set1_ps(plane.w)));
+            __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(std::abs(plane.x)), ex),
+                                             _mm_mul_ps(_mm_set1_ps(std::abs(plane.y)), ey)),
+                                  _mm_mul_ps(_mm_set1_ps(std::abs(plane.z)), ez));
+            visible = _mm_and_ps(visible, _mm_cmpge_ps(_mm_add_ps(d, r), _mm_setzero_ps()));
+        }
+        mask |= (unsigned int) _mm_movemask_ps(visible) << half;
+    }
+    return mask & laneMask;
+#else
+    unsigned int mask = 0;
+    for (unsigned int i = 0; i < batch.count; i++){
+        bool visible = true;
+        for (const glm::vec4 &plane : frustum.planes){
+            float d = plane.x * batch.centerX[i] + plane.y * batch.centerY[i] + plane.z * batch.centerZ[i] + plane.w;
+            float r = std::abs(plane.x) * batch.extentX[i] + std::abs(plane.y) * batch.extentY[i] + std::abs(plane.z) * batch.extentZ[i];
+            visible = visible && (d + r >= 0.0f);
+        }
+        mask |= (visible ? 1u : 0u) << i;
+    }
+    return mask;
+#endif
+}
+
+
+// culling counters, reset every frame
+// -----------------------------------
+struct CullingStats {
+    unsigned int tested = 0;    // objects whose bounds were tested against the frustum
+    unsigned int culled = 0;    // objects found to be outside of the frustum
+    unsigned int drawn = 0;     // objects that passed the test and should be drawn
+};
+
+
+// flat list of world space boxes, tested 8 at a time
+// --------------------------------------------------
+class FrustumCuller {
+public:
+    // adds a box and returns the object index, which is what cull() reports back
+    unsigned int add(const AABB &worldBounds){
+        unsigned int index = objectCount++;
+        if (index / 8 == batches.size())
+            batches.push_back(AABBBatch8());
+        AABBBatch8 &batch = batches[index / 8];
+        batch.set(index % 8, worldBounds);
+        batch.count = index % 8 + 1;
+        return index;
+    }
+
+    void update(unsigned int index, const AABB &worldBounds){
+        batches[index / 8].set(index % 8, worldBounds);
+    }
+
+    void clear(){
+        batches.clear();
+        objectCount = 0;
+    }
+
+    unsigned int size() const { return objectCount; }
+
+    // appends the indices of the visible objects to 'visible'
+    void cull(const Frustum &frustum, std::vector<unsigned int> &visible, CullingStats &stats) const{
+        for (unsigned int b = 0; b < batches.size(); b++){
+            const AABBBatch8 &batch = batches[b];
+            unsigned int mask = testAABBBatch8(frustum, batch);
+            for (unsigned int i = 0; i < batch.count; i++)
+                if (mask & (1u << i))
+                    visible.push_back(b * 8 + i);
+            unsigned int drawn = bitCount(mask);
+            stats.tested += batch.count;
+            stats.drawn += drawn;
+            stats.culled += batch.count - drawn;
+        }
+    }
+
+    static unsigned int bitCount(unsigned int mask){
+        unsigned int count = 0;
+        for (; mask; mask &= mask - 1)
+            count++;
+        return count;
+    }
+
+private:
+    std::vector<AABBBatch8> batches;
+    unsigned int objectCount = 0;
+};
+
+
+// bounding volume hierarchy over static world space boxes, for scenes too large for the flat list;
+// subtrees fully outside the frustum are rejected and subtrees fully inside are accepted without testing their objects,
+// leaves hold up to 8 objects and are tested with testAABBBatch8
+// --------------------------------------------------------------------------------------------------
+class BoundingVolumeHierarchy {
+public:
+    void build(const std::vector<AABB> &objectBounds){
+        nodes.clear();
+        leaves.clear();
+        objectIndices.resize(objectBounds.size());
+        for (unsigned int i = 0; i < objectIndices.size(); i++)
+            objectIndices[i] = i;
+        if (objectBounds.empty())
+            return;
+        nodes.reserve(objectBounds.size() / 4 + 1);
+        buildNode(objectBounds, 0, (unsigned int) objectBounds.size());
+    }
+
+    unsigned int size() const { return (unsigned int) objectIndices.size(); }
+
+    // appends the indices of the visible objects to 'visible'
+    void cull(const Frustum &frustum, std::vector<unsigned int> &visible, CullingStats &stats) const{
+        if (nodes.empty())
+            return;
+        unsigned int stack[64];
+        unsigned int stackSize = 0;
+        stack[stackSize++] = 0;
+        while (stackSize > 0){
+            const Node &node = nodes[stack[--stackSize]];
+            FrustumTest test = testAABB(frustum, node.bounds);
+            if (test == FrustumTest::OUTSIDE){
+                stats.culled += node.count;
+            }
+            else if (test == FrustumTest::INSIDE){
+                visible.insert(visible.end(), objectIndices.begin() + node.first, objectIndices.begin() + node.first + node.count);
+                stats.drawn += node.count;
+            }
+            else if (node.leaf != NO_LEAF){
+                const AABBBatch8 &batch = leaves[node.leaf];
+                unsigned int mask = testAABBBatch8(frustum, batch);
+                for (unsigned int i = 0; i < batch.count; i++)
+                    if (mask & (1u << i))
+                        visible.push_back(objectIndices[node.first + i]);
+                unsigned int drawn = FrustumCuller::bitCount(mask);
+                stats.tested += batch.count;
+                stats.drawn += drawn;
+                stats.culled += batch.count - drawn;
+            }
+            else {
+                stack[stackSize++] = node.right;
+                stack[stackSize++] = node.left;
+            }
+        }
+    }
+
+private:
+    static const unsigned int NO_LEAF = ~0u;
+    static const unsigned int MAX_LEAF_SIZE = 8;
+
+    struct Node {
+        AABB bounds;
+        unsigned int first, count;      // range in objectIndices covered by this subtree
+        unsigned int left, right;       // children, used by inner nodes
+        unsigned int leaf;              // index in leaves, NO_LEAF for inner nodes
+    };
+
+    // median split along the longest axis of the centroids, the depth is bounded by log2(n / MAX_LEAF_SIZE)
+    unsigned int buildNode(const std::vector<AABB> &objectBounds, unsigned int first, unsigned int count){
+        unsigned int nodeIndex = (unsigned int) nodes.size();
+        nodes.push_back(Node());
+
+        AABB bounds, centroids;
+        for (unsigned int i = first; i < first + count; i++){
+            bounds.expand(objectBounds[objectIndices[i]]);
+            centroids.expand(objectBounds[objectIndices[i]].center());
+        }
+
+        Node node;
+        node.bounds = bounds;
+        node.first = first;
+        node.count = count;
+        node.left = node.right = 0;
+        node.leaf = NO_LEAF;
+
+        if (count <= MAX_LEAF_SIZE){
+            AABBBatch8 batch;
+            for (unsigned int i = 0; i < count; i++)
+                batch.set(i, objectBounds[objectIndices[first + i]]);
+            batch.count = count;
+            node.leaf = (unsigned int) leaves.size();
+            leaves.push_back(batch);
+        }
+        else {
+            glm::vec3 size = centroids.max - centroids.min;
+            int axis = size.x > size.y ? (size.x > size.z ? 0 : 2) : (size.y > size.z ? 1 : 2);
+            unsigned int half = count / 2;
+            std::nth_element(objectIndices.begin() + first, objectIndices.begin() + first + half,
+                             objectIndices.begin() + first + count,
+                             [&objectBounds, axis](unsigned int a, unsigned int b){
+                return objectBounds[a].center()[axis] < objectBounds[b].center()[axis];
+            });
+            node.left = buildNode(objectBounds, first, half);
+            node.right = buildNode(objectBounds, first + half, count - half);
+        }
+        nodes[nodeIndex] = node;
+        return nodeIndex;
+    }
+
+    std::vector<Node> nodes;
+    std::vector<AABBBatch8> leaves;
+    std::vector<unsigned int> objectIndices;
+};
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_FRUSTUM_CULLING_H
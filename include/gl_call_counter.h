@@ -0,0 +1,490 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_GL_CALL_COUNTER_H
+#define GRAPHICSPROGRAMMINGEXERCISES_GL_CALL_COUNTER_H
+
+#include <glad/glad.h>
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+// counts the GL calls of every frame by swapping the glad function pointers (glad_glDrawArrays, ...) for hooks that
+// count and forward the call, so no code has to change to be measured; call install() once glad is loaded.
+// Besides the number of calls of each intercepted function it sums the bytes uploaded to buffers and textures and
+// tracks the bound VAO, program, buffers, textures, framebuffer and enabled capabilities, to flag the binds that
+// do not change anything. The tracking assumes all GL calls go through glad: call invalidate() after code that
+// uses another loader (e.g. the ImGui OpenGL backend), and pause the counting around calls that should not
+// be measured (e.g. the overlay drawing the stats)
+// ------------------------------------------------------------------------------------------------------------
+
+#define GL_CALL_COUNTER_FUNCTIONS(X) \
+    X(DrawArrays) X(DrawElements) X(DrawArraysInstanced) X(DrawElementsInstanced) X(DrawElementsBaseVertex) \
+    X(DrawElementsInstancedBaseVertex) X(MultiDrawArrays) \
+    X(BufferData) X(BufferSubData) X(DeleteBuffers) X(TexImage2D) X(TexSubImage2D) \
+    X(Uniform1f) X(Uniform2f) X(Uniform3f) X(Uniform4f) X(Uniform1i) X(Uniform1fv) X(Uniform2fv) X(Uniform3fv) \
+    X(Uniform4fv) X(UniformMatrix3fv) X(UniformMatrix4fv) \
+    X(BindVertexArray) X(UseProgram) X(BindBuffer) X(BindTexture) X(ActiveTexture) X(BindFramebuffer) \
+    X(Enable) X(Disable) X(BlendFunc) X(VertexAttribPointer) X(EnableVertexAttribArray)
+
+// functions the loader generated for 3.3 core does not have, code that loads them itself (e.g. indirect_draw.h)
+// reports its calls with countCall() and countDraw()
+#define GL_CALL_COUNTER_EXTERNAL_FUNCTIONS(X) \
+    X(MultiDrawElementsIndirect)
+
+enum class GLFunction {
+#define GL_CALL_COUNTER_ENUM(name) name,
+    GL_CALL_COUNTER_FUNCTIONS(GL_CALL_COUNTER_ENUM)
+    GL_CALL_COUNTER_EXTERNAL_FUNCTIONS(GL_CALL_COUNTER_ENUM)
+#undef GL_CALL_COUNTER_ENUM
+    COUNT
+};
+
+inline const char* glFunctionName(GLFunction function){
+    static const char* names[] = {
+#define GL_CALL_COUNTER_NAME(name) "gl" #name,
+        GL_CALL_COUNTER_FUNCTIONS(GL_CALL_COUNTER_NAME)
+        GL_CALL_COUNTER_EXTERNAL_FUNCTIONS(GL_CALL_COUNTER_NAME)
+#undef GL_CALL_COUNTER_NAME
+    };
+    return names[(int) function];
+}
+
+
+struct GLCallStats {
+    unsigned int calls[(int) GLFunction::COUNT] = {};
+    unsigned int totalCalls = 0;
+    unsigned int drawCalls = 0;
+    unsigned int instances = 0;         // instances drawn by the instanced draw calls, 1 for the others
+    size_t vertices = 0;                // vertices (or indices) submitted, times the instances
+    size_t primitives = 0;              // triangles, lines or points submitted, times the instances
+    unsigned int uniformCalls = 0;
+    unsigned int uploads = 0;           // buffer and texture uploads
+    size_t bytesUploaded = 0;
+    unsigned int stateChanges = 0;      // binds and enable/disable that changed the state
+    unsigned int redundantStateChanges = 0;
+
+    unsigned int count(GLFunction function) const { return calls[(int) function]; }
+
+    void print(std::ostream &out) const{
+        out << "gl calls " << totalCalls << ": draws " << drawCalls << " (" << instances << " instances, "
+            << primitives << " primitives), uniforms "
+            << uniformCalls << ", uploads " << uploads << " (" << bytesUploaded << " bytes), state changes "
+            << stateChanges << " + " << redundantStateChanges << " redundant" << std::endl;
+    }
+
+    // the functions called in the frame, most called first
+    std::vector<GLFunction> calledFunctions() const{
+        std::vector<GLFunction> functions;
+        for (int i = 0; i < (int) GLFunction::COUNT; i++)
+            if (calls[i])
+                functions.push_back((GLFunction) i);
+        std::sort(functions.begin(), functions.end(), [this](GLFunction a, GLFunction b){ return count(a) > count(b); });
+        return functions;
+    }
+};
+
+
+class GLCallCounter {
+public:
+    static const unsigned int TRACKED_TEXTURE_UNITS = 16;
+    static const unsigned int UNKNOWN = ~0u;
+
+    // replaces the glad pointers by the counting hooks, needs gladLoadGL* to have run
+    void install(){
+        if (installed)
+            return;
+#define GL_CALL_COUNTER_INSTALL(name) real.name = glad_gl##name; if (glad_gl##name) glad_gl##name = &name##Hook;
+        GL_CALL_COUNTER_FUNCTIONS(GL_CALL_COUNTER_INSTALL)
+#undef GL_CALL_COUNTER_INSTALL
+        installed = true;
+        invalidate();
+    }
+
+    void uninstall(){
+        if (!installed)
+            return;
+#define GL_CALL_COUNTER_UNINSTALL(name) glad_gl##name = real.name;
+        GL_CALL_COUNTER_FUNCTIONS(GL_CALL_COUNTER_UNINSTALL)
+#undef GL_CALL_COUNTER_UNINSTALL
+        installed = false;
+    }
+
+    bool isInstalled() const { return installed; }
+
+    // for the external functions, which have no hook: counts the call, returns false when it isn't counted
+    bool countCall(GLFunction function){
+        return installed && count(function);
+    }
+    // one of the draws made by a counted call, e.g. a command of a multi draw
+    void countDraw(GLenum mode, size_t vertexCount, unsigned int instances){
+        current.drawCalls++;
+        current.instances += instances;
+        current.vertices += vertexCount * instances;
+        current.primitives += primitiveCount(mode, vertexCount) * instances;
+    }
+
+    // calls made while paused are forwarded without being counted or tracked
+    bool paused = false;
+
+    // closes the statistics of the frame, lastFrame() returns them until the next call
+    void endFrame(){
+        last = current;
+        current = GLCallStats();
+        frames++;
+    }
+
+    const GLCallStats &lastFrame() const { return last; }
+    // bytes of the buffers allocated with glBufferData and not deleted since install()
+    size_t allocatedBufferBytes() const { return bufferBytes; }
+    const GLCallStats &currentFrame() const { return current; }
+    unsigned int frameCount() const { return frames; }
+
+    // forgets the tracked state, the next bind of everything counts as a change
+    void invalidate(){
+        const unsigned int unknown = UNKNOWN;    // std::fill takes a reference, UNKNOWN has no definition
+        vertexArray = program = framebuffer = activeTexture = unknown;
+        std::fill(std::begin(buffers), std::end(buffers), unknown);
+        std::fill(std::begin(textures), std::end(textures), unknown);
+        capabilities.clear();
+        blendFactors = UNKNOWN;
+    }
+
+private:
+    // the pointer types come from glad, e.g. PFNGLDRAWARRAYSPROC for glad_glDrawArrays
+    struct RealFunctions {
+#define GL_CALL_COUNTER_POINTER(name) decltype(glad_gl##name) name = nullptr;
+        GL_CALL_COUNTER_FUNCTIONS(GL_CALL_COUNTER_POINTER)
+#undef GL_CALL_COUNTER_POINTER
+    };
+
+    // buffer targets whose binding is tracked
+    enum BufferTarget { ARRAY, ELEMENT_ARRAY, UNIFORM, PIXEL_PACK, PIXEL_UNPACK, COPY_READ, COPY_WRITE, BUFFER_TARGETS };
+    // texture targets whose binding is tracked for every unit
+    enum TextureTarget { TEXTURE_2D, TEXTURE_3D, TEXTURE_CUBE_MAP, TEXTURE_2D_ARRAY, TEXTURE_TARGETS };
+
+    static int bufferTarget(GLenum target){
+        switch (target){
+            case GL_ARRAY_BUFFER: return ARRAY;
+            case GL_ELEMENT_ARRAY_BUFFER: return ELEMENT_ARRAY;
+            case GL_UNIFORM_BUFFER: return UNIFORM;
+            case GL_PIXEL_PACK_BUFFER: return PIXEL_PACK;
+            case GL_PIXEL_UNPACK_BUFFER: return PIXEL_UNPACK;
+            case GL_COPY_READ_BUFFER: return COPY_READ;
+            case GL_COPY_WRITE_BUFFER: return COPY_WRITE;
+            default: return -1;
+        }
+    }
+
+    static int textureTarget(GLenum target){
+        switch (target){
+            case GL_TEXTURE_2D: return TEXTURE_2D;
+            case GL_TEXTURE_3D: return TEXTURE_3D;
+            case GL_TEXTURE_CUBE_MAP: return TEXTURE_CUBE_MAP;
+            case GL_TEXTURE_2D_ARRAY: return TEXTURE_2D_ARRAY;
+            default: return -1;
+        }
+    }
+
+    // size of the client data of a texture upload, for the common formats
+    static size_t pixelBytes(GLsizei width, GLsizei height, GLenum format, GLenum type){
+        size_t channels = 4;
+        switch (format){
+            case GL_RED: case GL_DEPTH_COMPONENT: channels = 1; break;
+            case GL_RG: channels = 2; break;
+            case GL_RGB: case GL_BGR: channels = 3; break;
+            default: break;
+        }
+        size_t channelBytes = 1;
+        switch (type){
+            case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT: channelBytes = 2; break;
+            case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT: channelBytes = 4; break;
+            default: break;
+        }
+        return (size_t) width * height * channels * channelBytes;
+    }
+
+    // records a call, returns false when paused
+    bool count(GLFunction function){
+        if (paused)
+            return false;
+        current.calls[(int) function]++;
+        current.totalCalls++;
+        return true;
+    }
+
+    static size_t primitiveCount(GLenum mode, size_t vertices){
+        switch (mode){
+            case GL_TRIANGLES: return vertices / 3;
+            case GL_TRIANGLE_STRIP: case GL_TRIANGLE_FAN: return vertices > 2 ? vertices - 2 : 0;
+            case GL_LINES: return vertices / 2;
+            case GL_LINE_STRIP: return vertices > 1 ? vertices - 1 : 0;
+            case GL_LINE_LOOP: return vertices > 1 ? vertices : 0;
+            default: return vertices;
+        }
+    }
+
+    void draw(GLFunction function, GLenum mode, GLsizei vertexCount, unsigned int instances){
+        if (count(function))
+            countDraw(mode, (size_t) vertexCount, instances);
+    }
+
+    void uniform(GLFunction function){
+        if (count(function))
+            current.uniformCalls++;
+    }
+
+    void upload(GLFunction function, size_t bytes){
+        if (!count(function))
+            return;
+        current.uploads++;
+        current.bytesUploaded += bytes;
+    }
+
+    // counts a change of a tracked piece of state
+    void setState(GLFunction function, unsigned int &state, unsigned int value){
+        if (!count(function))
+            return;
+        if (state == value)
+            current.redundantStateChanges++;
+        else
+            current.stateChanges++;
+        state = value;
+    }
+
+    unsigned int &capability(GLenum cap){
+        for (std::pair<GLenum, unsigned int> &entry : capabilities)
+            if (entry.first == cap)
+                return entry.second;
+        capabilities.emplace_back(cap, (unsigned int) UNKNOWN);
+        return capabilities.back().second;
+    }
+
+    static GLCallCounter &self();
+
+    // hooks, with the calling convention of the GL functions
+    static void APIENTRY DrawArraysHook(GLenum mode, GLint first, GLsizei count){
+        self().draw(GLFunction::DrawArrays, mode, count, 1);
+        self().real.DrawArrays(mode, first, count);
+    }
+    static void APIENTRY DrawElementsHook(GLenum mode, GLsizei count, GLenum type, const void* indices){
+        self().draw(GLFunction::DrawElements, mode, count, 1);
+        self().real.DrawElements(mode, count, type, indices);
+    }
+    static void APIENTRY DrawArraysInstancedHook(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount){
+        self().draw(GLFunction::DrawArraysInstanced, mode, count, (unsigned int) instanceCount);
+        self().real.DrawArraysInstanced(mode, first, count, instanceCount);
+    }
+    static void APIENTRY DrawElementsInstancedHook(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instanceCount){
+        self().draw(GLFunction::DrawElementsInstanced, mode, count, (unsigned int) instanceCount);
+        self().real.DrawElementsInstanced(mode, count, type, indices, instanceCount);
+    }
+    static void APIENTRY DrawElementsBaseVertexHook(GLenum mode, GLsizei count, GLenum type, const void* indices, GLint baseVertex){
+        self().draw(GLFunction::DrawElementsBaseVertex, mode, count, 1);
+        self().real.DrawElementsBaseVertex(mode, count, type, indices, baseVertex);
+    }
+    static void APIENTRY DrawElementsInstancedBaseVertexHook(GLenum mode, GLsizei count, GLenum type, const void* indices,
+                                                            GLsizei instanceCount, GLint baseVertex){
+        self().draw(GLFunction::DrawElementsInstancedBaseVertex, mode, count, (unsigned int) instanceCount);
+        self().real.DrawElementsInstancedBaseVertex(mode, count, type, indices, instanceCount, baseVertex);
+    }
+    static void APIENTRY MultiDrawArraysHook(GLenum mode, const GLint* first, const GLsizei* count, GLsizei drawCount){
+        GLCallCounter &counter = self();
+        // one call, drawCount draws
+        if (counter.count(GLFunction::MultiDrawArrays))
+            for (GLsizei i = 0; i < drawCount; i++)
+                counter.countDraw(mode, (size_t) count[i], 1);
+        counter.real.MultiDrawArrays(mode, first, count, drawCount);
+    }
+
+    static void APIENTRY BufferDataHook(GLenum target, GLsizeiptr size, const void* data, GLenum usage){
+        GLCallCounter &counter = self();
+        counter.upload(GLFunction::BufferData, data ? (size_t) size : 0);
+        // the allocation is attributed to the buffer bound to the target, when it is known
+        int index = bufferTarget(target);
+        if (index >= 0 && counter.buffers[index] != UNKNOWN){
+            size_t &allocated = counter.bufferSizes[counter.buffers[index]];
+            counter.bufferBytes += (size_t) size - allocated;
+            allocated = (size_t) size;
+        }
+        counter.real.BufferData(target, size, data, usage);
+    }
+    static void APIENTRY DeleteBuffersHook(GLsizei n, const GLuint* buffers){
+        GLCallCounter &counter = self();
+        counter.count(GLFunction::DeleteBuffers);
+        for (GLsizei i = 0; i < n; i++){
+            auto found = counter.bufferSizes.find(buffers[i]);
+            if (found != counter.bufferSizes.end()){
+                counter.bufferBytes -= found->second;
+                counter.bufferSizes.erase(found);
+            }
+            // a deleted buffer is unbound, and its name can be reused
+            for (unsigned int &bound : counter.buffers)
+                if (bound == buffers[i])
+                    bound = UNKNOWN;
+        }
+        counter.real.DeleteBuffers(n, buffers);
+    }
+    static void APIENTRY BufferSubDataHook(GLenum target, GLintptr offset, GLsizeiptr size, const void* data){
+        self().upload(GLFunction::BufferSubData, (size_t) size);
+        self().real.BufferSubData(target, offset, size, data);
+    }
+    static void APIENTRY TexImage2DHook(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height,
+                                        GLint border, GLenum format, GLenum type, const void* pixels){
+        self().upload(GLFunction::TexImage2D, pixels ? pixelBytes(width, height, format, type) : 0);
+        self().real.TexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+    }
+    static void APIENTRY TexSubImage2DHook(GLenum target, GLint level, GLint xOffset, GLint yOffset, GLsizei width,
+                                           GLsizei height, GLenum format, GLenum type, const void* pixels){
+        self().upload(GLFunction::TexSubImage2D, pixelBytes(width, height, format, type));
+        self().real.TexSubImage2D(target, level, xOffset, yOffset, width, height, format, type, pixels);
+    }
+
+    static void APIENTRY Uniform1fHook(GLint location, GLfloat v0){
+        self().uniform(GLFunction::Uniform1f);
+        self().real.Uniform1f(location, v0);
+    }
+    static void APIENTRY Uniform2fHook(GLint location, GLfloat v0, GLfloat v1){
+        self().uniform(GLFunction::Uniform2f);
+        self().real.Uniform2f(location, v0, v1);
+    }
+    static void APIENTRY Uniform3fHook(GLint location, GLfloat v0, GLfloat v1, GLfloat v2){
+        self().uniform(GLFunction::Uniform3f);
+        self().real.Uniform3f(location, v0, v1, v2);
+    }
+    static void APIENTRY Uniform4fHook(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3){
+        self().uniform(GLFunction::Uniform4f);
+        self().real.Uniform4f(location, v0, v1, v2, v3);
+    }
+    static void APIENTRY Uniform1iHook(GLint location, GLint v0){
+        self().uniform(GLFunction::Uniform1i);
+        self().real.Uniform1i(location, v0);
+    }
+    static void APIENTRY Uniform1fvHook(GLint location, GLsizei count, const GLfloat* value){
+        self().uniform(GLFunction::Uniform1fv);
+        self().real.Uniform1fv(location, count, value);
+    }
+    static void APIENTRY Uniform2fvHook(GLint location, GLsizei count, const GLfloat* value){
+        self().uniform(GLFunction::Uniform2fv);
+        self().real.Uniform2fv(location, count, value);
+    }
+    static void APIENTRY Uniform3fvHook(GLint location, GLsizei count, const GLfloat* value){
+        self().uniform(GLFunction::Uniform3fv);
+        self().real.Uniform3fv(location, count, value);
+    }
+    static void APIENTRY Uniform4fvHook(GLint location, GLsizei count, const GLfloat* value){
+        self().uniform(GLFunction::Uniform4fv);
+        self().real.Uniform4fv(location, count, value);
+    }
+    static void APIENTRY UniformMatrix3fvHook(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value){
+        self().uniform(GLFunction::UniformMatrix3fv);
+        self().real.UniformMatrix3fv(location, count, transpose, value);
+    }
+    static void APIENTRY UniformMatrix4fvHook(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value){
+        self().uniform(GLFunction::UniformMatrix4fv);
+        self().real.UniformMatrix4fv(location, count, transpose, value);
+    }
+
+    static void APIENTRY BindVertexArrayHook(GLuint array){
+        GLCallCounter &counter = self();
+        if (counter.vertexArray != array)
+            // the element array binding is part of the vertex array state
+            counter.buffers[ELEMENT_ARRAY] = UNKNOWN;
+        counter.setState(GLFunction::BindVertexArray, counter.vertexArray, array);
+        counter.real.BindVertexArray(array);
+    }
+    static void APIENTRY UseProgramHook(GLuint program){
+        self().setState(GLFunction::UseProgram, self().program, program);
+        self().real.UseProgram(program);
+    }
+    static void APIENTRY BindBufferHook(GLenum target, GLuint buffer){
+        GLCallCounter &counter = self();
+        int index = bufferTarget(target);
+        unsigned int untracked = UNKNOWN;
+        counter.setState(GLFunction::BindBuffer, index >= 0 ? counter.buffers[index] : untracked, buffer);
+        counter.real.BindBuffer(target, buffer);
+    }
+    static void APIENTRY BindTextureHook(GLenum target, GLuint texture){
+        GLCallCounter &counter = self();
+        int index = textureTarget(target);
+        unsigned int unit = counter.activeTexture == UNKNOWN ? 0 : counter.activeTexture;
+        unsigned int untracked = UNKNOWN;
+        bool tracked = index >= 0 && unit < TRACKED_TEXTURE_UNITS && counter.activeTexture != UNKNOWN;
+        counter.setState(GLFunction::BindTexture, tracked ? counter.textures[unit * TEXTURE_TARGETS + index] : untracked, texture);
+        counter.real.BindTexture(target, texture);
+    }
+    static void APIENTRY ActiveTextureHook(GLenum texture){
+        self().setState(GLFunction::ActiveTexture, self().activeTexture, texture - GL_TEXTURE0);
+        self().real.ActiveTexture(texture);
+    }
+    static void APIENTRY BindFramebufferHook(GLenum target, GLuint framebuffer){
+        GLCallCounter &counter = self();
+        unsigned int untracked = UNKNOWN;
+        // only the draw framebuffer binding (GL_FRAMEBUFFER binds both) is tracked
+        counter.setState(GLFunction::BindFramebuffer, target != GL_READ_FRAMEBUFFER ? counter.framebuffer : untracked, framebuffer);
+        counter.real.BindFramebuffer(target, framebuffer);
+    }
+    static void APIENTRY EnableHook(GLenum cap){
+        GLCallCounter &counter = self();
+        counter.setState(GLFunction::Enable, counter.capability(cap), 1);
+        counter.real.Enable(cap);
+    }
+    static void APIENTRY DisableHook(GLenum cap){
+        GLCallCounter &counter = self();
+        counter.setState(GLFunction::Disable, counter.capability(cap), 0);
+        counter.real.Disable(cap);
+    }
+    static void APIENTRY BlendFuncHook(GLenum source, GLenum destination){
+        GLCallCounter &counter = self();
+        // both factors as one value
+        unsigned int factors = (source << 16) ^ destination;
+        counter.setState(GLFunction::BlendFunc, counter.blendFactors, factors);
+        counter.real.BlendFunc(source, destination);
+    }
+    static void APIENTRY VertexAttribPointerHook(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride,
+                                                 const void* pointer){
+        self().count(GLFunction::VertexAttribPointer);
+        self().real.VertexAttribPointer(index, size, type, normalized, stride, pointer);
+    }
+    static void APIENTRY EnableVertexAttribArrayHook(GLuint index){
+        self().count(GLFunction::EnableVertexAttribArray);
+        self().real.EnableVertexAttribArray(index);
+    }
+
+    RealFunctions real;
+    bool installed = false;
+    GLCallStats current, last;
+    unsigned int frames = 0;
+
+    // tracked state, UNKNOWN until the first bind after install() or invalidate()
+    unsigned int vertexArray = UNKNOWN, program = UNKNOWN, framebuffer = UNKNOWN, activeTexture = UNKNOWN;
+    unsigned int buffers[BUFFER_TARGETS];
+    unsigned int textures[TRACKED_TEXTURE_UNITS * TEXTURE_TARGETS];
+    std::vector<std::pair<GLenum, unsigned int>> capabilities;
+    std::unordered_map<GLuint, size_t> bufferSizes;
+    size_t bufferBytes = 0;
+    unsigned int blendFactors = UNKNOWN;
+};
+
+// the counter used by the hooks
+inline GLCallCounter &glCallCounter(){
+    static GLCallCounter instance;
+    return instance;
+}
+
+inline GLCallCounter &GLCallCounter::self(){
+    return glCallCounter();
+}
+
+// pauses the counting until the end of the enclosing block
+class GLCallCounterPause {
+public:
+    GLCallCounterPause() : wasPaused(glCallCounter().paused) { glCallCounter().paused = true; }
+    ~GLCallCounterPause() { glCallCounter().paused = wasPaused; }
+    GLCallCounterPause(const GLCallCounterPause &) = delete;
+    GLCallCounterPause &operator=(const GLCallCounterPause &) = delete;
+private:
+    bool wasPaused;
+};
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_GL_CALL_COUNTER_H
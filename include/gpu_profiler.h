@@ -0,0 +1,241 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_GPU_PROFILER_H
+#define GRAPHICSPROGRAMMINGEXERCISES_GPU_PROFILER_H
+
+#include <glad/glad.h>
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+
+// GPU time of named scopes of the frame, measured with timer queries (core since GL 3.3):
+//
+//     gpuProfiler().beginFrame();
+//     { GPU_SCOPE("particles"); glDrawArrays(...); }
+//     gpuProfiler().endFrame();
+//
+// every scope writes a GL_TIMESTAMP at its start and end, unlike GL_TIME_ELAPSED queries the timestamps can be
+// nested. The results of a frame are only read once the GPU has finished it, a few frames later, so reading them
+// never stalls the pipeline; when all FRAMES_IN_FLIGHT slots are still waiting on the GPU the frame is simply not
+// measured. Times are aggregated per scope name (min/avg/max in ms) and can be printed or written as CSV
+// ---------------------------------------------------------------------------------------------------------------
+
+class GpuProfiler {
+public:
+    static const unsigned int FRAMES_IN_FLIGHT = 4;
+
+    struct ScopeStats {
+        std::string name;
+        unsigned int depth = 0;         // nesting level of the first use, to indent the report
+        unsigned int count = 0;         // measured frames in which the scope ran
+        double totalMs = 0, minMs = 0, maxMs = 0;
+        double averageMs() const { return count ? totalMs / count : 0; }
+    };
+
+    GpuProfiler() = default;
+    GpuProfiler(const GpuProfiler &) = delete;
+    GpuProfiler &operator=(const GpuProfiler &) = delete;
+
+    // disabled profilers issue no queries, GPU_SCOPE costs one branch then
+    bool enabled = true;
+
+    // collects the finished frames and starts measuring a new one, with a scope named "frame" around it
+    void beginFrame(){
+        collect();
+        FrameQueries &frame = frames[frameIndex % FRAMES_IN_FLIGHT];
+        measuring = enabled && !frame.submitted;
+        if (enabled && !measuring)
+            skippedFrames++;
+        depth = 0;
+        if (measuring)
+            frameScope = begin("frame");
+    }
+
+    void endFrame(){
+        if (!measuring)
+            return;
+        end(frameScope);
+        frames[frameIndex % FRAMES_IN_FLIGHT].submitted = true;
+        frameIndex++;
+        measuring = false;
+    }
+
+    // returns the record to pass to end(), scopes must be closed in reverse order of opening
+    int begin(const char* name){
+        if (!measuring)
+            return -1;
+        FrameQueries &frame = frames[frameIndex % FRAMES_IN_FLIGHT];
+        Record record;
+        record.scope = scopeIndex(name);
+        record.beginQuery = acquireQuery();
+        record.endQuery = acquireQuery();
+        glQueryCounter(record.beginQuery, GL_TIMESTAMP);
+        frame.records.push_back(record);
+        depth++;
+        return (int) frame.records.size() - 1;
+    }
+
+    void end(int record){
+        if (!measuring || record < 0)
+            return;
+        glQueryCounter(frames[frameIndex % FRAMES_IN_FLIGHT].records[record].endQuery, GL_TIMESTAMP);
+        depth--;
+    }
+
+    const std::vector<ScopeStats> &getScopes() const { return scopes; }
+    unsigned int getSkippedFrames() const { return skippedFrames; }
+
+    void resetStats(){
+        for (ScopeStats &scope : scopes){
+            scope.count = 0;
+            scope.totalMs = scope.minMs = scope.maxMs = 0;
+        }
+        skippedFrames = 0;
+    }
+
+    void printStats(std::ostream &out) const{
+        out << "gpu time (ms)            min      avg      max" << std::endl;
+        for (const ScopeStats &scope : scopes){
+            char line[128];
+            std::snprintf(line, sizeof(line), "%*s%-*s %8.3f %8.3f %8.3f", (int) scope.depth * 2, "",
+                          (int) std::max(0, 20 - (int) scope.depth * 2), scope.name.c_str(),
+                          scope.minMs, scope.averageMs(), scope.maxMs);
+            out << line << std::endl;
+        }
+        if (skippedFrames)
+            out << skippedFrames << " frames not measured, the GPU was " << FRAMES_IN_FLIGHT << " frames behind" << std::endl;
+    }
+
+    bool writeCsv(const std::string &path) const{
+        FILE* file = std::fopen(path.c_str(), "w");
+        if (!file){
+            std::cout << "ERROR::GPU_PROFILER::CANNOT_WRITE " << path << std::endl;
+            return false;
+        }
+        std::fprintf(file, "scope,depth,count,min_ms,avg_ms,max_ms\n");
+        for (const ScopeStats &scope : scopes)
+            std::fprintf(file, "%s,%u,%u,%.4f,%.4f,%.4f\n", scope.name.c_str(), scope.depth, scope.count,
+                         scope.minMs, scope.averageMs(), scope.maxMs);
+        std::fclose(file);
+        return true;
+    }
+
+    // waits for the frames in flight and deletes the queries, needs the context to still be current
+    void destroy(){
+        collect(true);
+        for (FrameQueries &frame : frames)
+            frame = FrameQueries();
+        if (!freeQueries.empty())
+            glDeleteQueries((GLsizei) freeQueries.size(), freeQueries.data());
+        freeQueries.clear();
+    }
+
+private:
+    struct Record {
+        unsigned int scope;
+        GLuint beginQuery, endQuery;
+    };
+
+    struct FrameQueries {
+        std::vector<Record> records;
+        bool submitted = false;
+    };
+
+    unsigned int scopeIndex(const char* name){
+        auto found = scopeIndices.find(name);
+        if (found != scopeIndices.end())
+            return found->second;
+        ScopeStats scope;
+        scope.name = name;
+        scope.depth = depth;
+        scopes.push_back(scope);
+        scopeIndices[name] = (unsigned int) scopes.size() - 1;
+        return (unsigned int) scopes.size() - 1;
+    }
+
+    // queries are reused once their results were read, the pool only grows with the number of scopes
+    GLuint acquireQuery(){
+        if (freeQueries.empty()){
+            freeQueries.resize(16);
+            glGenQueries(16, freeQueries.data());
+        }
+        GLuint query = freeQueries.back();
+        freeQueries.pop_back();
+        return query;
+    }
+
+    // reads the submitted frames in order, stopping at the first one the GPU has not finished (unless wait)
+    void collect(bool wait = false){
+        for (unsigned int i = 0; i < FRAMES_IN_FLIGHT; i++){
+            FrameQueries &frame = frames[(frameIndex + i) % FRAMES_IN_FLIGHT];
+            if (!frame.submitted)
+                continue;
+            // the end of the frame scope is the last query written, when it is available all the others are
+            GLint available = 0;
+            glGetQueryObjectiv(frame.records.front().endQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available && !wait)
+                return;
+            // a scope that runs several times in a frame (e.g. once per object) counts as one sample of its total
+            frameTotals.assign(scopes.size(), -1.0);
+            for (const Record &record : frame.records){
+                GLuint64 start = 0, stop = 0;
+                glGetQueryObjectui64v(record.beginQuery, GL_QUERY_RESULT, &start);
+                glGetQueryObjectui64v(record.endQuery, GL_QUERY_RESULT, &stop);
+                frameTotals[record.scope] = std::max(frameTotals[record.scope], 0.0) + (double) (stop - start) / 1e6;
+                freeQueries.push_back(record.beginQuery);
+                freeQueries.push_back(record.endQuery);
+            }
+            for (unsigned int scope = 0; scope < scopes.size(); scope++)
+                if (frameTotals[scope] >= 0)
+                    addSample(scopes[scope], frameTotals[scope]);
+            frame.records.clear();
+            frame.submitted = false;
+        }
+    }
+
+    static void addSample(ScopeStats &scope, double ms){
+        scope.minMs = scope.count ? std::min(scope.minMs, ms) : ms;
+        scope.maxMs = scope.count ? std::max(scope.maxMs, ms) : ms;
+        scope.totalMs += ms;
+        scope.count++;
+    }
+
+    FrameQueries frames[FRAMES_IN_FLIGHT];
+    unsigned int frameIndex = 0;
+    bool measuring = false;
+    int frameScope = -1;
+    unsigned int depth = 0;
+    unsigned int skippedFrames = 0;
+
+    std::vector<ScopeStats> scopes;
+    std::unordered_map<std::string, unsigned int> scopeIndices;
+    std::vector<GLuint> freeQueries;
+    std::vector<double> frameTotals;
+};
+
+// profiler used by GPU_SCOPE
+inline GpuProfiler &gpuProfiler(){
+    static GpuProfiler instance;
+    return instance;
+}
+
+// measures the GPU time of the commands issued until the end of the enclosing block
+class GpuScope {
+public:
+    GpuScope(GpuProfiler &profiler, const char* name) : profiler(profiler), record(profiler.begin(name)) {}
+    ~GpuScope() { profiler.end(record); }
+    GpuScope(const GpuScope &) = delete;
+    GpuScope &operator=(const GpuScope &) = delete;
+private:
+    GpuProfiler &profiler;
+    int record;
+};
+
+#define GPU_SCOPE_CONCAT_IMPL(a, b) a##b
+#define GPU_SCOPE_CONCAT(a, b) GPU_SCOPE_CONCAT_IMPL(a, b)
+#define GPU_SCOPE(name) GpuScope GPU_SCOPE_CONCAT(gpuScope, __LINE__)(gpuProfiler(), name)
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_GPU_PROFILER_H
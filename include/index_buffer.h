@@ -0,0 +1,68 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_INDEX_BUFFER_H
+#define GRAPHICSPROGRAMMINGEXERCISES_INDEX_BUFFER_H
+
+#include <glad/glad.h>
+
+#include <vector>
+#include <cstring>
+#include <cstdint>
+
+// index narrowing: meshes are built with unsigned int indices, but most of them address less than 65536
+// (or 256) vertices, so their index buffers can be stored with GL_UNSIGNED_SHORT (or GL_UNSIGNED_BYTE),
+// halving (or quartering) the index memory and the bandwidth used by the vertex fetch
+// ------------------------------------------------------------------------------------------------------
+
+// narrowest index type that can address vertexCount vertices; some GPUs convert byte indices
+// in the driver, allowBytes = false limits the choice to GL_UNSIGNED_SHORT and GL_UNSIGNED_INT
+inline GLenum chooseIndexType(unsigned int vertexCount, bool allowBytes = true){
+    if (allowBytes && vertexCount <= 0x100)
+        return GL_UNSIGNED_BYTE;
+    if (vertexCount <= 0x10000)
+        return GL_UNSIGNED_SHORT;
+    return GL_UNSIGNED_INT;
+}
+
+inline unsigned int indexTypeSize(GLenum type){
+    return type == GL_UNSIGNED_BYTE ? 1 : (type == GL_UNSIGNED_SHORT ? 2 : 4);
+}
+
+// narrowest index type for the given indices, from the largest one
+inline GLenum chooseIndexType(const unsigned int* indices, unsigned int count, bool allowBytes = true){
+    unsigned int maxIndex = 0;
+    for (unsigned int i = 0; i < count; i++)
+        maxIndex = indices[i] > maxIndex ? indices[i] : maxIndex;
+    return chooseIndexType(maxIndex + 1, allowBytes);
+}
+
+// writes the indices to out with the given type, out must hold count * indexTypeSize(type) bytes
+inline void packIndices(const unsigned int* indices, unsigned int count, GLenum type, void* out){
+    if (type == GL_UNSIGNED_BYTE){
+        uint8_t* bytes = (uint8_t*) out;
+        for (unsigned int i = 0; i < count; i++)
+            bytes[i] = (uint8_t) indices[i];
+    }
+    else if (type == GL_UNSIGNED_SHORT){
+        uint16_t* shorts = (uint16_t*) out;
+        for (unsigned int i = 0; i < count; i++)
+            shorts[i] = (uint16_t) indices[i];
+    }
+    else
+        std::memcpy(out, indices, count * sizeof(uint32_t));
+}
+
+inline std::vector<unsigned char> packIndices(const unsigned int* indices, unsigned int count, GLenum type){
+    std::vector<unsigned char> packed(count * indexTypeSize(type));
+    packIndices(indices, count, type, packed.data());
+    return packed;
+}
+
+// reads back index i of a packed index buffer
+inline unsigned int unpackIndex(const void* data, GLenum type, unsigned int i){
+    if (type == GL_UNSIGNED_BYTE)
+        return ((const uint8_t*) data)[i];
+    if (type == GL_UNSIGNED_SHORT)
+        return ((const uint16_t*) data)[i];
+    return ((const uint32_t*) data)[i];
+}
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_INDEX_BUFFER_H
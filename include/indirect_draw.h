@@ -0,0 +1,179 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_INDIRECT_DRAW_H
+#define GRAPHICSPROGRAMMINGEXERCISES_INDIRECT_DRAW_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstring>
+#include <iostream>
+
+#include "mesh_buffer.h"
+#include "gl_call_counter.h"
+
+// GL 4.3 names, the loader is generated for 3.3 core so we declare what we need ourselves
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+#ifndef APIENTRYP
+#define APIENTRYP *
+#endif
+typedef void (APIENTRYP MultiDrawElementsIndirectProc)(GLenum mode, GLenum type, const void *indirect, GLsizei drawCount, GLsizei stride);
+
+
+// layout defined by the GL specification for indirect indexed draws
+// -----------------------------------------------------------------
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+
+// draws many meshes of a SharedMeshBuffer, each with its own model matrix, with a constant number of GL calls:
+// the commands and the per instance matrices are filled on the CPU (e.g. from the output of the frustum culler),
+// uploaded in two buffer updates and drawn with glMultiDrawElementsIndirect when the context supports it;
+// on a plain 3.3 core context it falls back to one glDrawElementsInstancedBaseVertex per command
+// the matrices are read by the vertex shader as a per instance mat4 attribute named "instanceModel"
+// -------------------------------------------------------------------------------------------------------
+class IndirectDrawBatch {
+public:
+    struct Stats {
+        unsigned int commands = 0;      // draw commands in the batch
+        unsigned int instances = 0;     // meshes drawn
+        unsigned int drawCalls = 0;     // GL draw calls used to draw them
+    };
+
+    // call once the mesh buffer is uploaded, loadProc is used to look up the GL 4.3 entry point
+    void init(const SharedMeshBuffer &meshBuffer, unsigned int program, GLADloadproc loadProc){
+        meshes = &meshBuffer;
+        multiDrawElementsIndirect = nullptr;
+        if (supportsMultiDrawIndirect())
+            multiDrawElementsIndirect = (MultiDrawElementsIndirectProc) loadProc("glMultiDrawElementsIndirect");
+
+        glGenBuffers(1, &instanceVBO);
+        glGenBuffers(1, &commandBuffer);
+
+        // per instance model matrix, a mat4 attribute takes 4 consecutive locations
+        glBindVertexArray(meshBuffer.VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        modelAttributeLocation = glGetAttribLocation(program, "instanceModel");
+        for (int column = 0; column < 4; column++){
+            glEnableVertexAttribArray(modelAttributeLocation + column);
+            glVertexAttribDivisor(modelAttributeLocation + column, 1);
+        }
+        setInstanceOffset(0);
+        glBindVertexArray(0);
+    }
+
+    bool usesMultiDrawIndirect() const { return multiDrawElementsIndirect != nullptr; }
+
+    void clear(){
+        commands.clear();
+        instanceModels.clear();
+    }
+
+    // consecutive instances of the same mesh range are merged in a single instanced command; two
+    // ranges can start at the same index with different counts, so the count is compared too
+    void add(const MeshRange &mesh, const glm::mat4 &model){
+        unsigned int instance = (unsigned int) instanceModels.size();
+        instanceModels.push_back(model);
+        if (!commands.empty()){
+            DrawElementsIndirectCommand &last = commands.back();
+            if (last.firstIndex == mesh.firstIndex && last.count == mesh.indexCount && last.baseVertex == mesh.baseVertex &&
+                last.baseInstance + last.instanceCount == instance){
+                last.instanceCount++;
+                return;
+            }
+        }
+        commands.push_back(DrawElementsIndirectCommand{mesh.indexCount, 1, mesh.firstIndex, mesh.baseVertex, instance});
+    }
+
+    void submit(){
+        stats = Stats();
+        if (commands.empty())
+            return;
+        stats.commands = (unsigned int) commands.size();
+        stats.instances = (unsigned int) instanceModels.size();
+
+        glBindVertexArray(meshes->VAO);
+
+        // orphan the previous storage so that we do not wait for the draws of the last frame
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glBufferData(GL_ARRAY_BUFFER, instanceModels.size() * sizeof(glm::mat4), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, instanceModels.size() * sizeof(glm::mat4), instanceModels.data());
+
+        if (multiDrawElementsIndirect){
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+            glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), nullptr, GL_STREAM_DRAW);
+            glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data());
+            multiDrawElementsIndirect(GL_TRIANGLES, meshes->indexType(), 0, (GLsizei) commands.size(), 0);
+            // loaded here rather than by glad, so the counter has no hook for it
+            if (glCallCounter().countCall(GLFunction::MultiDrawElementsIndirect))
+                for (const DrawElementsIndirectCommand &command : commands)
+                    glCallCounter().countDraw(GL_TRIANGLES, command.count, command.instanceCount);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+            stats.drawCalls = 1;
+        }
+        else {
+            // 3.3 has no base instance, so the instance attribute is re-pointed for every command
+            for (const DrawElementsIndirectCommand &command : commands){
+                setInstanceOffset(command.baseInstance);
+                glDrawElementsInstancedBaseVertex(GL_TRIANGLES, command.count, meshes->indexType(),
+                                                  (void*) (size_t) (command.firstIndex * meshes->indexSize()),
+                                                  command.instanceCount, command.baseVertex);
+            }
+            stats.drawCalls = (unsigned int) commands.size();
+        }
+    }
+
+    const Stats &getStats() const { return stats; }
+
+    void printStats(std::ostream &out) const{
+        out << "indirect draw: " << stats.instances << " instances in " << stats.commands << " commands, "
+            << stats.drawCalls << (usesMultiDrawIndirect() ? " multi draw indirect call" : " draw calls (3.3 fallback)")
+            << std::endl;
+    }
+
+    // true for GL 4.3 contexts, or older ones exposing both ARB_multi_draw_indirect and ARB_base_instance
+    static bool supportsMultiDrawIndirect(){
+        GLint major = 0, minor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+        int version = major * 10 + minor;
+        if (version >= 43)
+            return true;
+        return hasExtension("GL_ARB_multi_draw_indirect") && (version >= 42 || hasExtension("GL_ARB_base_instance"));
+    }
+
+    static bool hasExtension(const char *name){
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++){
+            const char *extension = (const char*) glGetStringi(GL_EXTENSIONS, i);
+            if (extension && std::strcmp(extension, name) == 0)
+                return true;
+        }
+        return false;
+    }
+
+private:
+    void setInstanceOffset(unsigned int baseInstance){
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        for (int column = 0; column < 4; column++)
+            glVertexAttribPointer(modelAttributeLocation + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+                                  (void*) (baseInstance * sizeof(glm::mat4) + column * sizeof(glm::vec4)));
+    }
+
+    const SharedMeshBuffer *meshes = nullptr;
+    MultiDrawElementsIndirectProc multiDrawElementsIndirect = nullptr;
+    unsigned int instanceVBO = 0, commandBuffer = 0;
+    int modelAttributeLocation = -1;
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<glm::mat4> instanceModels;
+    Stats stats;
+};
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_INDIRECT_DRAW_H
@@ -0,0 +1,331 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_INPUT_REPLAY_H
+#define GRAPHICSPROGRAMMINGEXERCISES_INPUT_REPLAY_H
+
+#include <GLFW/glfw3.h>
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+// records the GLFW input of a run and plays it back, so that interactive scenes can be rerun with the same input
+// (e.g. headless, for benchmarks). The exercises read the input through inputReplay() instead of GLFW:
+//
+//     inputReplay().setMouseButtonCallback(button_input_callback);    // instead of glfwSetMouseButtonCallback
+//     if (inputReplay().getKey(GLFW_KEY_A) == GLFW_PRESS) ...          // instead of glfwGetKey
+//
+// without a recording or a replay these forward to GLFW. When recording, the key, mouse button, cursor and scroll
+// events are stored with the index of the frame whose glfwPollEvents delivered them. When replaying, the events of
+// a frame are applied at the end of that frame, where glfwPollEvents would have delivered them: the polled state
+// is updated and the callbacks are called, with a null window for headless runs. The render context replays at a
+// fixed time step, the average frame time of the recording, so the frames match the recording one to one.
+//
+// recording file (text), one event per line after the header:
+//   input 1 <window width> <window height>
+//   <frame> <seconds> key <key> <scancode> <action> <mods>
+//   <frame> <seconds> button <button> <action> <mods>
+//   <frame> <seconds> cursor <x> <y>
+//   <frame> <seconds> scroll <x offset> <y offset>
+//   end <frames> <seconds>
+// events of frame -1 are the state when the recording started (the cursor position)
+// ---------------------------------------------------------------------------------------------------------------
+
+enum class InputMode { LIVE, RECORD, REPLAY };
+
+class InputReplay {
+public:
+    InputReplay() = default;
+    InputReplay(const InputReplay &) = delete;
+    InputReplay &operator=(const InputReplay &) = delete;
+
+    InputMode getMode() const { return mode; }
+    bool isReplaying() const { return mode == InputMode::REPLAY; }
+
+    // window polled in live mode, and passed to the callbacks
+    void setWindow(GLFWwindow* glfwWindow) { window = glfwWindow; }
+
+    // installs the recording callbacks on the window, the file is written by finish()
+    void startRecording(GLFWwindow* glfwWindow, const std::string &path){
+        window = glfwWindow;
+        mode = InputMode::RECORD;
+        filePath = path;
+        events.clear();
+        frame = 0;
+        startTime = glfwGetTime();
+        glfwGetWindowSize(window, &windowWidth, &windowHeight);
+        Event initial = makeEvent(EventType::CURSOR);
+        initial.frame = -1;
+        glfwGetCursorPos(window, &initial.x, &initial.y);
+        events.push_back(initial);
+        glfwSetKeyCallback(window, recordKey);
+        glfwSetMouseButtonCallback(window, recordMouseButton);
+        glfwSetCursorPosCallback(window, recordCursorPos);
+        glfwSetScrollCallback(window, recordScroll);
+    }
+
+    bool startReplay(const std::string &path){
+        FILE* file = std::fopen(path.c_str(), "r");
+        if (!file){
+            std::cout << "ERROR::INPUT_REPLAY::CANNOT_READ " << path << std::endl;
+            return false;
+        }
+        events.clear();
+        bool ok = readRecording(file);
+        std::fclose(file);
+        if (!ok){
+            std::cout << "ERROR::INPUT_REPLAY::INVALID_RECORDING " << path << std::endl;
+            return false;
+        }
+        mode = InputMode::REPLAY;
+        frame = 0;
+        next = 0;
+        // the state when the recording started
+        while (next < events.size() && events[next].frame < 0)
+            applyEvent(events[next++], false);
+        return true;
+    }
+
+    // frames and average frame time of the replayed recording
+    unsigned int recordedFrames() const { return recordingFrames; }
+    float recordedTimeStep() const { return recordingFrames ? (float) (recordingSeconds / recordingFrames) : 0.0f; }
+
+    // called after the events of the frame were polled: replays the events of the frame, or counts the frame
+    void endFrame(){
+        if (mode == InputMode::REPLAY)
+            while (next < events.size() && events[next].frame <= frame)
+                applyEvent(events[next++], true);
+        frame++;
+    }
+
+    // writes the recording, nothing to do in the other modes
+    bool finish(){
+        if (mode != InputMode::RECORD)
+            return true;
+        mode = InputMode::LIVE;
+        FILE* file = std::fopen(filePath.c_str(), "w");
+        if (!file){
+            std::cout << "ERROR::INPUT_REPLAY::CANNOT_WRITE " << filePath << std::endl;
+            return false;
+        }
+        std::fprintf(file, "input 1 %d %d\n", windowWidth, windowHeight);
+        for (const Event &event : events){
+            std::fprintf(file, "%d %.4f ", event.frame, event.time);
+            switch (event.type){
+                case EventType::KEY: std::fprintf(file, "key %d %d %d %d\n", event.code, event.scancode, event.action, event.mods); break;
+                case EventType::BUTTON: std::fprintf(file, "button %d %d %d\n", event.code, event.action, event.mods); break;
+                case EventType::CURSOR: std::fprintf(file, "cursor %.2f %.2f\n", event.x, event.y); break;
+                case EventType::SCROLL: std::fprintf(file, "scroll %.3f %.3f\n", event.x, event.y); break;
+            }
+        }
+        std::fprintf(file, "end %d %.4f\n", frame, glfwGetTime() - startTime);
+        std::fclose(file);
+        std::cout << "recorded " << events.size() << " input events in " << frame << " frames to " << filePath << std::endl;
+        return true;
+    }
+
+    // polling, same results as the GLFW functions of the same name
+    int getKey(int key) const{
+        if (mode != InputMode::REPLAY)
+            return window ? glfwGetKey(window, key) : GLFW_RELEASE;
+        return key >= 0 && key <= GLFW_KEY_LAST && keys[key] ? GLFW_PRESS : GLFW_RELEASE;
+    }
+
+    int getMouseButton(int button) const{
+        if (mode != InputMode::REPLAY)
+            return window ? glfwGetMouseButton(window, button) : GLFW_RELEASE;
+        return button >= 0 && button <= GLFW_MOUSE_BUTTON_LAST && buttons[button] ? GLFW_PRESS : GLFW_RELEASE;
+    }
+
+    void getCursorPos(double* x, double* y) const{
+        if (mode != InputMode::REPLAY && window){
+            glfwGetCursorPos(window, x, y);
+            return;
+        }
+        *x = cursorX;
+        *y = cursorY;
+    }
+
+    // the window size of the recording when replaying, so that cursor positions convert to the same coordinates
+    void getWindowSize(int* width, int* height) const{
+        if (mode != InputMode::REPLAY && window){
+            glfwGetWindowSize(window, width, height);
+            return;
+        }
+        *width = windowWidth;
+        *height = windowHeight;
+    }
+
+    // callbacks, replayed events call them as well
+    void setKeyCallback(GLFWkeyfun callback){
+        keyCallback = callback;
+        if (mode == InputMode::LIVE && window)
+            glfwSetKeyCallback(window, callback);
+    }
+
+    void setMouseButtonCallback(GLFWmousebuttonfun callback){
+        mouseButtonCallback = callback;
+        if (mode == InputMode::LIVE && window)
+            glfwSetMouseButtonCallback(window, callback);
+    }
+
+    void setCursorPosCallback(GLFWcursorposfun callback){
+        cursorPosCallback = callback;
+        if (mode == InputMode::LIVE && window)
+            glfwSetCursorPosCallback(window, callback);
+    }
+
+    void setScrollCallback(GLFWscrollfun callback){
+        scrollCallback = callback;
+        if (mode == InputMode::LIVE && window)
+            glfwSetScrollCallback(window, callback);
+    }
+
+private:
+    enum class EventType { KEY, BUTTON, CURSOR, SCROLL };
+
+    struct Event {
+        int frame;
+        double time;
+        EventType type;
+        int code, scancode, action, mods;     // key or button
+        double x, y;                          // cursor position or scroll offset
+    };
+
+    Event makeEvent(EventType type) const{
+        Event event{frame, glfwGetTime() - startTime, type, 0, 0, 0, 0, 0.0, 0.0};
+        return event;
+    }
+
+    void applyEvent(const Event &event, bool callCallbacks){
+        switch (event.type){
+            case EventType::KEY:
+                if (event.code >= 0 && event.code <= GLFW_KEY_LAST)
+                    keys[event.code] = event.action != GLFW_RELEASE;
+                if (callCallbacks && keyCallback)
+                    keyCallback(window, event.code, event.scancode, event.action, event.mods);
+                break;
+            case EventType::BUTTON:
+                if (event.code >= 0 && event.code <= GLFW_MOUSE_BUTTON_LAST)
+                    buttons[event.code] = event.action != GLFW_RELEASE;
+                if (callCallbacks && mouseButtonCallback)
+                    mouseButtonCallback(window, event.code, event.action, event.mods);
+                break;
+            case EventType::CURSOR:
+                cursorX = event.x;
+                cursorY = event.y;
+                if (callCallbacks && cursorPosCallback)
+                    cursorPosCallback(window, event.x, event.y);
+                break;
+            case EventType::SCROLL:
+                if (callCallbacks && scrollCallback)
+                    scrollCallback(window, event.x, event.y);
+                break;
+        }
+    }
+
+    bool readRecording(FILE* file){
+        int version = 0;
+        if (std::fscanf(file, " input %d %d %d", &version, &windowWidth, &windowHeight) != 3 || version != 1)
+            return false;
+        char type[16];
+        while (true){
+            Event event{0, 0.0, EventType::KEY, 0, 0, 0, 0, 0.0, 0.0};
+            if (std::fscanf(file, " end %u %lf", &recordingFrames, &recordingSeconds) == 2)
+                return true;
+            if (std::fscanf(file, " %d %lf %15s", &event.frame, &event.time, type) != 3)
+                return false;
+            int read = 0, expected = 0;
+            if (std::strcmp(type, "key") == 0){
+                event.type = EventType::KEY;
+                read = std::fscanf(file, "%d %d %d %d", &event.code, &event.scancode, &event.action, &event.mods);
+                expected = 4;
+            }
+            else if (std::strcmp(type, "button") == 0){
+                event.type = EventType::BUTTON;
+                read = std::fscanf(file, "%d %d %d", &event.code, &event.action, &event.mods);
+                expected = 3;
+            }
+            else if (std::strcmp(type, "cursor") == 0 || std::strcmp(type, "scroll") == 0){
+                event.type = type[0] == 'c' ? EventType::CURSOR : EventType::SCROLL;
+                read = std::fscanf(file, "%lf %lf", &event.x, &event.y);
+                expected = 2;
+            }
+            if (read != expected)
+                return false;
+            events.push_back(event);
+        }
+    }
+
+    // GLFW callbacks of the recording, the events are stored and passed on to the callbacks of the exercise
+    static InputReplay &self();
+
+    static void recordKey(GLFWwindow* window, int key, int scancode, int action, int mods){
+        InputReplay &input = self();
+        Event event = input.makeEvent(EventType::KEY);
+        event.code = key; event.scancode = scancode; event.action = action; event.mods = mods;
+        input.events.push_back(event);
+        if (input.keyCallback)
+            input.keyCallback(window, key, scancode, action, mods);
+    }
+
+    static void recordMouseButton(GLFWwindow* window, int button, int action, int mods){
+        InputReplay &input = self();
+        Event event = input.makeEvent(EventType::BUTTON);
+        event.code = button; event.action = action; event.mods = mods;
+        input.events.push_back(event);
+        if (input.mouseButtonCallback)
+            input.mouseButtonCallback(window, button, action, mods);
+    }
+
+    static void recordCursorPos(GLFWwindow* window, double x, double y){
+        InputReplay &input = self();
+        Event event = input.makeEvent(EventType::CURSOR);
+        event.x = x; event.y = y;
+        input.events.push_back(event);
+        if (input.cursorPosCallback)
+            input.cursorPosCallback(window, x, y);
+    }
+
+    static void recordScroll(GLFWwindow* window, double x, double y){
+        InputReplay &input = self();
+        Event event = input.makeEvent(EventType::SCROLL);
+        event.x = x; event.y = y;
+        input.events.push_back(event);
+        if (input.scrollCallback)
+            input.scrollCallback(window, x, y);
+    }
+
+    InputMode mode = InputMode::LIVE;
+    GLFWwindow* window = nullptr;
+    GLFWkeyfun keyCallback = nullptr;
+    GLFWmousebuttonfun mouseButtonCallback = nullptr;
+    GLFWcursorposfun cursorPosCallback = nullptr;
+    GLFWscrollfun scrollCallback = nullptr;
+
+    std::string filePath;
+    std::vector<Event> events;
+    int frame = 0;
+    size_t next = 0;                // next event to replay
+    double startTime = 0;
+    int windowWidth = 0, windowHeight = 0;
+    unsigned int recordingFrames = 0;
+    double recordingSeconds = 0;
+
+    // replayed state
+    bool keys[GLFW_KEY_LAST + 1] = {};
+    bool buttons[GLFW_MOUSE_BUTTON_LAST + 1] = {};
+    double cursorX = 0, cursorY = 0;
+};
+
+// input of the exercises, see above
+inline InputReplay &inputReplay(){
+    static InputReplay instance;
+    return instance;
+}
+
+inline InputReplay &InputReplay::self(){
+    return inputReplay();
+}
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_INPUT_REPLAY_H
@@ -0,0 +1,53 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_LOD_SELECTION_H
+#define GRAPHICSPROGRAMMINGEXERCISES_LOD_SELECTION_H
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <algorithm>
+
+#include "bounds.h"
+#include "mesh_processing.h"
+
+// runtime level of detail selection: the level of an instance is chosen from the size of its bounds on screen,
+// with a band around every threshold in which the current level is kept, so that an object moving back and
+// forth around a threshold does not keep popping between two levels
+// ------------------------------------------------------------------------------------------------------------
+
+// diameter in pixels of a world space sphere, for a viewProjection made of a rigid view and a perspective
+// (or orthographic) projection: the length of the second row of the matrix is the y scale of the projection
+inline float projectedSphereSize(const BoundingSphere &sphere, const glm::mat4 &viewProjection, float viewportHeight){
+    glm::vec4 clipCenter = viewProjection * glm::vec4(sphere.center, 1.0f);
+    float yScale = glm::length(glm::vec3(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1]));
+    // the camera is inside of the sphere, use the full detail
+    if (clipCenter.w <= sphere.radius)
+        return viewportHeight;
+    return sphere.radius * yScale / clipCenter.w * viewportHeight;
+}
+
+inline BoundingSphere aabbSphere(const AABB &box){
+    BoundingSphere sphere;
+    sphere.center = box.center();
+    sphere.radius = glm::length(box.extents());
+    return sphere;
+}
+
+
+struct LodSelector {
+    // screen size in pixels under which level i + 1 is used instead of level i
+    float thresholds[MAX_MESH_LODS - 1] = {150.0f, 70.0f, 30.0f};
+    // relative width of the band around each threshold in which the level does not change
+    float hysteresis = .15f;
+
+    // returns the level to use for an object of screenSize pixels that used currentLod in the last frame
+    int select(int currentLod, float screenSize, int lodCount) const{
+        int lod = std::max(0, std::min(currentLod, lodCount - 1));
+        while (lod < lodCount - 1 && screenSize < thresholds[lod] * (1.0f - hysteresis))
+            lod++;
+        while (lod > 0 && screenSize > thresholds[lod - 1] * (1.0f + hysteresis))
+            lod--;
+        return lod;
+    }
+};
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_LOD_SELECTION_H
@@ -0,0 +1,108 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_MESH_BUFFER_H
+#define GRAPHICSPROGRAMMINGEXERCISES_MESH_BUFFER_H
+
+#include <glad/glad.h>
+
+#include <vector>
+
+#include "index_buffer.h"
+
+// location of a mesh inside a SharedMeshBuffer, in the terms used by glDrawElementsBaseVertex
+// ------------------------------------------------------------------------------------------
+struct MeshRange {
+    unsigned int firstIndex = 0;    // offset in the index buffer, in indices
+    unsigned int indexCount = 0;
+    int baseVertex = 0;             // added to every index of the mesh
+};
+
+
+// many meshes stored in a single VAO, with one position, one color and one index buffer;
+// meshes are added to a CPU staging area and uploaded together, so that they can be drawn
+// without switching VAO, and all of them with a single indirect draw call;
+// the index buffer uses the narrowest type that fits the largest (mesh relative) index
+// ---------------------------------------------------------------------------------------
+class SharedMeshBuffer {
+public:
+    unsigned int VAO = 0;
+    unsigned int positionVBO = 0, colorVBO = 0, EBO = 0;
+
+    // positions are x,y,z and colors r,g,b,a per vertex, indices are relative to the mesh
+    MeshRange addMesh(const float* positions, const float* colors, unsigned int vertexCount,
+                      const unsigned int* indices, unsigned int indexCount){
+        MeshRange range;
+        range.firstIndex = (unsigned int) stagingIndices.size();
+        range.indexCount = indexCount;
+        range.baseVertex = (int) (stagingPositions.size() / 3);
+        stagingPositions.insert(stagingPositions.end(), positions, positions + vertexCount * 3);
+        stagingColors.insert(stagingColors.end(), colors, colors + vertexCount * 4);
+        stagingIndices.insert(stagingIndices.end(), indices, indices + indexCount);
+        return range;
+    }
+
+    // same, with indices packed as GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    MeshRange addMesh(const float* positions, const float* colors, unsigned int vertexCount,
+                      const void* indices, GLenum indexType, unsigned int indexCount){
+        std::vector<unsigned int> unpacked(indexCount);
+        for (unsigned int i = 0; i < indexCount; i++)
+            unpacked[i] = unpackIndex(indices, indexType, i);
+        return addMesh(positions, colors, vertexCount, unpacked.data(), indexCount);
+    }
+
+    MeshRange addMesh(const std::vector<float> &positions, const std::vector<float> &colors, const std::vector<unsigned int> &indices){
+        return addMesh(positions.data(), colors.data(), (unsigned int) (positions.size() / 3),
+                       indices.data(), (unsigned int) indices.size());
+    }
+
+    // creates the GL buffers from the staged meshes and frees the staging memory,
+    // program is used to find the "pos" and "color" attribute locations
+    void upload(unsigned int program){
+        glGenVertexArrays(1, &VAO);
+        glBindVertexArray(VAO);
+
+        glGenBuffers(1, &positionVBO);
+        glBindBuffer(GL_ARRAY_BUFFER, positionVBO);
+        glBufferData(GL_ARRAY_BUFFER, stagingPositions.size() * sizeof(GLfloat), stagingPositions.data(), GL_STATIC_DRAW);
+        int posAttributeLocation = glGetAttribLocation(program, "pos");
+        glEnableVertexAttribArray(posAttributeLocation);
+        glVertexAttribPointer(posAttributeLocation, 3, GL_FLOAT, GL_FALSE, 0, 0);
+
+        glGenBuffers(1, &colorVBO);
+        glBindBuffer(GL_ARRAY_BUFFER, colorVBO);
+        glBufferData(GL_ARRAY_BUFFER, stagingColors.size() * sizeof(GLfloat), stagingColors.data(), GL_STATIC_DRAW);
+        int colorAttributeLocation = glGetAttribLocation(program, "color");
+        glEnableVertexAttribArray(colorAttributeLocation);
+        glVertexAttribPointer(colorAttributeLocation, 4, GL_FLOAT, GL_FALSE, 0, 0);
+
+        std::vector<unsigned char> packedIndices;
+        elementType = packStagedIndices(packedIndices);
+        glGenBuffers(1, &EBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, packedIndices.size(), packedIndices.data(), GL_STATIC_DRAW);
+
+        glBindVertexArray(0);
+
+        std::vector<float>().swap(stagingPositions);
+        std::vector<float>().swap(stagingColors);
+        std::vector<unsigned int>().swap(stagingIndices);
+    }
+
+    // the staged indices as upload() stores them, returns their type; base vertices are applied by the draw
+    // calls, so only the largest mesh matters for the index type
+    GLenum packStagedIndices(std::vector<unsigned char> &packed) const{
+        GLenum type = chooseIndexType(stagingIndices.data(), (unsigned int) stagingIndices.size());
+        packed = packIndices(stagingIndices.data(), (unsigned int) stagingIndices.size(), type);
+        return type;
+    }
+
+    // valid after upload()
+    GLenum indexType() const { return elementType; }
+    unsigned int indexSize() const { return indexTypeSize(elementType); }
+
+private:
+    GLenum elementType = GL_UNSIGNED_INT;
+    std::vector<float> stagingPositions;
+    std::vector<float> stagingColors;
+    std::vector<unsigned int> stagingIndices;
+};
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_MESH_BUFFER_H
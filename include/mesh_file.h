@@ -0,0 +1,361 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_MESH_FILE_H
+#define GRAPHICSPROGRAMMINGEXERCISES_MESH_FILE_H
+
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "bounds.h"
+#include "index_buffer.h"
+#include "mesh_processing.h"
+
+// binary mesh container:
+// | MeshFileHeader | positions | colors | indices |
+// every blob starts at a multiple of MESH_FILE_ALIGNMENT, so the data can be used in place once the file is mapped
+// positions are either 3 floats, or 4 normalized unsigned shorts (the 4th is padding) to be decoded as
+// bias + scale * value; colors are either 4 floats or 4 normalized unsigned bytes
+// indices are stored with the narrowest type that can address every vertex, see index_buffer.h, and hold
+// the levels of detail one after the other, as described by the lod table of the header
+// ----------------------------------------------------------------------------------------------------------------
+const char MESH_FILE_MAGIC[4] = {'G', 'P', 'M', 'S'};
+const uint32_t MESH_FILE_VERSION = 4;
+const uint32_t MESH_FILE_ALIGNMENT = 16;
+
+enum MeshAttributeFormat : uint32_t {
+    MESH_FORMAT_FLOAT32 = 0,
+    MESH_FORMAT_UNORM16 = 1,    // positions only
+    MESH_FORMAT_UNORM8 = 2      // colors only
+};
+
+struct MeshFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t positionOffset;    // byte offsets from the start of the file
+    uint32_t colorOffset;
+    uint32_t indexOffset;
+    uint32_t flags;             // no flags are defined, files with any set are rejected
+    uint32_t positionFormat;    // MeshAttributeFormat
+    uint32_t colorFormat;
+    uint32_t indexSize;         // 1, 2 or 4 bytes per index
+    float positionScale[3], positionBias[3];    // decoding of quantized positions
+    float boundsMin[3], boundsMax[3];
+    float sphereCenter[3], sphereRadius;
+    uint32_t lodCount;
+    uint32_t lodFirstIndex[MAX_MESH_LODS], lodIndexCount[MAX_MESH_LODS];
+    float lodError[MAX_MESH_LODS];
+};
+
+
+inline uint32_t meshPositionStride(uint32_t format){
+    return format == MESH_FORMAT_UNORM16 ? 4 * sizeof(uint16_t) : 3 * sizeof(float);
+}
+
+inline uint32_t meshColorStride(uint32_t format){
+    return format == MESH_FORMAT_UNORM8 ? 4 * sizeof(uint8_t) : 4 * sizeof(float);
+}
+
+// quantizes a value in [0,1] to an unsigned normalized integer with the given maximum
+inline uint32_t quantizeUnorm(float value, uint32_t maxValue){
+    value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+    return (uint32_t) (value * (float) maxValue + .5f);
+}
+
+
+inline uint32_t alignMeshOffset(uint32_t offset){
+    return (offset + MESH_FILE_ALIGNMENT - 1) / MESH_FILE_ALIGNMENT * MESH_FILE_ALIGNMENT;
+}
+
+// replaces path with the file at temporaryPath in one step, a process that mapped the old file keeps its pages
+inline bool replaceFile(const std::string &temporaryPath, const std::string &path){
+#ifdef _WIN32
+    return MoveFileExA(temporaryPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+#endif
+}
+
+inline std::string temporaryFilePath(const std::string &path){
+#ifdef _WIN32
+    return path + ".tmp" + std::to_string(GetCurrentProcessId());
+#else
+    return path + ".tmp" + std::to_string(getpid());
+#endif
+}
+
+// writes a mesh file, positions are x,y,z and colors r,g,b,a per vertex; returns false if the file can't be written
+// with quantize set, positions are stored as 16 bit values relative to the mesh bounds and colors as 8 bit values;
+// lods describes the levels of detail in indices, when empty all the indices make a single level; the file is
+// written next to path and renamed, so the file at path is never seen half written or truncated while mapped
+inline bool writeMeshFile(const std::string &path, const std::vector<float> &positions, const std::vector<float> &colors,
+                          const std::vector<unsigned int> &indices, bool quantize = false,
+                          const std::vector<MeshLod> &lods = std::vector<MeshLod>()){
+    uint32_t vertexCount = (uint32_t) (positions.size() / 3);
+    MeshFileHeader header = {};
+    std::memcpy(header.magic, MESH_FILE_MAGIC, 4);
+    header.version = MESH_FILE_VERSION;
+    header.vertexCount = vertexCount;
+    header.indexCount = (uint32_t) indices.size();
+    header.flags = 0;
+    header.positionFormat = quantize ? MESH_FORMAT_UNORM16 : MESH_FORMAT_FLOAT32;
+    header.colorFormat = quantize ? MESH_FORMAT_UNORM8 : MESH_FORMAT_FLOAT32;
+    header.positionOffset = alignMeshOffset(sizeof(MeshFileHeader));
+    header.colorOffset = alignMeshOffset(header.positionOffset + vertexCount * meshPositionStride(header.positionFormat));
+    header.indexOffset = alignMeshOffset(header.colorOffset + vertexCount * meshColorStride(header.colorFormat));
+    GLenum indexType = chooseIndexType(vertexCount);
+    header.indexSize = indexTypeSize(indexType);
+
+    AABB box = computeAABB(positions);
+    BoundingSphere sphere = computeBoundingSphere(positions);
+    for (int i = 0; i < 3; i++){
+        header.boundsMin[i] = box.min[i];
+        header.boundsMax[i] = box.max[i];
+        header.sphereCenter[i] = sphere.center[i];
+        header.positionBias[i] = quantize ? box.min[i] : 0.0f;
+        header.positionScale[i] = quantize ? box.max[i] - box.min[i] : 1.0f;
+    }
+    header.sphereRadius = sphere.radius;
+    header.lodCount = lods.empty() ? 1 : (uint32_t) std::min<size_t>(lods.size(), MAX_MESH_LODS);
+    header.lodIndexCount[0] = (uint32_t) indices.size();
+    for (uint32_t i = 0; i < header.lodCount && !lods.empty(); i++){
+        header.lodFirstIndex[i] = lods[i].firstIndex;
+        header.lodIndexCount[i] = lods[i].indexCount;
+        header.lodError[i] = lods[i].error;
+    }
+
+    std::vector<char> data(header.indexOffset + indices.size() * header.indexSize, 0);
+    std::memcpy(&data[0], &header, sizeof(header));
+    if (quantize){
+        for (uint32_t v = 0; v < vertexCount; v++){
+            uint16_t position[4] = {0, 0, 0, 0};
+            for (int i = 0; i < 3; i++){
+                float range = header.positionScale[i] > 0.0f ? header.positionScale[i] : 1.0f;
+                position[i] = (uint16_t) quantizeUnorm((positions[v * 3 + i] - header.positionBias[i]) / range, 0xFFFF);
+            }
+            uint8_t color[4];
+            for (int i = 0; i < 4; i++)
+                color[i] = (uint8_t) quantizeUnorm(v * 4 + i < colors.size() ? colors[v * 4 + i] : 1.0f, 0xFF);
+            std::memcpy(&data[header.positionOffset + v * sizeof(position)], position, sizeof(position));
+            std::memcpy(&data[header.colorOffset + v * sizeof(color)], color, sizeof(color));
+        }
+    }
+    else {
+        std::memcpy(&data[header.positionOffset], positions.data(), positions.size() * sizeof(float));
+        std::memcpy(&data[header.colorOffset], colors.data(), colors.size() * sizeof(float));
+    }
+    if (!indices.empty())
+        packIndices(indices.data(), (unsigned int) indices.size(), indexType, &data[header.indexOffset]);
+
+    std::string temporaryPath = temporaryFilePath(path);
+    std::ofstream file(temporaryPath, std::ios::binary);
+    file.write(data.data(), data.size());
+    file.close();
+    if (!file || !replaceFile(temporaryPath, path)){
+        std::cout << "ERROR::MESH_FILE::CANNOT_WRITE " << path << std::endl;
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+
+// read only memory mapping of a mesh file; the blobs point straight into the mapping,
+// so they can be handed to glBufferData without any intermediate copy
+// -----------------------------------------------------------------------------------
+class MappedMeshFile {
+public:
+    MappedMeshFile() = default;
+    explicit MappedMeshFile(const std::string &path) { open(path); }
+    MappedMeshFile(const MappedMeshFile &) = delete;
+    MappedMeshFile &operator=(const MappedMeshFile &) = delete;
+    ~MappedMeshFile() { close(); }
+
+    bool open(const std::string &path){
+        close();
+        if (!mapFile(path)){
+            std::cout << "ERROR::MESH_FILE::CANNOT_MAP " << path << std::endl;
+            return false;
+        }
+        if (!validate()){
+            std::cout << "ERROR::MESH_FILE::INVALID " << path << std::endl;
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close(){
+        if (!data)
+            return;
+#ifdef _WIN32
+        UnmapViewOfFile(data);
+#else
+        munmap((void*) data, size);
+#endif
+        data = nullptr;
+        size = 0;
+    }
+
+    bool isOpen() const { return data != nullptr; }
+
+    const MeshFileHeader &header() const { return *(const MeshFileHeader*) data; }
+    unsigned int vertexCount() const { return header().vertexCount; }
+    unsigned int indexCount() const { return header().indexCount; }
+    const void* positionData() const { return data + header().positionOffset; }
+    const void* colorData() const { return data + header().colorOffset; }
+    // only valid for MESH_FORMAT_FLOAT32 attributes, see isQuantized(), decodePositions() and decodeColors()
+    const float* positions() const { return (const float*) positionData(); }
+    const float* colors() const { return (const float*) colorData(); }
+    const void* indexData() const { return data + header().indexOffset; }
+    unsigned int index(unsigned int i) const { return unpackIndex(indexData(), indexType(), i); }
+
+    bool isQuantized() const { return header().positionFormat != MESH_FORMAT_FLOAT32 || header().colorFormat != MESH_FORMAT_FLOAT32; }
+    unsigned int positionStride() const { return meshPositionStride(header().positionFormat); }
+    unsigned int colorStride() const { return meshColorStride(header().colorFormat); }
+    // GL type and normalization of the attributes, to be used with glVertexAttribPointer
+    GLenum positionType() const { return header().positionFormat == MESH_FORMAT_UNORM16 ? GL_UNSIGNED_SHORT : GL_FLOAT; }
+    GLenum colorType() const { return header().colorFormat == MESH_FORMAT_UNORM8 ? GL_UNSIGNED_BYTE : GL_FLOAT; }
+    GLboolean positionNormalized() const { return header().positionFormat == MESH_FORMAT_UNORM16 ? GL_TRUE : GL_FALSE; }
+    GLboolean colorNormalized() const { return header().colorFormat == MESH_FORMAT_UNORM8 ? GL_TRUE : GL_FALSE; }
+    GLenum indexType() const { return header().indexSize == 1 ? GL_UNSIGNED_BYTE : (header().indexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT); }
+    unsigned int indexSize() const { return header().indexSize; }
+
+    // levels of detail, level 0 is the full detail mesh
+    unsigned int lodCount() const { return header().lodCount; }
+    MeshLod lod(unsigned int level) const{
+        MeshLod lod;
+        lod.firstIndex = header().lodFirstIndex[level];
+        lod.indexCount = header().lodIndexCount[level];
+        lod.error = header().lodError[level];
+        return lod;
+    }
+
+    // transforms the positions read by the vertex shader back to model space, identity for float positions;
+    // concatenate it to the right of the model matrix
+    glm::mat4 dequantizationMatrix() const{
+        glm::mat4 matrix(1.0f);
+        for (int i = 0; i < 3; i++){
+            matrix[i][i] = header().positionScale[i];
+            matrix[3][i] = header().positionBias[i];
+        }
+        return matrix;
+    }
+
+    // the positions in model space, x,y,z per vertex, decoded if quantized
+    std::vector<float> decodePositions() const{
+        std::vector<float> positions(vertexCount() * 3);
+        for (unsigned int v = 0; v < vertexCount(); v++)
+            for (int i = 0; i < 3; i++){
+                if (header().positionFormat == MESH_FORMAT_FLOAT32)
+                    positions[v * 3 + i] = this->positions()[v * 3 + i];
+                else
+                    positions[v * 3 + i] = header().positionBias[i] + header().positionScale[i] *
+                            (float) ((const uint16_t*) positionData())[v * 4 + i] / (float) 0xFFFF;
+            }
+        return positions;
+    }
+
+    // the colors, r,g,b,a per vertex, decoded if quantized
+    std::vector<float> decodeColors() const{
+        std::vector<float> colors(vertexCount() * 4);
+        for (unsigned int c = 0; c < colors.size(); c++)
+            colors[c] = header().colorFormat == MESH_FORMAT_FLOAT32 ? this->colors()[c] :
+                    (float) ((const uint8_t*) colorData())[c] / (float) 0xFF;
+        return colors;
+    }
+
+    AABB bounds() const{
+        AABB box;
+        box.min = glm::vec3(header().boundsMin[0], header().boundsMin[1], header().boundsMin[2]);
+        box.max = glm::vec3(header().boundsMax[0], header().boundsMax[1], header().boundsMax[2]);
+        return box;
+    }
+
+    BoundingSphere sphere() const{
+        BoundingSphere sphere;
+        sphere.center = glm::vec3(header().sphereCenter[0], header().sphereCenter[1], header().sphereCenter[2]);
+        sphere.radius = header().sphereRadius;
+        return sphere;
+    }
+
+private:
+    bool mapFile(const std::string &path){
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER fileSize;
+        HANDLE mapping = NULL;
+        if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+            mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        CloseHandle(file);
+        if (mapping == NULL)
+            return false;
+        data = (const char*) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        size = (size_t) fileSize.QuadPart;
+#else
+        int file = ::open(path.c_str(), O_RDONLY);
+        if (file < 0)
+            return false;
+        struct stat fileStat;
+        void* mapping = MAP_FAILED;
+        if (fstat(file, &fileStat) == 0 && fileStat.st_size > 0)
+            mapping = mmap(nullptr, (size_t) fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        ::close(file);
+        if (mapping == MAP_FAILED)
+            return false;
+        data = (const char*) mapping;
+        size = (size_t) fileStat.st_size;
+#endif
+        return data != nullptr;
+    }
+
+    // make sure every blob described by the header lies inside of the file
+    bool validate() const{
+        if (size < sizeof(MeshFileHeader))
+            return false;
+        const MeshFileHeader &h = header();
+        if (std::memcmp(h.magic, MESH_FILE_MAGIC, 4) != 0 || h.version != MESH_FILE_VERSION)
+            return false;
+        // bit 0 marked the z pre-inverted files of older converters, their geometry would be mirrored
+        if (h.flags != 0)
+            return false;
+        if (h.indexSize != 1 && h.indexSize != 2 && h.indexSize != 4)
+            return false;
+        if (h.lodCount < 1 || h.lodCount > MAX_MESH_LODS)
+            return false;
+        for (uint32_t i = 0; i < h.lodCount; i++)
+            if ((uint64_t) h.lodFirstIndex[i] + h.lodIndexCount[i] > h.indexCount)
+                return false;
+        return (uint64_t) h.positionOffset + (uint64_t) h.vertexCount * meshPositionStride(h.positionFormat) <= size &&
+               (uint64_t) h.colorOffset + (uint64_t) h.vertexCount * meshColorStride(h.colorFormat) <= size &&
+               (uint64_t) h.indexOffset + (uint64_t) h.indexCount * h.indexSize <= size;
+    }
+
+    const char* data = nullptr;
+    size_t size = 0;
+};
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_MESH_FILE_H
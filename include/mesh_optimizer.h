@@ -0,0 +1,240 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_MESH_OPTIMIZER_H
+#define GRAPHICSPROGRAMMINGEXERCISES_MESH_OPTIMIZER_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "mesh_processing.h"
+
+// triangle and vertex order optimizations for indexed triangle lists:
+// - optimizeVertexCache reorders triangles for post-transform cache hits (Forsyth, "Linear-Speed Vertex Cache Optimisation")
+// - optimizeOverdraw reorders clusters of triangles so that outward facing parts are drawn first (Sander et al., "Fast
+//   Triangle Reordering for Vertex Locality and Reduced Overdraw"), keeping most of the cache locality
+// - optimizeVertexFetch (mesh_processing.h) then reorders the vertices to match the new triangle order
+// analyzeVertexCache runs a software FIFO cache, so the gains can be measured without a GPU
+// ---------------------------------------------------------------------------------------------------------------------
+
+struct VertexCacheStats {
+    float acmr = 0;     // average cache miss ratio, vertex shader invocations per triangle (0.5 is ideal, 3 is the worst)
+    float atvr = 0;     // average transformed vertex ratio, invocations per vertex (1 is ideal)
+};
+
+// simulates a FIFO post-transform cache of the given size
+inline VertexCacheStats analyzeVertexCache(const std::vector<unsigned int> &indices, unsigned int vertexCount,
+                                           unsigned int cacheSize = 16){
+    VertexCacheStats stats;
+    if (indices.empty() || vertexCount == 0)
+        return stats;
+    // a vertex is in the cache if it was inserted less than cacheSize insertions ago
+    std::vector<unsigned int> insertedAt(vertexCount, 0);
+    unsigned int insertions = 0, misses = 0;
+    for (unsigned int index : indices){
+        if (insertedAt[index] == 0 || insertions - insertedAt[index] >= cacheSize){
+            insertedAt[index] = ++insertions;
+            misses++;
+        }
+    }
+    stats.acmr = (float) misses / (float) (indices.size() / 3);
+    stats.atvr = (float) misses / (float) vertexCount;
+    return stats;
+}
+
+
+// returns the triangle order that maximizes the hits of a LRU cache, using Forsyth's vertex scores
+inline void optimizeVertexCache(std::vector<unsigned int> &indices, unsigned int vertexCount){
+    const int cacheSize = 32;
+    const float cacheDecayPower = 1.5f, lastTriangleScore = 0.75f;
+    const float valenceBoostScale = 2.0f, valenceBoostPower = 0.5f;
+
+    unsigned int triangleCount = (unsigned int) indices.size() / 3;
+    if (triangleCount == 0)
+        return;
+
+    // triangles that use each vertex, in compressed rows
+    std::vector<unsigned int> adjacencyOffset(vertexCount + 1, 0);
+    for (unsigned int index : indices)
+        adjacencyOffset[index + 1]++;
+    for (unsigned int v = 0; v < vertexCount; v++)
+        adjacencyOffset[v + 1] += adjacencyOffset[v];
+    std::vector<unsigned int> adjacency(indices.size());
+    std::vector<unsigned int> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+    for (unsigned int i = 0; i < indices.size(); i++)
+        adjacency[fill[indices[i]]++] = i / 3;
+
+    std::vector<unsigned int> activeTriangles(vertexCount);
+    for (unsigned int v = 0; v < vertexCount; v++)
+        activeTriangles[v] = adjacencyOffset[v + 1] - adjacencyOffset[v];
+    std::vector<int> cachePosition(vertexCount, -1);
+
+    auto vertexScore = [&](unsigned int v) -> float {
+        if (activeTriangles[v] == 0)
+            return -1.0f;
+        float score = 0.0f;
+        int position = cachePosition[v];
+        if (position >= 0)
+            score = position < 3 ? lastTriangleScore
+                                 : std::pow(1.0f - (float) (position - 3) / (float) (cacheSize - 3), cacheDecayPower);
+        return score + valenceBoostScale * std::pow((float) activeTriangles[v], -valenceBoostPower);
+    };
+
+    std::vector<float> vertexScores(vertexCount);
+    for (unsigned int v = 0; v < vertexCount; v++)
+        vertexScores[v] = vertexScore(v);
+    std::vector<float> triangleScores(triangleCount);
+    for (unsigned int t = 0; t < triangleCount; t++)
+        triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+    std::vector<unsigned int> cache, nextCache;
+    unsigned int scanCursor = 0;
+    int bestTriangle = -1;
+
+    for (unsigned int emittedCount = 0; emittedCount < triangleCount; emittedCount++){
+        // no candidate around the cache, take the next triangle that was not emitted yet
+        if (bestTriangle < 0){
+            while (emitted[scanCursor])
+                scanCursor++;
+            bestTriangle = (int) scanCursor;
+        }
+
+        unsigned int t = (unsigned int) bestTriangle;
+        emitted[t] = true;
+        const unsigned int* triangle = &indices[t * 3];
+        result.insert(result.end(), triangle, triangle + 3);
+
+        // the triangle vertices move to the front of the cache, the rest is shifted back
+        nextCache.assign(triangle, triangle + 3);
+        for (unsigned int v : cache)
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+                nextCache.push_back(v);
+        for (int i = 0; i < 3; i++){
+            unsigned int v = triangle[i];
+            unsigned int* begin = &adjacency[adjacencyOffset[v]];
+            unsigned int* end = begin + activeTriangles[v];
+            std::swap(*std::find(begin, end, t), *(end - 1));
+            activeTriangles[v]--;
+        }
+
+        // update the scores of the vertices in the cache and of their triangles, and pick the best one
+        bestTriangle = -1;
+        float bestScore = -1.0f;
+        for (unsigned int i = 0; i < nextCache.size(); i++){
+            unsigned int v = nextCache[i];
+            cachePosition[v] = i < (unsigned int) cacheSize ? (int) i : -1;
+            float newScore = vertexScore(v);
+            float delta = newScore - vertexScores[v];
+            vertexScores[v] = newScore;
+            for (unsigned int a = adjacencyOffset[v]; a < adjacencyOffset[v] + activeTriangles[v]; a++){
+                unsigned int other = adjacency[a];
+                triangleScores[other] += delta;
+                if (triangleScores[other] > bestScore){
+                    bestScore = triangleScores[other];
+                    bestTriangle = (int) other;
+                }
+            }
+        }
+        if (nextCache.size() > (unsigned int) cacheSize)
+            nextCache.resize(cacheSize);
+        cache.swap(nextCache);
+    }
+    indices.swap(result);
+}
+
+
+// splits the (cache optimized) triangle sequence in clusters where the cache simulation would start over,
+// i.e. at triangles that miss on all 3 vertices, and sorts the clusters so that those facing away from the
+// mesh center come first; for convex-ish parts these occlude the inner ones, reducing overdraw
+inline void optimizeOverdraw(std::vector<unsigned int> &indices, const std::vector<float> &positions,
+                             unsigned int vertexCount, unsigned int cacheSize = 16){
+    unsigned int triangleCount = (unsigned int) indices.size() / 3;
+    if (triangleCount == 0)
+        return;
+
+    // cluster boundaries from the FIFO cache simulation
+    std::vector<unsigned int> clusterStart;
+    std::vector<unsigned int> insertedAt(vertexCount, 0);
+    unsigned int insertions = 0;
+    for (unsigned int t = 0; t < triangleCount; t++){
+        unsigned int misses = 0;
+        for (int i = 0; i < 3; i++){
+            unsigned int index = indices[t * 3 + i];
+            if (insertedAt[index] == 0 || insertions - insertedAt[index] >= cacheSize){
+                insertedAt[index] = ++insertions;
+                misses++;
+            }
+        }
+        if (t == 0 || misses == 3)
+            clusterStart.push_back(t);
+    }
+    clusterStart.push_back(triangleCount);
+
+    auto vertex = [&positions](unsigned int index){
+        return glm::vec3(positions[index * 3], positions[index * 3 + 1], positions[index * 3 + 2]);
+    };
+
+    // mesh centroid, weighted by triangle area
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+    for (unsigned int t = 0; t < triangleCount; t++){
+        glm::vec3 a = vertex(indices[t * 3]), b = vertex(indices[t * 3 + 1]), c = vertex(indices[t * 3 + 2]);
+        float area = glm::length(glm::cross(b - a, c - a)) * .5f;
+        meshCentroid += (a + b + c) * (area / 3.0f);
+        meshArea += area;
+    }
+    if (meshArea > 0.0f)
+        meshCentroid /= meshArea;
+
+    // sort key of each cluster: how much its average normal points away from the mesh centroid
+    struct Cluster {
+        unsigned int start, end;
+        float sortKey;
+    };
+    std::vector<Cluster> clusters;
+    for (unsigned int c = 0; c + 1 < clusterStart.size(); c++){
+        glm::vec3 centroid(0.0f), normal(0.0f);
+        float area = 0.0f;
+        for (unsigned int t = clusterStart[c]; t < clusterStart[c + 1]; t++){
+            glm::vec3 a = vertex(indices[t * 3]), b = vertex(indices[t * 3 + 1]), d = vertex(indices[t * 3 + 2]);
+            glm::vec3 areaNormal = glm::cross(b - a, d - a) * .5f;
+            float triangleArea = glm::length(areaNormal);
+            centroid += (a + b + d) * (triangleArea / 3.0f);
+            normal += areaNormal;
+            area += triangleArea;
+        }
+        if (area > 0.0f)
+            centroid /= area;
+        float normalLength = glm::length(normal);
+        float sortKey = normalLength > 0.0f ? glm::dot(centroid - meshCentroid, normal / normalLength) : 0.0f;
+        clusters.push_back(Cluster{clusterStart[c], clusterStart[c + 1], sortKey});
+    }
+    std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster &a, const Cluster &b){
+        return a.sortKey > b.sortKey;
+    });
+
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+    for (const Cluster &cluster : clusters)
+        result.insert(result.end(), indices.begin() + cluster.start * 3, indices.begin() + cluster.end * 3);
+    indices.swap(result);
+}
+
+
+// runs the triangle and vertex reordering on a mesh, prints the cache statistics before and after when out is given
+inline void optimizeMesh(MeshData &mesh, bool reduceOverdraw, std::ostream* out = nullptr){
+    VertexCacheStats before = analyzeVertexCache(mesh.indices, mesh.vertexCount());
+    optimizeVertexCache(mesh.indices, mesh.vertexCount());
+    if (reduceOverdraw)
+        optimizeOverdraw(mesh.indices, mesh.positions, mesh.vertexCount());
+    optimizeVertexFetch(mesh);
+    VertexCacheStats after = analyzeVertexCache(mesh.indices, mesh.vertexCount());
+    if (out)
+        *out << "ACMR " << before.acmr << " -> " << after.acmr << ", ATVR " << before.atvr << " -> " << after.atvr << std::endl;
+}
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_MESH_OPTIMIZER_H
@@ -0,0 +1,129 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_MESH_PROCESSING_H
+#define GRAPHICSPROGRAMMINGEXERCISES_MESH_PROCESSING_H
+
+#include <vector>
+#include <unordered_map>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+
+#include "bounds.h"
+
+// level of detail of a mesh, a range of its index buffer; all the levels share the same vertices
+// ----------------------------------------------------------------------------------------------
+const unsigned int MAX_MESH_LODS = 4;
+
+struct MeshLod {
+    unsigned int firstIndex = 0;
+    unsigned int indexCount = 0;
+    float error = 0.0f;         // simplification error, relative to the mesh extent
+};
+
+
+// indexed triangle mesh on the CPU, in the layout used by the exercises:
+// positions are x,y,z and colors r,g,b,a per vertex
+// ---------------------------------------------------------------------
+struct MeshData {
+    std::vector<float> positions;
+    std::vector<float> colors;
+    std::vector<unsigned int> indices;
+    std::vector<MeshLod> lods;  // when empty, the mesh has a single level made of all the indices
+
+    unsigned int vertexCount() const { return (unsigned int) (positions.size() / 3); }
+    unsigned int triangleCount() const { return (unsigned int) (indices.size() / 3); }
+};
+
+
+// moves positions to the 16 bit grid spanning the mesh bounds and colors to the 8 bit grid,
+// i.e. to the values writeMeshFile(..., quantize = true) will store; done before deduplicateVertices,
+// vertices that only differ by less than the quantization step are merged
+inline void snapToQuantizationGrid(MeshData &mesh){
+    AABB box = computeAABB(mesh.positions);
+    for (unsigned int i = 0; i < mesh.positions.size(); i++){
+        float minValue = box.min[i % 3], range = box.max[i % 3] - box.min[i % 3];
+        if (range > 0.0f)
+            mesh.positions[i] = minValue + std::round((mesh.positions[i] - minValue) / range * 65535.0f) / 65535.0f * range;
+    }
+    for (float &channel : mesh.colors)
+        channel = std::round(channel * 255.0f) / 255.0f;
+}
+
+// merges the vertices with identical position and color, and remaps the indices
+inline void deduplicateVertices(MeshData &mesh){
+    struct VertexKey {
+        float attributes[7];
+        bool operator==(const VertexKey &other) const {
+            return std::memcmp(attributes, other.attributes, sizeof(attributes)) == 0;
+        }
+    };
+    struct VertexKeyHash {
+        size_t operator()(const VertexKey &key) const {
+            // FNV-1a over the attribute bytes
+            uint64_t hash = 14695981039346656037ull;
+            const unsigned char* bytes = (const unsigned char*) key.attributes;
+            for (unsigned int i = 0; i < sizeof(key.attributes); i++)
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+            return (size_t) hash;
+        }
+    };
+
+    unsigned int vertexCount = mesh.vertexCount();
+    std::unordered_map<VertexKey, unsigned int, VertexKeyHash> uniqueVertices;
+    uniqueVertices.reserve(vertexCount);
+    std::vector<unsigned int> remap(vertexCount);
+    MeshData result;
+    for (unsigned int v = 0; v < vertexCount; v++){
+        VertexKey key;
+        std::memcpy(key.attributes, &mesh.positions[v * 3], 3 * sizeof(float));
+        std::memcpy(key.attributes + 3, &mesh.colors[v * 4], 4 * sizeof(float));
+        // +0 and -0 compare equal but have different bytes
+        for (float &attribute : key.attributes)
+            attribute = attribute == 0.0f ? 0.0f : attribute;
+
+        auto inserted = uniqueVertices.insert(std::make_pair(key, result.vertexCount()));
+        if (inserted.second){
+            result.positions.insert(result.positions.end(), key.attributes, key.attributes + 3);
+            result.colors.insert(result.colors.end(), key.attributes + 3, key.attributes + 7);
+        }
+        remap[v] = inserted.first->second;
+    }
+    for (unsigned int &index : mesh.indices)
+        index = remap[index];
+    mesh.positions.swap(result.positions);
+    mesh.colors.swap(result.colors);
+}
+
+// drops triangles that reference the same vertex more than once (they cover no pixels)
+inline void removeDegenerateTriangles(MeshData &mesh){
+    unsigned int kept = 0;
+    for (unsigned int t = 0; t < mesh.triangleCount(); t++){
+        unsigned int a = mesh.indices[t * 3], b = mesh.indices[t * 3 + 1], c = mesh.indices[t * 3 + 2];
+        if (a == b || b == c || a == c)
+            continue;
+        mesh.indices[kept * 3] = a;
+        mesh.indices[kept * 3 + 1] = b;
+        mesh.indices[kept * 3 + 2] = c;
+        kept++;
+    }
+    mesh.indices.resize(kept * 3);
+}
+
+// reorders the vertices in the order in which the index buffer first references them, so that vertex fetches
+// walk the vertex buffer mostly forward; vertices that are never referenced are removed
+inline void optimizeVertexFetch(MeshData &mesh){
+    const unsigned int unassigned = ~0u;
+    std::vector<unsigned int> remap(mesh.vertexCount(), unassigned);
+    MeshData result;
+    for (unsigned int &index : mesh.indices){
+        if (remap[index] == unassigned){
+            remap[index] = result.vertexCount();
+            result.positions.insert(result.positions.end(), &mesh.positions[index * 3], &mesh.positions[index * 3] + 3);
+            result.colors.insert(result.colors.end(), &mesh.colors[index * 4], &mesh.colors[index * 4] + 4);
+        }
+        index = remap[index];
+    }
+    mesh.positions.swap(result.positions);
+    mesh.colors.swap(result.colors);
+}
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_MESH_PROCESSING_H
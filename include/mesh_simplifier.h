@@ -0,0 +1,270 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_MESH_SIMPLIFIER_H
+#define GRAPHICSPROGRAMMINGEXERCISES_MESH_SIMPLIFIER_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "mesh_processing.h"
+#include "mesh_optimizer.h"
+
+// mesh simplification with quadric error metrics (Garland and Heckbert, "Surface Simplification Using Quadric
+// Error Metrics"), by half edge collapses: a vertex is merged into one of its neighbours, so no new vertex is
+// created and every level of detail can index the vertex buffer of the full detail mesh
+// vertices with the same position but different colors are collapsed together (or not at all), so color
+// seams are preserved; vertices on open borders never move
+// ----------------------------------------------------------------------------------------------------------
+
+// symmetric 4x4 matrix, sum of the squared distance to a set of planes
+struct Quadric {
+    double a[10] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};  // xx xy xz xw yy yz yw zz zw ww
+
+    void addPlane(const glm::vec3 &n, float d){
+        const double p[4] = {n.x, n.y, n.z, d};
+        int k = 0;
+        for (int i = 0; i < 4; i++)
+            for (int j = i; j < 4; j++)
+                a[k++] += p[i] * p[j];
+    }
+    void add(const Quadric &other){
+        for (int i = 0; i < 10; i++)
+            a[i] += other.a[i];
+    }
+    double evaluate(const glm::vec3 &v) const{
+        double x = v.x, y = v.y, z = v.z;
+        return a[0]*x*x + 2*a[1]*x*y + 2*a[2]*x*z + 2*a[3]*x + a[4]*y*y + 2*a[5]*y*z + 2*a[6]*y
+               + a[7]*z*z + 2*a[8]*z + a[9];
+    }
+};
+
+
+// returns the indices of a simplified version of the mesh, with at most targetIndexCount indices unless that
+// would need an error larger than targetError (relative to the mesh extent); the error reached is written to
+// resultError, the vertices are not modified
+inline std::vector<unsigned int> simplifyMesh(const std::vector<float> &positions, const std::vector<unsigned int> &indices,
+                                              unsigned int targetIndexCount, float targetError, float* resultError = nullptr){
+    unsigned int vertexCount = (unsigned int) (positions.size() / 3);
+    std::vector<unsigned int> result = indices;
+    if (resultError)
+        *resultError = 0.0f;
+    if (vertexCount == 0 || indices.size() <= targetIndexCount)
+        return result;
+
+    auto position = [&positions](unsigned int v){
+        return glm::vec3(positions[v * 3], positions[v * 3 + 1], positions[v * 3 + 2]);
+    };
+
+    // group the vertices by position; the first vertex of each group represents it
+    std::vector<unsigned int> group(vertexCount);
+    {
+        std::unordered_map<uint64_t, std::vector<unsigned int>> buckets;
+        for (unsigned int v = 0; v < vertexCount; v++){
+            uint32_t bits[3];
+            std::memcpy(bits, &positions[v * 3], sizeof(bits));
+            uint64_t hash = ((uint64_t) bits[0] * 73856093ull) ^ ((uint64_t) bits[1] * 19349663ull) ^ ((uint64_t) bits[2] * 83492791ull);
+            std::vector<unsigned int> &bucket = buckets[hash];
+            group[v] = v;
+            for (unsigned int other : bucket)
+                if (position(other) == position(v)){
+                    group[v] = other;
+                    break;
+                }
+            if (group[v] == v)
+                bucket.push_back(v);
+        }
+    }
+    std::vector<std::vector<unsigned int>> wedges(vertexCount);    // vertices of each group
+    for (unsigned int v = 0; v < vertexCount; v++)
+        wedges[group[v]].push_back(v);
+
+    // a group on an edge used by a single triangle is on a border, and stays where it is
+    std::vector<bool> locked(vertexCount, false);
+    {
+        std::unordered_map<uint64_t, int> edgeUses;
+        for (unsigned int i = 0; i < result.size(); i += 3)
+            for (int e = 0; e < 3; e++){
+                unsigned int a = group[result[i + e]], b = group[result[i + (e + 1) % 3]];
+                edgeUses[((uint64_t) std::min(a, b) << 32) | std::max(a, b)]++;
+            }
+        for (const auto &edge : edgeUses)
+            if (edge.second == 1){
+                locked[(unsigned int) (edge.first >> 32)] = true;
+                locked[(unsigned int) (edge.first & 0xFFFFFFFF)] = true;
+            }
+    }
+
+    // error quadric of each group, from the planes of its triangles
+    std::vector<Quadric> quadrics(vertexCount);
+    for (unsigned int i = 0; i < result.size(); i += 3){
+        glm::vec3 p0 = position(result[i]), p1 = position(result[i + 1]), p2 = position(result[i + 2]);
+        glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+        float length = glm::length(normal);
+        if (length <= 0.0f)
+            continue;
+        normal /= length;
+        Quadric plane;
+        plane.addPlane(normal, -glm::dot(normal, p0));
+        for (int k = 0; k < 3; k++)
+            quadrics[group[result[i + k]]].add(plane);
+    }
+
+    AABB box = computeAABB(positions);
+    float extent = glm::max(glm::max(box.max.x - box.min.x, box.max.y - box.min.y), box.max.z - box.min.z);
+    double maxCost = (double) targetError * extent * (double) targetError * extent;
+    double reachedCost = 0.0;
+
+    struct Collapse {
+        unsigned int from, to;      // groups
+        double cost;
+    };
+    std::vector<Collapse> collapses;
+    std::vector<std::vector<unsigned int>> groupTriangles(vertexCount);
+    std::vector<unsigned int> remap(vertexCount);
+    std::vector<bool> touched(vertexCount);
+
+    while (result.size() > targetIndexCount){
+        // triangles around each group
+        for (std::vector<unsigned int> &triangles : groupTriangles)
+            triangles.clear();
+        for (unsigned int t = 0; t < result.size() / 3; t++)
+            for (int k = 0; k < 3; k++)
+                groupTriangles[group[result[t * 3 + k]]].push_back(t);
+
+        // every edge, in both directions, sorted by cost
+        collapses.clear();
+        for (unsigned int i = 0; i < result.size(); i += 3)
+            for (int e = 0; e < 3; e++){
+                unsigned int a = group[result[i + e]], b = group[result[i + (e + 1) % 3]];
+                Quadric q = quadrics[a];
+                q.add(quadrics[b]);
+                if (!locked[a])
+                    collapses.push_back(Collapse{a, b, q.evaluate(position(b))});
+                if (!locked[b])
+                    collapses.push_back(Collapse{b, a, q.evaluate(position(a))});
+            }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse &x, const Collapse &y){ return x.cost < y.cost; });
+
+        // collapse in order of cost, at most one collapse around each group per pass,
+        // enough to remove about the triangles in excess
+        for (unsigned int v = 0; v < vertexCount; v++)
+            remap[v] = v;
+        std::fill(touched.begin(), touched.end(), false);
+        unsigned int budget = std::max(1u, (unsigned int) (result.size() - targetIndexCount) / 6);
+        unsigned int collapsed = 0;
+        for (const Collapse &collapse : collapses){
+            if (collapsed >= budget || collapse.cost > maxCost)
+                break;
+            if (touched[collapse.from] || touched[collapse.to])
+                continue;
+
+            // every vertex of the group must have a vertex of the target group as neighbour to be merged into
+            bool valid = true;
+            std::vector<std::pair<unsigned int, unsigned int>> merges;
+            for (unsigned int wedge : wedges[collapse.from]){
+                unsigned int target = ~0u;
+                for (unsigned int t : groupTriangles[collapse.from]){
+                    const unsigned int* triangle = &result[t * 3];
+                    if (triangle[0] != wedge && triangle[1] != wedge && triangle[2] != wedge)
+                        continue;
+                    for (int k = 0; k < 3; k++)
+                        if (group[triangle[k]] == collapse.to)
+                            target = triangle[k];
+                }
+                bool used = false;
+                for (unsigned int t : groupTriangles[collapse.from])
+                    used = used || result[t * 3] == wedge || result[t * 3 + 1] == wedge || result[t * 3 + 2] == wedge;
+                if (used && target == ~0u){
+                    valid = false;
+                    break;
+                }
+                if (used)
+                    merges.push_back(std::make_pair(wedge, target));
+            }
+
+            // the triangles that remain must not flip
+            glm::vec3 to = position(collapse.to);
+            for (unsigned int t = 0; valid && t < groupTriangles[collapse.from].size(); t++){
+                const unsigned int* triangle = &result[groupTriangles[collapse.from][t] * 3];
+                if (group[triangle[0]] == collapse.to || group[triangle[1]] == collapse.to || group[triangle[2]] == collapse.to)
+                    continue;
+                glm::vec3 p[3], q[3];
+                for (int k = 0; k < 3; k++){
+                    p[k] = position(triangle[k]);
+                    q[k] = group[triangle[k]] == collapse.from ? to : p[k];
+                }
+                glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+                if (glm::dot(before, after) <= 0.0f)
+                    valid = false;
+            }
+            if (!valid)
+                continue;
+
+            for (const auto &merge : merges)
+                remap[merge.first] = merge.second;
+            quadrics[collapse.to].add(quadrics[collapse.from]);
+            // the one ring of both groups changed, their other collapses wait for the next pass
+            for (unsigned int g : {collapse.from, collapse.to})
+                for (unsigned int t : groupTriangles[g])
+                    for (int k = 0; k < 3; k++)
+                        touched[group[result[t * 3 + k]]] = true;
+            reachedCost = std::max(reachedCost, collapse.cost);
+            collapsed++;
+        }
+        if (collapsed == 0)
+            break;
+
+        // apply the collapses and drop the triangles that lost their area
+        unsigned int kept = 0;
+        for (unsigned int i = 0; i < result.size(); i += 3){
+            unsigned int a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+            if (group[a] == group[b] || group[b] == group[c] || group[a] == group[c])
+                continue;
+            result[kept++] = a;
+            result[kept++] = b;
+            result[kept++] = c;
+        }
+        result.resize(kept);
+    }
+
+    if (resultError)
+        *resultError = extent > 0.0f ? (float) std::sqrt(reachedCost) / extent : 0.0f;
+    return result;
+}
+
+
+// appends to the mesh indices up to lodCount - 1 simplified levels, each with about half the triangles of the
+// previous one, and fills mesh.lods; levels that would not remove at least 10% of the triangles are skipped,
+// so small meshes can end up with a single level. Call it last, the other processing steps ignore the levels
+inline void generateMeshLods(MeshData &mesh, unsigned int lodCount = MAX_MESH_LODS, float maxError = .05f){
+    mesh.lods.clear();
+    MeshLod full;
+    full.indexCount = (unsigned int) mesh.indices.size();
+    mesh.lods.push_back(full);
+
+    std::vector<unsigned int> previous = mesh.indices;
+    for (unsigned int level = 1; level < std::min(lodCount, MAX_MESH_LODS); level++){
+        unsigned int target = (unsigned int) previous.size() / 6 * 3;
+        // the allowed error grows with the level, coarse levels are only used for small objects
+        float error;
+        std::vector<unsigned int> simplified = simplifyMesh(mesh.positions, previous, target,
+                                                            maxError * (float) (1u << (level - 1)) / 4.0f, &error);
+        if (simplified.empty() || simplified.size() > previous.size() * 9 / 10)
+            break;
+        optimizeVertexCache(simplified, mesh.vertexCount());
+
+        MeshLod lod;
+        lod.firstIndex = (unsigned int) mesh.indices.size();
+        lod.indexCount = (unsigned int) simplified.size();
+        lod.error = std::max(error, mesh.lods.back().error);
+        mesh.indices.insert(mesh.indices.end(), simplified.begin(), simplified.end());
+        mesh.lods.push_back(lod);
+        previous.swap(simplified);
+    }
+}
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_MESH_SIMPLIFIER_H
@@ -0,0 +1,29 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_MESH_UPLOAD_H
+#define GRAPHICSPROGRAMMINGEXERCISES_MESH_UPLOAD_H
+
+#include <glad/glad.h>
+
+#include <vector>
+
+class MappedMeshFile;
+
+// buffer and vertex array creation shared by the exercises, compiled once in gp_core (core/mesh_upload.cpp)
+// -------------------------------------------------------------------------------------------------------
+
+// creates and binds a GL_ARRAY_BUFFER with size bytes of data
+unsigned int createArrayBuffer(const void* data, unsigned int size);
+unsigned int createArrayBuffer(const std::vector<float> &array);
+
+// creates and binds a GL_ELEMENT_ARRAY_BUFFER with count indices of the given type (see index_buffer.h)
+unsigned int createElementArrayBuffer(const void* data, unsigned int count, GLenum type);
+// same, with the indices narrowed to the smallest type that holds them, which is returned in type
+unsigned int createElementArrayBuffer(const std::vector<unsigned int> &array, GLenum &type);
+
+// vertex array with the vertex shader attributes "pos" (vec3) and "color" (vec4) of program and an element buffer
+// of narrowed indices, left bound; indexType is the type to draw it with (e.g. SceneObject::indexType)
+unsigned int createVertexArray(const std::vector<float> &positions, const std::vector<float> &colors,
+                               const std::vector<unsigned int> &indices, unsigned int program, GLenum &indexType);
+// same, with the buffers filled straight from a mapped mesh file (see mesh_file.h), in its vertex and index formats
+unsigned int createVertexArray(const MappedMeshFile &mesh, unsigned int program);
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_MESH_UPLOAD_H
@@ -0,0 +1,123 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_PARTICLE_EMITTERS_H
+#define GRAPHICSPROGRAMMINGEXERCISES_PARTICLE_EMITTERS_H
+
+#include <vector>
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+
+#include "cpu_profiler.h"
+#include "worker_pool.h"
+
+// particle emitters that run on worker threads, merged into one array per frame for a single upload:
+//
+//     ParticleEmitters<Particle> emitters;
+//     emitters.add([](Pcg32 &random, std::vector<Particle> &out){ out.push_back(Particle{random.nextFloat(), ...}); });
+//     const std::vector<Particle> &emitted = emitters.emit();    // every frame
+//     glBufferSubData(GL_ARRAY_BUFFER, ..., emitted.size() * sizeof(Particle), emitted.data());
+//
+// every emitter owns its random generator and its staging array, so the emitters share nothing while they run
+// and take no locks; emit() runs them in chunks on a WorkerPool (worker_pool.h), then every chunk copies its
+// staging arrays to its range of the merged array. The generators are seeded per emitter, so the particles are
+// the same for any thread count
+// -------------------------------------------------------------------------------------------------------------
+
+// PCG32 (O'Neill, "PCG: A Family of Simple Fast Space-Efficient Statistically Good Algorithms for Random Number
+// Generation"), 64 bit state and a stream per emitter; rand() takes a lock in glibc and is shared by all threads
+class Pcg32 {
+public:
+    explicit Pcg32(uint64_t seed = 0x853c49e6748fea9bULL, uint64_t stream = 0xda3e39cb94b95bdbULL){
+        increment = (stream << 1u) | 1u;
+        state = 0;
+        next();
+        state += seed;
+        next();
+    }
+
+    uint32_t next(){
+        uint64_t old = state;
+        state = old * 6364136223846793005ULL + increment;
+        uint32_t shifted = (uint32_t) (((old >> 18u) ^ old) >> 27u);
+        uint32_t rotation = (uint32_t) (old >> 59u);
+        return (shifted >> rotation) | (shifted << ((-rotation) & 31u));
+    }
+
+    // in [0, 1), the top 24 bits
+    float nextFloat(){
+        return (float) (next() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    // in [min, max)
+    float nextFloat(float min, float max){
+        return min + (max - min) * nextFloat();
+    }
+
+private:
+    uint64_t state, increment;
+};
+
+
+template<typename Particle>
+class ParticleEmitters {
+public:
+    // appends the particles of this frame to out, called once per frame on any of the threads
+    typedef std::function<void(Pcg32 &random, std::vector<Particle> &out)> Emitter;
+
+    explicit ParticleEmitters(unsigned int threads = std::thread::hardware_concurrency(), uint64_t seed = 42)
+            : pool("particle emitter", threads), seed(seed) {}
+
+    void setThreadCount(unsigned int threads) { pool.setThreadCount(threads); }
+    unsigned int getThreadCount() const { return pool.getThreadCount(); }
+
+    // the emitter gets the stream of its index, emitters added in the same order emit the same particles
+    void add(Emitter emitter){
+        emitters.push_back(Slot{std::move(emitter), Pcg32(seed, emitters.size()), std::vector<Particle>()});
+    }
+    void clear() { emitters.clear(); }
+    unsigned int size() const { return (unsigned int) emitters.size(); }
+
+    // runs every emitter and returns their particles in emitter order, valid until the next call
+    const std::vector<Particle> &emit(){
+        CPU_SCOPE("emitParticles");
+        unsigned int count = size();
+        unsigned int chunks = std::max(1u, std::min(count, pool.getThreadCount()));
+        unsigned int chunkSize = (count + chunks - 1) / std::max(1u, chunks);
+        auto begin = [=](unsigned int chunk){ return std::min(chunk * chunkSize, count); };
+        auto end = [=](unsigned int chunk){ return std::min((chunk + 1) * chunkSize, count); };
+
+        pool.run(chunks, [&](unsigned int chunk){
+            for (unsigned int i = begin(chunk); i < end(chunk); i++){
+                emitters[i].staging.clear();
+                emitters[i].emitter(emitters[i].random, emitters[i].staging);
+            }
+        });
+
+        // the position of every emitter in the merged array, then every chunk copies its emitters
+        offsets.resize(count + 1);
+        offsets[0] = 0;
+        for (unsigned int i = 0; i < count; i++)
+            offsets[i + 1] = offsets[i] + emitters[i].staging.size();
+        merged.resize(offsets[count]);
+        pool.run(chunks, [&](unsigned int chunk){
+            for (unsigned int i = begin(chunk); i < end(chunk); i++)
+                std::copy(emitters[i].staging.begin(), emitters[i].staging.end(), merged.begin() + offsets[i]);
+        });
+        return merged;
+    }
+
+private:
+    struct Slot {
+        Emitter emitter;
+        Pcg32 random;
+        std::vector<Particle> staging;      // keeps its capacity between frames
+    };
+
+    WorkerPool pool;
+    uint64_t seed;
+    std::vector<Slot> emitters;
+    std::vector<size_t> offsets;
+    std::vector<Particle> merged;
+};
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_PARTICLE_EMITTERS_H
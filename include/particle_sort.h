@@ -0,0 +1,114 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_PARTICLE_SORT_H
+#define GRAPHICSPROGRAMMINGEXERCISES_PARTICLE_SORT_H
+
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <cstdint>
+
+#include "cpu_profiler.h"
+#include "worker_pool.h"
+
+// back to front order of particles for blending that depends on the draw order (GL_ONE_MINUS_SRC_ALPHA):
+//
+//     particleSorter.sort(particleCount, [&](unsigned int i){ return depthKey(distance of particle i); }, order);
+//     glBufferData(GL_ELEMENT_ARRAY_BUFFER, ..., order.data(), GL_STREAM_DRAW);
+//     glDrawElements(GL_POINTS, particleCount, GL_UNSIGNED_INT, 0);
+//
+// the depths are quantized to 16 bit keys and sorted with a least significant digit radix sort, two stable passes
+// of 8 bits, so the cost is linear in the number of particles. Every pass is split in chunks, one per thread: the
+// threads count the digits of their chunk, the counts are turned into the first output position of every digit
+// and chunk, and the threads scatter their chunks to disjoint positions. The threads are a WorkerPool
+// (worker_pool.h), the calling thread sorts the first chunk
+// -------------------------------------------------------------------------------------------------------------
+
+// larger keys are drawn first: depth 0 (near) maps to 65535, maxDepth (far) and beyond to 0
+inline uint16_t depthKey(float depth, float maxDepth){
+    float t = std::min(std::max(depth / maxDepth, 0.0f), 1.0f);
+    return (uint16_t) ((1.0f - t) * 65535.0f + .5f);
+}
+
+class ParticleSorter {
+public:
+    static const unsigned int RADIX = 256;
+
+    explicit ParticleSorter(unsigned int threads = std::thread::hardware_concurrency()) : pool("particle sort", threads) {}
+
+    void setThreadCount(unsigned int threads) { pool.setThreadCount(threads); }
+    unsigned int getThreadCount() const { return pool.getThreadCount(); }
+
+    // order gets the indices 0 to count - 1 sorted by key(index) (uint16_t) in ascending order, equal keys keep
+    // their index order; key is called once per index, from any of the threads
+    template<typename KeyFunction>
+    void sort(unsigned int count, const KeyFunction &key, std::vector<unsigned int> &order){
+        CPU_SCOPE("sortParticles");
+        keys.resize(count);
+        scratchKeys.resize(count);
+        scratchIndices.resize(count);
+        order.resize(count);
+        // small sorts are not worth waking the threads
+        unsigned int chunks = count < 16384 ? 1 : pool.getThreadCount();
+        counts.assign((size_t) chunks * RADIX, 0);
+        unsigned int chunkSize = (count + chunks - 1) / chunks;
+
+        // low byte: compute the keys and scatter the indices by the low digit
+        pool.run(chunks, [&](unsigned int chunk){
+            unsigned int* digitCounts = &counts[(size_t) chunk * RADIX];
+            for (unsigned int i = begin(chunk, chunkSize, count); i < end(chunk, chunkSize, count); i++){
+                keys[i] = key(i);
+                digitCounts[keys[i] & 0xFF]++;
+            }
+        });
+        toOffsets(chunks);
+        pool.run(chunks, [&](unsigned int chunk){
+            unsigned int* offsets = &counts[(size_t) chunk * RADIX];
+            for (unsigned int i = begin(chunk, chunkSize, count); i < end(chunk, chunkSize, count); i++){
+                unsigned int position = offsets[keys[i] & 0xFF]++;
+                scratchKeys[position] = keys[i];
+                scratchIndices[position] = i;
+            }
+        });
+
+        // high byte: the chunks are the same ranges of the scratch arrays, the order within a digit is kept
+        std::fill(counts.begin(), counts.end(), 0u);
+        pool.run(chunks, [&](unsigned int chunk){
+            unsigned int* digitCounts = &counts[(size_t) chunk * RADIX];
+            for (unsigned int i = begin(chunk, chunkSize, count); i < end(chunk, chunkSize, count); i++)
+                digitCounts[scratchKeys[i] >> 8]++;
+        });
+        toOffsets(chunks);
+        pool.run(chunks, [&](unsigned int chunk){
+            unsigned int* offsets = &counts[(size_t) chunk * RADIX];
+            for (unsigned int i = begin(chunk, chunkSize, count); i < end(chunk, chunkSize, count); i++)
+                order[offsets[scratchKeys[i] >> 8]++] = scratchIndices[i];
+        });
+    }
+
+private:
+    static unsigned int begin(unsigned int chunk, unsigned int chunkSize, unsigned int count){
+        return std::min(chunk * chunkSize, count);
+    }
+    static unsigned int end(unsigned int chunk, unsigned int chunkSize, unsigned int count){
+        return std::min((chunk + 1) * chunkSize, count);
+    }
+
+    // digit counts per chunk to the output position of the first element of every digit of every chunk: all the
+    // elements of smaller digits come first, then the elements of the same digit in the chunks before
+    void toOffsets(unsigned int chunks){
+        unsigned int position = 0;
+        for (unsigned int digit = 0; digit < RADIX; digit++)
+            for (unsigned int chunk = 0; chunk < chunks; chunk++){
+                unsigned int &value = counts[(size_t) chunk * RADIX + digit];
+                unsigned int digitCount = value;
+                value = position;
+                position += digitCount;
+            }
+    }
+
+    WorkerPool pool;
+    std::vector<uint16_t> keys, scratchKeys;
+    std::vector<unsigned int> scratchIndices;
+    std::vector<unsigned int> counts;      // RADIX digit counts, then output offsets, per chunk
+};
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_PARTICLE_SORT_H
@@ -0,0 +1,154 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_PERF_HUD_H
+#define GRAPHICSPROGRAMMINGEXERCISES_PERF_HUD_H
+
+#include <imgui.h>
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <cfloat>
+#include <cstdio>
+
+#include "gl_call_counter.h"
+#include "frame_stats.h"
+
+// ImGui performance window (see debug_ui.h for the setup): frame time graph and histogram, p50/p95/p99 of the
+// last HISTORY_SIZE frames, the draw calls and triangles of the last frame when the GL call counter is installed,
+// the buffer memory and counters set by the exercise, and sliders that change parameters of the scene live:
+//
+//     perfHud.addSlider("emission rate", &emissionRate, 0, 200);
+//     perfHud.addSlider("cubes", &cubeCount, 0, 20000, rebuildWorld);     // called when the value changes
+//     while (...) {
+//         perfHud.newFrame();
+//         perfHud.setCounter("particles", aliveParticles);
+//         ... render the frame ...
+//         beginDebugUi(); perfHud.draw(); endDebugUi();
+//     }
+// -------------------------------------------------------------------------------------------------------------
+
+class PerfHud {
+public:
+    static const unsigned int HISTORY_SIZE = 240;
+    static const unsigned int HISTOGRAM_BUCKETS = 25;
+
+    // frame time of the frame that just ended, measured from the previous call
+    void newFrame(){
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (started)
+            addFrameTime(std::chrono::duration<float, std::milli>(now - lastFrame).count());
+        started = true;
+        lastFrame = now;
+    }
+
+    void addFrameTime(float ms){
+        history[next] = ms;
+        next = (next + 1) % HISTORY_SIZE;
+        if (samples < HISTORY_SIZE)
+            samples++;
+    }
+
+    // percentiles of the frames in the history
+    FrameTimeStats frameTimeStats() const{
+        return computeFrameTimeStats(std::vector<float>(history, history + samples));
+    }
+
+    // value shown in the window until it is set again, e.g. the number of live particles
+    void setCounter(const char* label, double value){
+        for (Counter &counter : counters)
+            if (counter.label == label){
+                counter.value = value;
+                return;
+            }
+        counters.push_back(Counter{label, value});
+    }
+
+    // bytes of vertex/index buffers, when not set the allocations seen by the GL call counter are shown
+    void setBufferBytes(size_t bytes){
+        bufferBytes = bytes;
+        bufferBytesSet = true;
+    }
+
+    // the value is edited in place, onChange (optional) runs in draw() right after the value changed
+    void addSlider(const char* label, float* value, float min, float max, std::function<void()> onChange = nullptr){
+        sliders.push_back(Slider{label, value, nullptr, min, max, onChange});
+    }
+
+    void addSlider(const char* label, int* value, int min, int max, std::function<void()> onChange = nullptr){
+        sliders.push_back(Slider{label, nullptr, value, (float) min, (float) max, onChange});
+    }
+
+    void draw(){
+        FrameTimeStats stats = frameTimeStats();
+
+        ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_FirstUseEver);
+        ImGui::SetNextWindowBgAlpha(.8f);
+        ImGui::Begin("performance");
+        ImGui::Text("%.1f fps  %.2f ms", stats.averageMs > 0 ? 1000.0f / stats.averageMs : 0.0f, stats.averageMs);
+        ImGui::Text("p50 %.2f  p95 %.2f  p99 %.2f  max %.2f ms", stats.p50Ms, stats.p95Ms, stats.p99Ms, stats.maxMs);
+
+        // the graph is scaled to at least 33 ms, so 30 and 60 fps are easy to tell apart
+        float scale = std::max(33.3f, stats.maxMs);
+        ImGui::PlotLines("##frame time", history, (int) HISTORY_SIZE, (int) next, "frame time", 0.0f, scale, ImVec2(0, 60));
+        float histogram[HISTOGRAM_BUCKETS] = {};
+        for (unsigned int i = 0; i < samples; i++)
+            histogram[std::min((unsigned int) (history[i] / scale * HISTOGRAM_BUCKETS), HISTOGRAM_BUCKETS - 1)] += 1.0f;
+        char range[32];
+        std::snprintf(range, sizeof(range), "0 - %.0f ms", scale);
+        ImGui::PlotHistogram("##histogram", histogram, (int) HISTOGRAM_BUCKETS, 0, range, 0.0f, FLT_MAX, ImVec2(0, 60));
+
+        ImGui::Separator();
+        const GLCallCounter &counter = glCallCounter();
+        if (counter.isInstalled()){
+            const GLCallStats &frame = counter.lastFrame();
+            ImGui::Text("draw calls  %u (%u instances)", frame.drawCalls, frame.instances);
+            ImGui::Text("triangles   %llu", (unsigned long long) frame.primitives);
+            ImGui::Text("vertices    %llu", (unsigned long long) frame.vertices);
+        }
+        else
+            ImGui::Text("draws and triangles need the GL call counter (--gl-stats)");
+        size_t bytes = bufferBytesSet ? bufferBytes : counter.allocatedBufferBytes();
+        if (bufferBytesSet || counter.isInstalled())
+            ImGui::Text("buffers     %.2f MB", (double) bytes / (1024.0 * 1024.0));
+        for (const Counter &shown : counters)
+            ImGui::Text("%-11s %.0f", shown.label.c_str(), shown.value);
+
+        if (!sliders.empty())
+            ImGui::Separator();
+        for (Slider &slider : sliders){
+            bool changed = slider.floatValue ?
+                    ImGui::SliderFloat(slider.label, slider.floatValue, slider.min, slider.max) :
+                    ImGui::SliderInt(slider.label, slider.intValue, (int) slider.min, (int) slider.max);
+            if (changed && slider.onChange)
+                slider.onChange();
+        }
+        ImGui::End();
+    }
+
+private:
+    struct Counter {
+        std::string label;
+        double value;
+    };
+
+    struct Slider {
+        const char* label;
+        float* floatValue;
+        int* intValue;
+        float min, max;
+        std::function<void()> onChange;
+    };
+
+    float history[HISTORY_SIZE] = {};
+    unsigned int next = 0, samples = 0;
+    bool started = false;
+    std::chrono::steady_clock::time_point lastFrame;
+
+    std::vector<Counter> counters;
+    size_t bufferBytes = 0;
+    bool bufferBytesSet = false;
+    std::vector<Slider> sliders;
+};
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_PERF_HUD_H
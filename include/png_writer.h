@@ -0,0 +1,12 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_PNG_WRITER_H
+#define GRAPHICSPROGRAMMINGEXERCISES_PNG_WRITER_H
+
+#include <string>
+
+// writes 8 bit RGBA pixels as a PNG file; OpenGL returns the rows bottom to top, so flipVertically
+// should be set for pixels coming from glReadPixels. Does not touch any global state of stb, so it can
+// be called from several threads at once
+bool writePng(const std::string &path, unsigned int width, unsigned int height,
+              const unsigned char* rgba, bool flipVertically);
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_PNG_WRITER_H
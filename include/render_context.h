@@ -0,0 +1,577 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_RENDER_CONTEXT_H
+#define GRAPHICSPROGRAMMINGEXERCISES_RENDER_CONTEXT_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <iostream>
+
+#ifndef _WIN32
+#include <dlfcn.h>
+#endif
+
+#include "frame_capture.h"
+#include "gpu_profiler.h"
+#include "cpu_profiler.h"
+#include "gl_call_counter.h"
+#include "input_replay.h"
+#include "frame_stats.h"
+
+// OpenGL 3.3 core context for the exercises, either in a GLFW window or headless:
+// - EGL: surfaceless context (EGL_MESA_platform_surfaceless / EGL_KHR_surfaceless_context), works with
+//   the GPU drivers and with mesa llvmpipe on machines without a GPU
+// - OSMesa: mesa software renderer, for systems without EGL
+// EGL and OSMesa are loaded at runtime, so they are not build dependencies. Headless contexts have no
+// default framebuffer: the frames are rendered in an FBO of the window size and the time advances by a fixed
+// step every frame so that runs are deterministic. Both windowed and headless runs can record their frames,
+// the readback is asynchronous (see frame_capture.h), and the input of a windowed run can be recorded and
+// replayed in a later run, headless or not (see input_replay.h)
+//
+// command line options, see parseRenderContextOptions:
+//   --headless[=egl|osmesa]   (or the GP_HEADLESS environment variable) render without a window
+//   --frames <n>              frames rendered before a headless or replayed run ends (default 300, or the length of
+//                             the replayed recording)
+//   --output <directory>      record the frames as files in the directory
+//   --capture-every <n>       only record every n-th frame
+//   --capture-format png|raw  file format of the recorded frames (default png)
+//   --gpu-profile <file>      write the GPU time of the GPU_SCOPEs as CSV when the context is destroyed
+//   --cpu-trace <file>        (or GP_CPU_TRACE) write the CPU_SCOPEs as a Chrome trace when the context is destroyed
+//   --gl-stats                count the GL calls of every frame, see gl_call_counter.h
+//   --record <file>           record the input of the window
+//   --replay <file>           replay a recorded input at the time step of the recording
+//   --benchmark <file>        write the frame times, GPU times and GL counters of the run as JSON
+// ---------------------------------------------------------------------------------------------------------
+
+enum class ContextBackend { WINDOW, EGL, OSMESA };
+
+struct RenderContextOptions {
+    ContextBackend backend = ContextBackend::WINDOW;
+    unsigned int frameCount = 0;            // headless and replays only, 0 for the default
+    float timeStep = 1.0f / 60.0f;          // headless only (replays use the recording), time between two frames in seconds
+    std::string outputDirectory;            // no frames are recorded when empty
+    unsigned int captureInterval = 1;
+    CaptureFormat captureFormat = CaptureFormat::PNG;
+    std::string gpuProfileFile;             // the GPU times are only printed when empty
+    std::string cpuTraceFile;
+    bool countGLCalls = false;
+    std::string recordFile;                 // input recording written at the end of a windowed run
+    std::string replayFile;
+    std::string benchmarkFile;
+};
+
+inline bool parseContextBackend(const char* name, ContextBackend &backend){
+    if (std::strcmp(name, "egl") == 0 || std::strcmp(name, "") == 0)
+        backend = ContextBackend::EGL;
+    else if (std::strcmp(name, "osmesa") == 0)
+        backend = ContextBackend::OSMESA;
+    else if (std::strcmp(name, "window") == 0)
+        backend = ContextBackend::WINDOW;
+    else {
+        std::cout << "ERROR::RENDER_CONTEXT::UNKNOWN_BACKEND " << name << std::endl;
+        return false;
+    }
+    return true;
+}
+
+inline RenderContextOptions parseRenderContextOptions(int argc, char* argv[]){
+    RenderContextOptions options;
+    if (const char* environment = std::getenv("GP_HEADLESS"))
+        parseContextBackend(environment, options.backend);
+    if (const char* environment = std::getenv("GP_CPU_TRACE"))
+        options.cpuTraceFile = environment;
+    for (int i = 1; i < argc; i++){
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (argument == "--headless")
+            options.backend = ContextBackend::EGL;
+        else if (argument.compare(0, 11, "--headless=") == 0)
+            parseContextBackend(argument.c_str() + 11, options.backend);
+        else if (argument == "--frames" && hasValue)
+            options.frameCount = (unsigned int) std::atoi(argv[++i]);
+        else if (argument == "--output" && hasValue)
+            options.outputDirectory = argv[++i];
+        else if (argument == "--capture-every" && hasValue)
+            options.captureInterval = (unsigned int) std::max(1, std::atoi(argv[++i]));
+        else if (argument == "--capture-format" && hasValue)
+            parseCaptureFormat(argv[++i], options.captureFormat);
+        else if (argument == "--gpu-profile" && hasValue)
+            options.gpuProfileFile = argv[++i];
+        else if (argument == "--cpu-trace" && hasValue)
+            options.cpuTraceFile = argv[++i];
+        else if (argument == "--gl-stats")
+            options.countGLCalls = true;
+        else if (argument == "--record" && hasValue)
+            options.recordFile = argv[++i];
+        else if (argument == "--replay" && hasValue)
+            options.replayFile = argv[++i];
+        else if (argument == "--benchmark" && hasValue)
+            options.benchmarkFile = argv[++i];
+    }
+    return options;
+}
+
+
+// minimal EGL and OSMesa declarations, the values come from egl.h, eglext.h and osmesa.h
+// --------------------------------------------------------------------------------------
+namespace headless {
+    typedef void* EGLDisplay;
+    typedef void* EGLConfig;
+    typedef void* EGLContext;
+    typedef void* EGLSurface;
+    typedef int32_t EGLint;
+    typedef unsigned int EGLBoolean;
+    typedef unsigned int EGLenum;
+    typedef void (*ProcAddress)();
+
+    const EGLint EGL_NONE = 0x3038, EGL_SURFACE_TYPE = 0x3033, EGL_RENDERABLE_TYPE = 0x3040, EGL_OPENGL_BIT = 0x0008,
+                 EGL_PBUFFER_BIT = 0x0001, EGL_RED_SIZE = 0x3024, EGL_GREEN_SIZE = 0x3023, EGL_BLUE_SIZE = 0x3022,
+                 EGL_ALPHA_SIZE = 0x3021, EGL_CONTEXT_MAJOR_VERSION = 0x3098, EGL_CONTEXT_MINOR_VERSION = 0x30FB,
+                 EGL_CONTEXT_OPENGL_PROFILE_MASK = 0x30FD, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT = 0x0001;
+    const EGLenum EGL_OPENGL_API = 0x30A2, EGL_PLATFORM_SURFACELESS_MESA = 0x31DD;
+
+    const int OSMESA_FORMAT = 0x22, OSMESA_DEPTH_BITS = 0x30, OSMESA_STENCIL_BITS = 0x31, OSMESA_ACCUM_BITS = 0x32,
+              OSMESA_PROFILE = 0x33, OSMESA_CORE_PROFILE = 0x34, OSMESA_CONTEXT_MAJOR_VERSION = 0x36,
+              OSMESA_CONTEXT_MINOR_VERSION = 0x37;
+
+    struct Library {
+        void* egl = nullptr;
+        void* osmesa = nullptr;
+        void* gl = nullptr;     // fallback for the core functions that eglGetProcAddress does not return
+        ProcAddress (*eglGetProcAddress)(const char*) = nullptr;
+        ProcAddress (*OSMesaGetProcAddress)(const char*) = nullptr;
+    };
+
+    inline Library &library(){
+        static Library instance;
+        return instance;
+    }
+
+    inline void* loadLibrary(const char* const* names){
+#ifndef _WIN32
+        for (int i = 0; names[i]; i++)
+            if (void* handle = dlopen(names[i], RTLD_NOW | RTLD_GLOBAL))
+                return handle;
+#endif
+        return nullptr;
+    }
+
+    inline void* librarySymbol(void* handle, const char* name){
+#ifndef _WIN32
+        return handle ? dlsym(handle, name) : nullptr;
+#else
+        return nullptr;
+#endif
+    }
+
+    // GLADloadproc for the headless backends
+    inline void* getProcAddress(const char* name){
+        Library &lib = library();
+        void* address = nullptr;
+        if (lib.eglGetProcAddress)
+            address = (void*) lib.eglGetProcAddress(name);
+        if (!address && lib.OSMesaGetProcAddress)
+            address = (void*) lib.OSMesaGetProcAddress(name);
+        if (!address)
+            address = librarySymbol(lib.gl, name);
+        return address;
+    }
+}
+
+
+class RenderContext {
+public:
+    RenderContext() = default;
+    RenderContext(const RenderContext &) = delete;
+    RenderContext &operator=(const RenderContext &) = delete;
+    ~RenderContext() { destroy(); }
+
+    // creates the window or the headless context, makes it current and loads the GL functions with glad
+    bool create(const char* title, unsigned int width, unsigned int height, const RenderContextOptions &contextOptions){
+        CPU_SCOPE("create context");
+        options = contextOptions;
+        contextTitle = title;
+        frameWidth = width;
+        frameHeight = height;
+        frame = 0;
+        bool created = false;
+        switch (options.backend){
+            case ContextBackend::WINDOW: created = createWindow(title); break;
+            case ContextBackend::EGL: created = createEGL(); break;
+            case ContextBackend::OSMESA: created = createOSMesa(); break;
+        }
+        if (!created)
+            return false;
+        if (!setupInput())
+            return false;
+        if (options.countGLCalls)
+            glCallCounter().install();
+        if (isHeadless() && !createFramebuffer())
+            return false;
+        if (isRecording())
+            capture.init(frameWidth, frameHeight, options.outputDirectory, options.captureFormat);
+        start = std::chrono::high_resolution_clock::now();
+        frameStart = start;
+        frameTimesMs.clear();
+        closeRequested = false;
+        gpuProfiler().beginFrame();
+        frameStartTicks = CpuProfiler::now();
+        return true;
+    }
+
+    bool isHeadless() const { return options.backend != ContextBackend::WINDOW; }
+    bool isRecording() const { return !options.outputDirectory.empty(); }
+    // the input comes from a recording, see input_replay.h
+    bool isReplaying() const { return inputReplay().isReplaying(); }
+    // nullptr for headless contexts, input callbacks and polling must be skipped then
+    GLFWwindow* getWindow() const { return window; }
+    unsigned int frameIndex() const { return frame; }
+    unsigned int width() const { return frameWidth; }
+    unsigned int height() const { return frameHeight; }
+    // loader of the GL functions of the context, for code that loads its own (e.g. indirect_draw.h)
+    GLADloadproc procAddressLoader() const{
+        return isHeadless() ? (GLADloadproc) headless::getProcAddress : (GLADloadproc) glfwGetProcAddress;
+    }
+
+    // application time of the current frame in seconds; headless runs and replays use a fixed time step
+    float time() const{
+        if (isHeadless() || isReplaying())
+            return (float) frame * options.timeStep;
+        return std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    // replaces glfwSetWindowShouldClose, which needs a window
+    void requestClose(){
+        closeRequested = true;
+        if (window)
+            glfwSetWindowShouldClose(window, true);
+    }
+
+    bool shouldClose() const{
+        if (closeRequested)
+            return true;
+        if (isHeadless() || isReplaying())
+            return frame >= options.frameCount || (window && glfwWindowShouldClose(window));
+        return glfwWindowShouldClose(window);
+    }
+
+    // presents the frame: queues its readback if recording, then swaps and polls the window; the GPU profiler
+    // frames follow the frames of the context
+    void endFrame(){
+        if (capture.isActive() && frame % options.captureInterval == 0){
+            CPU_SCOPE("capture");
+            GPU_SCOPE("capture");
+            GLCallCounterPause pause;
+            capture.capture(FBO, frame);
+        }
+        gpuProfiler().endFrame();
+        if (glCallCounter().isInstalled())
+            glCallCounter().endFrame();
+        if (!isHeadless()){
+            CPU_SCOPE("swap buffers");
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+        inputReplay().endFrame();
+        if (!options.benchmarkFile.empty()){
+            // the first frame also contains the setup of the exercise, it is not a sample
+            std::chrono::high_resolution_clock::time_point frameEnd = std::chrono::high_resolution_clock::now();
+            if (frame > 0)
+                frameTimesMs.push_back(std::chrono::duration<float, std::milli>(frameEnd - frameStart).count());
+            frameStart = frameEnd;
+        }
+        frame++;
+        gpuProfiler().beginFrame();
+        // the frames are the intervals between two endFrame calls in the CPU trace
+        uint64_t frameEndTicks = CpuProfiler::now();
+        cpuProfiler().record("frame", frameStartTicks, frameEndTicks);
+        frameStartTicks = frameEndTicks;
+    }
+
+    // prints the number of frames and the average frame time since create(), call it after destroy() when
+    // recording so that the count of written frames is complete
+    void printSummary(std::ostream &out) const{
+        double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        out << "rendered " << frame << " frames in " << seconds * 1000.0 << " ms";
+        if (frame > 0)
+            out << " (" << seconds * 1000.0 / frame << " ms per frame)";
+        out << std::endl;
+        if (isRecording())
+            capture.printSummary(out);
+        if (!gpuProfiler().getScopes().empty())
+            gpuProfiler().printStats(out);
+        if (glCallCounter().isInstalled())
+            glCallCounter().lastFrame().print(out);
+    }
+
+    // writes the frames still being recorded, then releases the context
+    void destroy(){
+        capture.finish();
+        inputReplay().finish();
+        if (window || eglContext || osmesaContext){
+            gpuProfiler().destroy();
+            if (!options.gpuProfileFile.empty())
+                gpuProfiler().writeCsv(options.gpuProfileFile);
+            if (!options.cpuTraceFile.empty())
+                cpuProfiler().writeChromeTrace(options.cpuTraceFile);
+            if (!options.benchmarkFile.empty())
+                writeBenchmark(options.benchmarkFile);
+        }
+        if (FBO){
+            glDeleteFramebuffers(1, &FBO);
+            glDeleteRenderbuffers(2, renderbuffers);
+            FBO = 0;
+        }
+        headless::Library &lib = headless::library();
+        if (eglContext){
+            auto makeCurrent = (headless::EGLBoolean (*)(headless::EGLDisplay, headless::EGLSurface, headless::EGLSurface, headless::EGLContext))
+                    headless::librarySymbol(lib.egl, "eglMakeCurrent");
+            auto destroyContext = (headless::EGLBoolean (*)(headless::EGLDisplay, headless::EGLContext))
+                    headless::librarySymbol(lib.egl, "eglDestroyContext");
+            auto terminate = (headless::EGLBoolean (*)(headless::EGLDisplay)) headless::librarySymbol(lib.egl, "eglTerminate");
+            makeCurrent(eglDisplay, nullptr, nullptr, nullptr);
+            destroyContext(eglDisplay, eglContext);
+            terminate(eglDisplay);
+            eglContext = nullptr;
+        }
+        if (osmesaContext){
+            auto destroyContext = (void (*)(void*)) headless::librarySymbol(lib.osmesa, "OSMesaDestroyContext");
+            destroyContext(osmesaContext);
+            osmesaContext = nullptr;
+        }
+        if (window){
+            glfwDestroyWindow(window);
+            window = nullptr;
+        }
+    }
+
+    // metrics of the run as one JSON object: the CPU frame times (from one endFrame to the next),
+    // the GPU time of every GPU_SCOPE and the GL counters of the last frame, if counted
+    bool writeBenchmark(const std::string &path) const{
+        FILE* file = std::fopen(path.c_str(), "w");
+        if (!file){
+            std::cout << "ERROR::RENDER_CONTEXT::CANNOT_WRITE " << path << std::endl;
+            return false;
+        }
+        const char* backends[] = {"window", "egl", "osmesa"};
+        double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        FrameTimeStats stats = computeFrameTimeStats(frameTimesMs);
+        std::fprintf(file, "{\n  \"scene\": \"%s\",\n  \"backend\": \"%s\",\n  \"replay\": \"%s\",\n",
+                     jsonEscape(contextTitle).c_str(), backends[(int) options.backend], jsonEscape(options.replayFile).c_str());
+        std::fprintf(file, "  \"frames\": %u,\n  \"time_step\": %.6f,\n  \"wall_ms\": %.3f,\n", frame, options.timeStep, seconds * 1000.0);
+        std::fprintf(file, "  \"frame_ms\": {\"avg\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f},\n",
+                     stats.averageMs, stats.p50Ms, stats.p95Ms, stats.p99Ms, stats.maxMs);
+        std::fprintf(file, "  \"gpu_ms\": {");
+        const std::vector<GpuProfiler::ScopeStats> &scopes = gpuProfiler().getScopes();
+        for (size_t i = 0; i < scopes.size(); i++)
+            std::fprintf(file, "%s\n    \"%s\": {\"count\": %u, \"min\": %.4f, \"avg\": %.4f, \"max\": %.4f}", i ? "," : "",
+                         jsonEscape(scopes[i].name).c_str(), scopes[i].count, scopes[i].minMs, scopes[i].averageMs(), scopes[i].maxMs);
+        std::fprintf(file, "%s}", scopes.empty() ? "" : "\n  ");
+        if (glCallCounter().isInstalled()){
+            const GLCallStats &calls = glCallCounter().lastFrame();
+            std::fprintf(file, ",\n  \"gl_last_frame\": {\"calls\": %u, \"draw_calls\": %u, \"instances\": %u, \"primitives\": %llu, "
+                               "\"uniforms\": %u, \"uploads\": %u, \"bytes_uploaded\": %llu, \"state_changes\": %u, \"redundant_state_changes\": %u}",
+                         calls.totalCalls, calls.drawCalls, calls.instances, (unsigned long long) calls.primitives, calls.uniformCalls,
+                         calls.uploads, (unsigned long long) calls.bytesUploaded, calls.stateChanges, calls.redundantStateChanges);
+        }
+        std::fprintf(file, "\n}\n");
+        std::fclose(file);
+        return true;
+    }
+
+private:
+    static std::string jsonEscape(const std::string &text){
+        std::string escaped;
+        for (char c : text){
+            if (c == '"' || c == '\\')
+                escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    // the input comes from the window, or is recorded from it, or is replayed
+    bool setupInput(){
+        inputReplay().setWindow(window);
+        if (!options.recordFile.empty()){
+            if (!window){
+                std::cout << "ERROR::RENDER_CONTEXT::RECORDING_NEEDS_A_WINDOW" << std::endl;
+                return false;
+            }
+            inputReplay().startRecording(window, options.recordFile);
+        }
+        if (!options.replayFile.empty()){
+            if (!inputReplay().startReplay(options.replayFile))
+                return false;
+            if (inputReplay().recordedTimeStep() > 0)
+                options.timeStep = inputReplay().recordedTimeStep();
+            if (!options.frameCount)
+                options.frameCount = inputReplay().recordedFrames();
+        }
+        if (!options.frameCount)
+            options.frameCount = 300;
+        return true;
+    }
+
+    bool createWindow(const char* title){
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+        window = glfwCreateWindow((int) frameWidth, (int) frameHeight, title, NULL, NULL);
+        if (window == NULL){
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return false;
+        }
+        glfwMakeContextCurrent(window);
+        if (!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)){
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool createEGL(){
+        using namespace headless;
+        const char* eglNames[] = {"libEGL.so.1", "libEGL.so", nullptr};
+        const char* glNames[] = {"libOpenGL.so.0", "libGL.so.1", nullptr};
+        Library &lib = library();
+        if (!lib.egl)
+            lib.egl = loadLibrary(eglNames);
+        if (!lib.gl)
+            lib.gl = loadLibrary(glNames);
+        if (!lib.egl){
+            std::cout << "ERROR::RENDER_CONTEXT::EGL_NOT_FOUND" << std::endl;
+            return false;
+        }
+        lib.eglGetProcAddress = (ProcAddress (*)(const char*)) librarySymbol(lib.egl, "eglGetProcAddress");
+        auto getDisplay = (EGLDisplay (*)(void*)) librarySymbol(lib.egl, "eglGetDisplay");
+        auto initialize = (EGLBoolean (*)(EGLDisplay, EGLint*, EGLint*)) librarySymbol(lib.egl, "eglInitialize");
+        auto bindAPI = (EGLBoolean (*)(EGLenum)) librarySymbol(lib.egl, "eglBindAPI");
+        auto chooseConfig = (EGLBoolean (*)(EGLDisplay, const EGLint*, EGLConfig*, EGLint, EGLint*)) librarySymbol(lib.egl, "eglChooseConfig");
+        auto createContext = (EGLContext (*)(EGLDisplay, EGLConfig, EGLContext, const EGLint*)) librarySymbol(lib.egl, "eglCreateContext");
+        auto makeCurrent = (EGLBoolean (*)(EGLDisplay, EGLSurface, EGLSurface, EGLContext)) librarySymbol(lib.egl, "eglMakeCurrent");
+        if (!lib.eglGetProcAddress || !getDisplay || !initialize || !bindAPI || !chooseConfig || !createContext || !makeCurrent){
+            std::cout << "ERROR::RENDER_CONTEXT::EGL_INCOMPLETE" << std::endl;
+            return false;
+        }
+
+        // prefer the surfaceless platform, it needs neither a display server nor a GPU
+        auto getPlatformDisplay = (EGLDisplay (*)(EGLenum, void*, const EGLint*)) lib.eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (getPlatformDisplay)
+            eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, nullptr, nullptr);
+        if (!eglDisplay || !initialize(eglDisplay, nullptr, nullptr)){
+            eglDisplay = getDisplay(nullptr);
+            if (!eglDisplay || !initialize(eglDisplay, nullptr, nullptr)){
+                std::cout << "ERROR::RENDER_CONTEXT::EGL_NO_DISPLAY" << std::endl;
+                return false;
+            }
+        }
+
+        const EGLint configAttributes[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8,
+                                           EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8, EGL_NONE};
+        const EGLint contextAttributes[] = {EGL_CONTEXT_MAJOR_VERSION, 3, EGL_CONTEXT_MINOR_VERSION, 3,
+                                            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT, EGL_NONE};
+        EGLConfig config = nullptr;
+        EGLint configCount = 0;
+        bindAPI(EGL_OPENGL_API);
+        if (!chooseConfig(eglDisplay, configAttributes, &config, 1, &configCount) || configCount == 0)
+            config = nullptr;   // EGL_KHR_no_config_context
+        eglContext = createContext(eglDisplay, config, nullptr, contextAttributes);
+        if (!eglContext || !makeCurrent(eglDisplay, nullptr, nullptr, eglContext)){
+            std::cout << "ERROR::RENDER_CONTEXT::EGL_NO_CONTEXT" << std::endl;
+            return false;
+        }
+        return loadFunctions();
+    }
+
+    bool createOSMesa(){
+        using namespace headless;
+        const char* osmesaNames[] = {"libOSMesa.so.8", "libOSMesa.so.6", "libOSMesa.so", nullptr};
+        Library &lib = library();
+        if (!lib.osmesa)
+            lib.osmesa = loadLibrary(osmesaNames);
+        if (!lib.osmesa){
+            std::cout << "ERROR::RENDER_CONTEXT::OSMESA_NOT_FOUND" << std::endl;
+            return false;
+        }
+        lib.OSMesaGetProcAddress = (ProcAddress (*)(const char*)) librarySymbol(lib.osmesa, "OSMesaGetProcAddress");
+        auto createContext = (void* (*)(const int*, void*)) librarySymbol(lib.osmesa, "OSMesaCreateContextAttribs");
+        auto makeCurrent = (unsigned char (*)(void*, void*, GLenum, GLsizei, GLsizei)) librarySymbol(lib.osmesa, "OSMesaMakeCurrent");
+        if (!lib.OSMesaGetProcAddress || !createContext || !makeCurrent){
+            std::cout << "ERROR::RENDER_CONTEXT::OSMESA_INCOMPLETE" << std::endl;
+            return false;
+        }
+
+        const int attributes[] = {OSMESA_FORMAT, GL_RGBA, OSMESA_DEPTH_BITS, 24, OSMESA_STENCIL_BITS, 8, OSMESA_ACCUM_BITS, 0,
+                                  OSMESA_PROFILE, OSMESA_CORE_PROFILE, OSMESA_CONTEXT_MAJOR_VERSION, 3,
+                                  OSMESA_CONTEXT_MINOR_VERSION, 3, 0};
+        osmesaContext = createContext(attributes, nullptr);
+        // OSMesa needs a color buffer to make the context current, the frames go to the FBO anyway
+        osmesaBuffer.resize(frameWidth * frameHeight * 4);
+        if (!osmesaContext || !makeCurrent(osmesaContext, osmesaBuffer.data(), GL_UNSIGNED_BYTE, (GLsizei) frameWidth, (GLsizei) frameHeight)){
+            std::cout << "ERROR::RENDER_CONTEXT::OSMESA_NO_CONTEXT" << std::endl;
+            return false;
+        }
+        return loadFunctions();
+    }
+
+    bool loadFunctions(){
+        if (!gladLoadGLLoader((GLADloadproc) headless::getProcAddress)){
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // color and depth/stencil renderbuffers of the window size, left bound for the whole run
+    bool createFramebuffer(){
+        glGenRenderbuffers(2, renderbuffers);
+        glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, (GLsizei) frameWidth, (GLsizei) frameHeight);
+        glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, (GLsizei) frameWidth, (GLsizei) frameHeight);
+        glGenFramebuffers(1, &FBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers[0]);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, renderbuffers[1]);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE){
+            std::cout << "ERROR::RENDER_CONTEXT::FRAMEBUFFER_INCOMPLETE" << std::endl;
+            return false;
+        }
+        glViewport(0, 0, (GLsizei) frameWidth, (GLsizei) frameHeight);
+        return true;
+    }
+
+    RenderContextOptions options;
+    std::string contextTitle;
+    unsigned int frameWidth = 0, frameHeight = 0;
+    unsigned int frame = 0;
+    std::chrono::high_resolution_clock::time_point start;
+    FrameCapture capture;
+    uint64_t frameStartTicks = 0;
+    std::chrono::high_resolution_clock::time_point frameStart;
+    std::vector<float> frameTimesMs;        // only when writing a benchmark
+    bool closeRequested = false;
+
+    GLFWwindow* window = nullptr;
+    headless::EGLDisplay eglDisplay = nullptr;
+    headless::EGLContext eglContext = nullptr;
+    void* osmesaContext = nullptr;
+    std::vector<unsigned char> osmesaBuffer;
+    unsigned int FBO = 0;
+    unsigned int renderbuffers[2] = {0, 0};
+};
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_RENDER_CONTEXT_H
@@ -0,0 +1,204 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_RENDER_QUEUE_H
+#define GRAPHICSPROGRAMMINGEXERCISES_RENDER_QUEUE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#include "index_buffer.h"
+
+// 64 bit sort key, compared as an unsigned integer:
+// | program (16 bits) | vertex array (16 bits) | depth (24 bits) | sequence (8 bits) |
+// sorting by key groups the draws by program first, then by VAO, and front to back inside each group
+// ---------------------------------------------------------------------------------------------------
+inline uint64_t makeSortKey(unsigned int program, unsigned int VAO, float depth, unsigned int sequence = 0){
+    // depth is expected in [0, 1], 0 being the near plane
+    depth = depth < 0.0f ? 0.0f : (depth > 1.0f ? 1.0f : depth);
+    uint64_t quantizedDepth = (uint64_t) (depth * (float) 0xFFFFFF);
+    return ((uint64_t) (program & 0xFFFF) << 48) |
+           ((uint64_t) (VAO & 0xFFFF) << 32) |
+           (quantizedDepth << 8) |
+           (uint64_t) (sequence & 0xFF);
+}
+
+
+// everything that is needed to issue one indexed draw call
+// --------------------------------------------------------
+struct DrawPacket {
+    uint64_t key;
+    unsigned int program;
+    unsigned int VAO;
+    unsigned int firstIndex;    // offset in the element buffer of the VAO, in indices
+    unsigned int indexCount;
+    GLenum indexType;
+    glm::mat4 model;            // value for the "model" uniform of the program
+};
+
+
+// keeps track of the currently bound GL state, so that redundant calls are never issued
+// the cache assumes it is the only one changing the state between invalidate() calls
+// ------------------------------------------------------------------------------------
+class RenderStateCache {
+public:
+    struct Stats {
+        unsigned int programBinds = 0, programBindsElided = 0;
+        unsigned int vaoBinds = 0, vaoBindsElided = 0;
+        unsigned int uniformSets = 0, uniformSetsElided = 0;
+        unsigned int drawCalls = 0;
+    };
+
+    // forget the bound state, call it at the start of a frame or after GL calls made outside of the cache
+    void invalidate(){
+        currentProgram = ~0u;
+        currentVAO = ~0u;
+        uniformValues.clear();
+    }
+
+    void useProgram(unsigned int program){
+        if (program == currentProgram){
+            stats.programBindsElided++;
+            return;
+        }
+        glUseProgram(program);
+        currentProgram = program;
+        stats.programBinds++;
+    }
+
+    void bindVertexArray(unsigned int VAO){
+        if (VAO == currentVAO){
+            stats.vaoBindsElided++;
+            return;
+        }
+        glBindVertexArray(VAO);
+        currentVAO = VAO;
+        stats.vaoBinds++;
+    }
+
+    // uniform locations are looked up once per program and name
+    int uniformLocation(unsigned int program, const std::string &name){
+        std::string key = std::to_string(program) + ":" + name;
+        auto it = uniformLocations.find(key);
+        if (it != uniformLocations.end())
+            return it->second;
+        int location = glGetUniformLocation(program, name.c_str());
+        uniformLocations[key] = location;
+        return location;
+    }
+
+    // sets a mat4 uniform of the current program, unless it already holds the same value
+    void setMat4(int location, const glm::mat4 &value){
+        uint64_t key = ((uint64_t) currentProgram << 32) | (uint32_t) location;
+        auto it = uniformValues.find(key);
+        if (it != uniformValues.end() && std::memcmp(&it->second, &value, sizeof(glm::mat4)) == 0){
+            stats.uniformSetsElided++;
+            return;
+        }
+        glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]);
+        uniformValues[key] = value;
+        stats.uniformSets++;
+    }
+
+    void drawElements(unsigned int firstIndex, unsigned int indexCount, GLenum indexType){
+        glDrawElements(GL_TRIANGLES, indexCount, indexType, (void*) (size_t) (firstIndex * indexTypeSize(indexType)));
+        stats.drawCalls++;
+    }
+
+    const Stats &getStats() const { return stats; }
+    void resetStats() { stats = Stats(); }
+
+    void printStats(std::ostream &out) const{
+        out << "state cache: " << stats.drawCalls << " draws, glUseProgram " << stats.programBinds
+            << " (" << stats.programBindsElided << " elided), glBindVertexArray " << stats.vaoBinds
+            << " (" << stats.vaoBindsElided << " elided), uniforms " << stats.uniformSets
+            << " (" << stats.uniformSetsElided << " elided)" << std::endl;
+    }
+
+private:
+    unsigned int currentProgram = ~0u;
+    unsigned int currentVAO = ~0u;
+    std::unordered_map<std::string, int> uniformLocations;
+    std::unordered_map<uint64_t, glm::mat4> uniformValues;
+    Stats stats;
+};
+
+
+// collects the draw packets of a frame, sorts them by key and submits them through a RenderStateCache
+// ----------------------------------------------------------------------------------------------------
+class RenderQueue {
+public:
+    void clear(){
+        packets.clear();
+        sortItems.clear();
+    }
+
+    void submit(const DrawPacket &packet){
+        packets.push_back(packet);
+    }
+
+    unsigned int size() const { return (unsigned int) packets.size(); }
+
+    // least significant digit radix sort of the keys, 8 bits per pass;
+    // passes where every key has the same digit are skipped, so in practice only a few passes run
+    void sort(){
+        unsigned int count = (unsigned int) packets.size();
+        sortItems.resize(count);
+        sortScratch.resize(count);
+        for (unsigned int i = 0; i < count; i++)
+            sortItems[i] = SortItem{packets[i].key, i};
+
+        for (unsigned int shift = 0; shift < 64; shift += 8){
+            unsigned int histogram[256] = {};
+            for (const SortItem &item : sortItems)
+                histogram[(item.key >> shift) & 0xFF]++;
+            if (count == 0 || histogram[(sortItems[0].key >> shift) & 0xFF] == count)
+                continue;
+
+            unsigned int offset = 0;
+            for (unsigned int &bucket : histogram){
+                unsigned int bucketSize = bucket;
+                bucket = offset;
+                offset += bucketSize;
+            }
+            for (const SortItem &item : sortItems)
+                sortScratch[histogram[(item.key >> shift) & 0xFF]++] = item;
+            sortItems.swap(sortScratch);
+        }
+    }
+
+    // issues the draws in sorted order
+    void flush(RenderStateCache &stateCache){
+        if (sortItems.size() != packets.size())
+            sort();
+        unsigned int locationProgram = ~0u;
+        int modelLocation = -1;
+        for (const SortItem &item : sortItems){
+            const DrawPacket &packet = packets[item.packetIndex];
+            if (packet.program != locationProgram){
+                locationProgram = packet.program;
+                modelLocation = stateCache.uniformLocation(packet.program, "model");
+            }
+            stateCache.useProgram(packet.program);
+            stateCache.bindVertexArray(packet.VAO);
+            stateCache.setMat4(modelLocation, packet.model);
+            stateCache.drawElements(packet.firstIndex, packet.indexCount, packet.indexType);
+        }
+    }
+
+private:
+    struct SortItem {
+        uint64_t key;
+        unsigned int packetIndex;
+    };
+
+    std::vector<DrawPacket> packets;
+    std::vector<SortItem> sortItems;
+    std::vector<SortItem> sortScratch;
+};
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_RENDER_QUEUE_H
@@ -0,0 +1,189 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_TEXTURE_CACHE_H
+#define GRAPHICSPROGRAMMINGEXERCISES_TEXTURE_CACHE_H
+
+#include <glad/glad.h>
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <iostream>
+
+// textures loaded from image files (stb_image) without blocking the render loop:
+//
+//     Texture rain = textureCache().load("textures/rain.png");
+//     ...
+//     rain.bind(0);    // a 1x1 white placeholder until the image is uploaded
+//
+// load() returns at once, the file is decoded by worker threads and the pixels are uploaded on the GL thread by
+// update() through a pixel buffer object, at most maxUploadBytesPerFrame per call, and the mipmaps are generated
+// on the GPU. The App runtime (app.h) calls update() every frame and release() before the context is destroyed.
+// Textures are reference counted: loading a path that is already loaded returns the same texture, and the GL
+// texture is deleted when the last handle is destroyed. Handles belong to the GL thread.
+//
+// loadAtlas() packs several sprites into one texture (atlas_packer.h), so particles of every kind are drawn with
+// one texture and one draw call; the sprites are decoded, packed and copied into the atlas by the worker threads
+// and the region of sprite i is sprites()[i] once the atlas is ready:
+//
+//     Texture atlas = textureCache().loadAtlas({"textures/rain.png", "textures/snow.png", "textures/splash.png"});
+//     ...
+//     if (atlas.isReady() && !rectsUploaded)   // e.g. into uniform vec4 spriteRects[3], indexed per particle
+//         glUniform4fv(rectsLocation, (GLsizei) atlas.sprites().size(), atlas.spriteRectData().data());
+// -------------------------------------------------------------------------------------------------------------
+
+struct TextureOptions {
+    bool mipmaps = true;
+    bool srgb = false;              // color textures that are lit or blended in linear space
+    bool flipVertically = true;     // image rows are top to bottom, OpenGL expects the bottom row first
+    GLenum wrap = GL_REPEAT;
+};
+
+// sprite of an atlas, texture coordinates (u0, v0) - (u1, v1) and the texel rectangle
+struct AtlasSprite {
+    float u0 = 0, v0 = 0, u1 = 0, v1 = 0;
+    unsigned int x = 0, y = 0, width = 0, height = 0;
+};
+
+class TextureCache;
+
+// reference counted handle, copies share the texture
+class Texture {
+public:
+    Texture() = default;
+
+    bool isValid() const { return entry != nullptr; }
+    // the image is uploaded, until then the texture is the placeholder
+    bool isReady() const { return entry && entry->ready; }
+    // the file could not be read or decoded, the texture stays the placeholder
+    bool hasFailed() const { return entry && entry->failed; }
+
+    unsigned int id() const;
+    unsigned int width() const { return entry ? entry->width : 0; }
+    unsigned int height() const { return entry ? entry->height : 0; }
+    // the file, or "atlas <padding>" and the sprite paths of an atlas on separate lines
+    const std::string &path() const;
+
+    // atlases only, in the order of the paths given to loadAtlas; empty until the atlas is ready
+    const std::vector<AtlasSprite> &sprites() const;
+    // (u0, v0, u1, v1) of every sprite, for a vec4 uniform array or a uniform buffer
+    std::vector<float> spriteRectData() const;
+
+    void bind(unsigned int unit) const{
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, id());
+    }
+
+private:
+    friend class TextureCache;
+
+    struct Entry {
+        TextureCache* cache = nullptr;
+        std::string path;
+        TextureOptions options;
+        unsigned int texture = 0;       // 0 until the upload, then owned by the entry
+        unsigned int width = 0, height = 0;
+        std::vector<AtlasSprite> sprites;
+        bool ready = false, failed = false;
+        ~Entry();
+    };
+
+    explicit Texture(std::shared_ptr<Entry> entry) : entry(std::move(entry)) {}
+
+    std::shared_ptr<Entry> entry;
+};
+
+
+class TextureCache {
+public:
+    TextureCache() = default;
+    TextureCache(const TextureCache &) = delete;
+    TextureCache &operator=(const TextureCache &) = delete;
+    ~TextureCache() { stopWorkers(); }
+
+    // bytes copied to the pixel buffer per update(), an image larger than that is still uploaded in one call
+    size_t maxUploadBytesPerFrame = 16 << 20;
+    // decode threads, started by the first load()
+    unsigned int workerCount = 2;
+
+    // the options of the first load of a path are used
+    Texture load(const std::string &path, const TextureOptions &options = TextureOptions());
+    // the sprites (converted to RGBA) packed into one texture, with padding texels around every sprite that repeat
+    // its border, so that filtering and the first log2(padding) mipmap levels don't bleed into the neighbours;
+    // shared with the loads of the same list of paths
+    Texture loadAtlas(const std::vector<std::string> &spritePaths, const TextureOptions &options = TextureOptions(),
+                      unsigned int padding = 4);
+
+    // GL thread: uploads the decoded images, up to maxUploadBytesPerFrame
+    void update();
+    // GL thread: blocks until every requested texture is uploaded (or failed), e.g. before a benchmark starts
+    void finishLoading();
+    // decoded or uploading, not yet ready
+    unsigned int pendingCount() const;
+
+    // deletes the placeholder, the pixel buffer and the textures of the handles that are still alive (their id
+    // becomes 0), needs the context that loaded them
+    void release();
+
+    // textures loaded, failed, megabytes uploaded and the average decode time
+    void printSummary(std::ostream &out) const;
+
+private:
+    // largest atlas the workers build, 4096 is supported by every GL 3.3 implementation
+    static const unsigned int MAX_ATLAS_SIZE = 4096;
+
+    struct Job {
+        std::weak_ptr<Texture::Entry> entry;
+        std::string path;
+        bool flipVertically = true;
+        std::vector<std::string> spritePaths;   // atlases only
+        unsigned int padding = 0;
+    };
+
+    struct DecodedImage {
+        std::weak_ptr<Texture::Entry> entry;
+        std::vector<unsigned char> pixels;
+        unsigned int width = 0, height = 0, channels = 0;
+        std::vector<AtlasSprite> sprites;
+        unsigned int maxLevel = 1000;           // GL_TEXTURE_MAX_LEVEL, limited for atlases
+        bool failed = false;
+    };
+
+    friend class Texture;
+
+    void startWorkers();
+    void stopWorkers();
+    void decodeImages();
+    bool decodeImage(const Job &job, DecodedImage &image);
+    bool buildAtlas(const Job &job, DecodedImage &image);
+    Texture request(const std::string &key, const TextureOptions &options, Job job);
+    void upload(DecodedImage &image);
+    void createPlaceholder();
+
+    // GL thread
+    std::unordered_map<std::string, std::weak_ptr<Texture::Entry>> entries;
+    unsigned int placeholder = 0;
+    unsigned int pixelBuffer = 0;
+    unsigned int requested = 0, uploaded = 0, failed = 0;
+    unsigned int pending = 0;       // requested, not yet taken from the decoded queue
+    size_t uploadedBytes = 0;
+
+    // shared with the decode threads, guarded by queueMutex
+    std::vector<std::thread> workers;
+    mutable std::mutex queueMutex;
+    std::condition_variable queueChanged;
+    std::deque<Job> jobs;
+    std::deque<DecodedImage> decoded;
+    unsigned int decoding = 0;
+    double decodeSeconds = 0;
+    unsigned int decodedCount = 0;
+    bool stopping = false;
+};
+
+// textures of the exercise, see above
+TextureCache &textureCache();
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_TEXTURE_CACHE_H
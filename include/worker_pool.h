@@ -0,0 +1,109 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_WORKER_POOL_H
+#define GRAPHICSPROGRAMMINGEXERCISES_WORKER_POOL_H
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+
+#include "cpu_profiler.h"
+
+// threads that are started once and wait between tasks, for the per frame work of the particle systems
+// (particle_sort.h, particle_emitters.h):
+//
+//     WorkerPool pool("particle sort", 4);
+//     pool.run(4, [&](unsigned int chunk){ ... chunk 0 to 3, chunk 0 on the calling thread ... });
+//
+// run returns when every chunk is done, the chunks must not write to the same memory
+// -------------------------------------------------------------------------------------------------------------
+
+class WorkerPool {
+public:
+    // the threads are named "<name> <index>" in the CPU profiler
+    explicit WorkerPool(const std::string &name, unsigned int threads = std::thread::hardware_concurrency())
+            : name(name) { setThreadCount(threads); }
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+    ~WorkerPool() { stopWorkers(); }
+
+    void setThreadCount(unsigned int threads){
+        stopWorkers();
+        threadCount = std::max(1u, threads);
+        for (unsigned int i = 1; i < threadCount; i++)
+            workers.emplace_back(&WorkerPool::work, this, i, generation);
+    }
+    unsigned int getThreadCount() const { return threadCount; }
+
+    // runs task(chunk) for every chunk, chunk 0 on the calling thread, and returns when all of them are done;
+    // chunks past the thread count are not run
+    void run(unsigned int chunks, const std::function<void(unsigned int)> &task){
+        chunks = std::min(chunks, threadCount);
+        if (chunks <= 1){
+            if (chunks == 1)
+                task(0);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            currentTask = &task;
+            activeChunks = chunks;
+            remaining = chunks - 1;
+            generation++;
+        }
+        wake.notify_all();
+        task(0);
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this]{ return remaining == 0; });
+        currentTask = nullptr;
+    }
+
+private:
+    // worker thread, runs chunk index of every task started after the generation it was created in
+    void work(unsigned int index, unsigned long long seen){
+        cpuProfiler().setThreadName(name + " " + std::to_string(index));
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true){
+            wake.wait(lock, [&]{ return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+            if (index >= activeChunks)
+                continue;
+            const std::function<void(unsigned int)> &task = *currentTask;
+            lock.unlock();
+            task(index);
+            lock.lock();
+            if (--remaining == 0)
+                done.notify_one();
+        }
+    }
+
+    void stopWorkers(){
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &worker : workers)
+            worker.join();
+        workers.clear();
+        stopping = false;
+    }
+
+    std::string name;
+    unsigned int threadCount = 1;
+
+    // the task and the counters are guarded by mutex
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    const std::function<void(unsigned int)>* currentTask = nullptr;
+    unsigned int activeChunks = 0, remaining = 0;
+    unsigned long long generation = 0;
+    bool stopping = false;
+};
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_WORKER_POOL_H
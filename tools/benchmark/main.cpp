@@ -0,0 +1,126 @@
+// runs exercises headless on recorded input (see input_replay.h) and collects the JSON metrics they write with
+// --benchmark (see render_context.h) in one report, so that runs on the same workload can be compared over time
+//
+// usage: benchmark [--runs <n>] <report.json> <executable> <recording> [<executable> <recording> ...] [-- <options>]
+//   --runs <n>   run every scene n times (default 1), each run is a separate entry of the report
+//   <options>    passed on to every exercise, e.g. --gl-stats or --headless=osmesa
+// the exercises are started in their own directory, where their shaders and meshes are
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <algorithm>
+
+struct Scene {
+    std::string executable;
+    std::string recording;
+};
+
+// absolute path of an existing file, the exercises run in another directory
+std::string absolutePath(const std::string &path){
+    char resolved[PATH_MAX];
+    if (!realpath(path.c_str(), resolved))
+        return "";
+    return resolved;
+}
+
+std::string directoryOf(const std::string &path){
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? "." : path.substr(0, slash);
+}
+
+std::string quoted(const std::string &text){
+    std::string result = "'";
+    for (char c : text)
+        result += c == '\'' ? std::string("'\\''") : std::string(1, c);
+    return result + "'";
+}
+
+std::string jsonEscape(const std::string &text){
+    std::string escaped;
+    for (char c : text){
+        if (c == '"' || c == '\\')
+            escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int runs = 1;
+    std::string reportPath, extraOptions;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++){
+        if (std::strcmp(argv[i], "--runs") == 0 && i + 1 < argc)
+            runs = (unsigned int) std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--") == 0){
+            for (i++; i < argc; i++)
+                extraOptions += " " + quoted(argv[i]);
+        }
+        else if (reportPath.empty())
+            reportPath = argv[i];
+        else
+            paths.push_back(argv[i]);
+    }
+    if (reportPath.empty() || paths.empty() || paths.size() % 2 != 0){
+        std::cout << "usage: benchmark [--runs <n>] <report.json> <executable> <recording> [<executable> <recording> ...] [-- <options>]" << std::endl;
+        return -1;
+    }
+
+    std::vector<Scene> scenes;
+    for (size_t i = 0; i < paths.size(); i += 2){
+        Scene scene{absolutePath(paths[i]), absolutePath(paths[i + 1])};
+        if (scene.executable.empty() || scene.recording.empty()){
+            std::cout << "ERROR::BENCHMARK::NOT_FOUND " << (scene.executable.empty() ? paths[i] : paths[i + 1]) << std::endl;
+            return -1;
+        }
+        scenes.push_back(scene);
+    }
+
+    std::string metricsPath = absolutePath(directoryOf(reportPath)) + "/benchmark_run.json";
+    std::ostringstream report;
+    report << "{\"runs\": [";
+    bool first = true, failed = false;
+    for (const Scene &scene : scenes){
+        for (unsigned int run = 0; run < runs; run++){
+            std::remove(metricsPath.c_str());
+            std::string command = "cd " + quoted(directoryOf(scene.executable)) + " && " + quoted(scene.executable) +
+                                  " --headless --replay " + quoted(scene.recording) + " --benchmark " + quoted(metricsPath) +
+                                  extraOptions + " > /dev/null";
+            std::cout << scene.executable << " (" << run + 1 << "/" << runs << ")" << std::endl;
+            int exitCode = std::system(command.c_str());
+
+            std::ifstream metricsFile(metricsPath);
+            std::stringstream metrics;
+            metrics << metricsFile.rdbuf();
+            bool hasMetrics = metricsFile.is_open() && !metrics.str().empty();
+            if (exitCode != 0 || !hasMetrics){
+                std::cout << "ERROR::BENCHMARK::RUN_FAILED " << scene.executable << " exit code " << exitCode << std::endl;
+                failed = true;
+            }
+
+            report << (first ? "" : ",") << "\n  {\"executable\": \"" << jsonEscape(scene.executable)
+                   << "\", \"recording\": \"" << jsonEscape(scene.recording) << "\", \"run\": " << run
+                   << ", \"exit_code\": " << exitCode << ", \"metrics\": " << (hasMetrics ? metrics.str() : "null") << "}";
+            first = false;
+        }
+    }
+    std::remove(metricsPath.c_str());
+    report << "\n]}\n";
+
+    std::ofstream reportFile(reportPath);
+    reportFile << report.str();
+    if (!reportFile){
+        std::cout << "ERROR::BENCHMARK::CANNOT_WRITE " << reportPath << std::endl;
+        return -1;
+    }
+    std::cout << "report written to " << reportPath << std::endl;
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,257 @@
+// converts the meshes embedded in the exercise 4.6 plane_model.h and primitives.h, and in weather_effects_meshes.h,
+// to binary mesh files (see mesh_file.h), so that exercise 4.6 and the weather effects map them at startup instead
+// of compiling them in; the meshes are written as authored, the exercises that call invertModelZ() on their own
+// copies still include the headers
+//
+// the triangles and vertices are reordered for the post-transform cache and vertex fetch (see mesh_optimizer.h),
+// the opaque plane parts additionally for reduced overdraw; the simulated cache statistics are printed per mesh
+// up to MAX_MESH_LODS levels of detail are generated per mesh (see mesh_simplifier.h) and stored in the same file
+//
+// usage: mesh_converter [--no-optimize] [--scene exercise_4_6|weather_effects] <output directory>
+//        mesh_converter --self-test <scratch directory>
+//   --no-optimize   keep the triangle and vertex order of the source meshes
+//   --scene         the meshes to write, exercise_4_6 by default
+//   --self-test     round-trips synthetic meshes at the byte and short index limits through the index narrowing,
+//                   the mesh files and the shared mesh buffer, and a quantized mesh through its encoding and
+//                   decoding, writing its files to the scratch directory
+
+#include <glm/glm.hpp>
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#include <functional>
+
+#include "mesh_file.h"
+#include "mesh_buffer.h"
+#include "mesh_optimizer.h"
+#include "mesh_simplifier.h"
+#include "plane_model.h"
+#include "primitives.h"
+#include "weather_effects_meshes.h"
+
+struct MeshSource {
+    const char* name;
+    const std::vector<float> &positions;
+    const std::vector<float> &colors;
+    const std::vector<unsigned int> &indices;
+    bool isPlanePart;
+};
+
+// the meshes used by each program, written to its build directory
+std::vector<MeshSource> sceneMeshes(const std::string &scene){
+    if (scene == "exercise_4_6")
+        return {
+                {"floor", floorVertices, floorColors, floorIndices, false},
+                {"cube", cubeVertices, cubeColors, cubeIndices, false},
+                {"plane_body", planeBodyVertices, planeBodyColors, planeBodyIndices, true},
+                {"plane_wing", planeWingVertices, planeWingColors, planeWingIndices, true},
+                {"plane_propeller", planePropellerVertices, planePropellerColors, planePropellerIndices, true},
+        };
+    if (scene == "weather_effects")
+        return {
+                {"floor", weatherFloorVertices, weatherFloorColors, weatherFloorIndices, false},
+                {"cube", cubeVertices, cubeColors, cubeIndices, false},
+        };
+    return {};
+}
+
+// expected index type of a mesh with vertexCount vertices
+GLenum expectedIndexType(unsigned int vertexCount){
+    return vertexCount <= 0x100 ? GL_UNSIGNED_BYTE : (vertexCount <= 0x10000 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT);
+}
+
+bool checkIndices(const char* stage, unsigned int vertexCount, const std::vector<unsigned int> &indices,
+                  GLenum type, GLenum expectedType, const std::function<unsigned int(unsigned int)> &readBack){
+    if (type != expectedType){
+        std::cout << "ERROR::MESH_CONVERTER::SELF_TEST " << stage << " with " << vertexCount << " vertices: index size "
+                  << indexTypeSize(type) << " instead of " << indexTypeSize(expectedType) << std::endl;
+        return false;
+    }
+    for (unsigned int i = 0; i < indices.size(); i++){
+        if (readBack(i) != indices[i]){
+            std::cout << "ERROR::MESH_CONVERTER::SELF_TEST " << stage << " with " << vertexCount << " vertices: index "
+                      << i << " reads " << readBack(i) << " instead of " << indices[i] << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// a quantized mesh file must decode to the written positions and colors within one step of their encodings;
+// the flat z of the mesh has a zero extent, which is stored as a zero scale
+bool checkQuantizedMesh(const std::string &directory){
+    const unsigned int vertexCount = 1000;
+    std::vector<float> positions, colors;
+    std::vector<unsigned int> indices;
+    for (unsigned int i = 0; i < vertexCount; i++){
+        float t = (float) i / (float) vertexCount;
+        positions.insert(positions.end(), {std::sin(t * 40.0f) * 3.0f - 1.0f, t * 0.25f + 2.0f, 0.5f});
+        colors.insert(colors.end(), {t, 1.0f - t, 0.5f, 1.0f});
+        indices.push_back(i);
+    }
+    indices.resize(indices.size() / 3 * 3);
+
+    std::string path = directory + "/self_test_quantized.mesh";
+    if (!writeMeshFile(path, positions, colors, indices, true))
+        return false;
+    MappedMeshFile written(path);
+    if (!written.isOpen() || !written.isQuantized() || written.positionType() != GL_UNSIGNED_SHORT ||
+        written.colorType() != GL_UNSIGNED_BYTE){
+        std::cout << "ERROR::MESH_CONVERTER::SELF_TEST " << path << " is not quantized" << std::endl;
+        return false;
+    }
+    std::vector<float> decodedPositions = written.decodePositions(), decodedColors = written.decodeColors();
+    glm::mat4 dequantization = written.dequantizationMatrix();
+    AABB box = written.bounds();
+    bool matches = true;
+    for (unsigned int v = 0; v < vertexCount && matches; v++){
+        const uint16_t* encoded = (const uint16_t*) written.positionData() + v * 4;
+        glm::vec4 normalized((float) encoded[0] / 65535.0f, (float) encoded[1] / 65535.0f, (float) encoded[2] / 65535.0f, 1.0f);
+        glm::vec4 shaderPosition = dequantization * normalized;
+        for (int i = 0; i < 3; i++){
+            float step = (box.max[i] - box.min[i]) / 65535.0f + 1e-5f;
+            matches = matches && std::fabs(decodedPositions[v * 3 + i] - positions[v * 3 + i]) <= step &&
+                      std::fabs(shaderPosition[i] - positions[v * 3 + i]) <= step;
+        }
+        for (int i = 0; i < 4; i++)
+            matches = matches && std::fabs(decodedColors[v * 4 + i] - colors[v * 4 + i]) <= 1.0f / 255.0f;
+    }
+    if (!matches)
+        std::cout << "ERROR::MESH_CONVERTER::SELF_TEST " << path << " does not decode to the written mesh" << std::endl;
+    written.close();
+    std::remove(path.c_str());
+    if (matches)
+        std::cout << "self test: " << vertexCount << " quantized vertices" << std::endl;
+    return matches;
+}
+
+// every vertex count puts the largest index on one side of a narrowing limit (255/256 and 65535/65536)
+bool runSelfTest(const std::string &directory){
+    const unsigned int vertexCounts[] = {0xff, 0x100, 0x101, 0xffff, 0x10000, 0x10001};
+    for (unsigned int vertexCount : vertexCounts){
+        // every vertex once in a scattered order, padded with the largest index to whole triangles
+        std::vector<unsigned int> indices;
+        for (unsigned int i = 0; i < vertexCount; i++)
+            indices.push_back((unsigned int) ((i * 7919ull) % vertexCount));
+        while (indices.size() % 3)
+            indices.push_back(vertexCount - 1);
+        std::vector<float> positions(vertexCount * 3), colors(vertexCount * 4, 1.0f);
+        for (unsigned int i = 0; i < vertexCount; i++)
+            positions[i * 3] = (float) i;
+        unsigned int indexCount = (unsigned int) indices.size();
+        GLenum expected = expectedIndexType(vertexCount);
+
+        // index_buffer.h
+        if (chooseIndexType(vertexCount) != chooseIndexType(indices.data(), indexCount)){
+            std::cout << "ERROR::MESH_CONVERTER::SELF_TEST the index types chosen from " << vertexCount
+                      << " vertices and from the indices differ" << std::endl;
+            return false;
+        }
+        std::vector<unsigned char> packed = packIndices(indices.data(), indexCount, chooseIndexType(vertexCount));
+        if (!checkIndices("packIndices", vertexCount, indices, chooseIndexType(vertexCount), expected,
+                          [&](unsigned int i){ return unpackIndex(packed.data(), chooseIndexType(vertexCount), i); }))
+            return false;
+
+        // mesh_file.h
+        std::string path = directory + "/self_test_" + std::to_string(vertexCount) + ".mesh";
+        if (!writeMeshFile(path, positions, colors, indices))
+            return false;
+        {
+            MappedMeshFile written(path);
+            if (!written.isOpen() || written.vertexCount() != vertexCount || written.indexCount() != indexCount){
+                std::cout << "ERROR::MESH_CONVERTER::SELF_TEST " << path << " does not read back" << std::endl;
+                return false;
+            }
+            if (!checkIndices("MappedMeshFile", vertexCount, indices, written.indexType(), expected,
+                              [&](unsigned int i){ return written.index(i); }))
+                return false;
+        }
+        std::remove(path.c_str());
+
+        // mesh_buffer.h, two copies of the mesh: the indices stay relative to each mesh, so the type does not widen
+        SharedMeshBuffer meshBuffer;
+        MeshRange first = meshBuffer.addMesh(positions, colors, indices);
+        MeshRange second = meshBuffer.addMesh(positions, colors, indices);
+        if (second.baseVertex != (int) vertexCount || second.firstIndex != first.indexCount){
+            std::cout << "ERROR::MESH_CONVERTER::SELF_TEST SharedMeshBuffer ranges with " << vertexCount << " vertices" << std::endl;
+            return false;
+        }
+        std::vector<unsigned char> shared;
+        GLenum sharedType = meshBuffer.packStagedIndices(shared);
+        if (!checkIndices("SharedMeshBuffer", vertexCount, indices, sharedType, expected,
+                          [&](unsigned int i){ return unpackIndex(shared.data(), sharedType, second.firstIndex + i); }))
+            return false;
+
+        std::cout << "self test: " << vertexCount << " vertices, " << indexTypeSize(expected) << " byte indices" << std::endl;
+    }
+    return checkQuantizedMesh(directory);
+}
+
+int main(int argc, char* argv[])
+{
+    bool optimize = true, selfTest = false;
+    std::string outputDirectory, scene = "exercise_4_6";
+    for (int i = 1; i < argc; i++){
+        if (std::strcmp(argv[i], "--no-optimize") == 0)
+            optimize = false;
+        else if (std::strcmp(argv[i], "--scene") == 0 && i + 1 < argc)
+            scene = argv[++i];
+        else if (std::strcmp(argv[i], "--self-test") == 0)
+            selfTest = true;
+        else
+            outputDirectory = argv[i];
+    }
+    if (outputDirectory.empty()){
+        std::cout << "usage: mesh_converter [--no-optimize] [--scene exercise_4_6|weather_effects] <output directory>" << std::endl;
+        std::cout << "       mesh_converter --self-test <scratch directory>" << std::endl;
+        return -1;
+    }
+    if (selfTest)
+        return runSelfTest(outputDirectory) ? 0 : -1;
+
+    std::vector<MeshSource> meshes = sceneMeshes(scene);
+    if (meshes.empty()){
+        std::cout << "ERROR::MESH_CONVERTER::UNKNOWN_SCENE " << scene << std::endl;
+        return -1;
+    }
+
+    for (const MeshSource &source : meshes){
+        MeshData mesh;
+        mesh.positions = source.positions;
+        mesh.colors = source.colors;
+        mesh.indices = source.indices;
+        if (optimize){
+            std::cout << source.name << ": ";
+            // the plane parts are opaque, so drawing their outer triangles first saves fragment work
+            optimizeMesh(mesh, source.isPlanePart, &std::cout);
+        }
+        // these meshes are already low poly, only a larger error budget leaves something to remove;
+        // the coarsest level is used for objects that cover less than 30 pixels anyway
+        generateMeshLods(mesh, MAX_MESH_LODS, .2f);
+        for (unsigned int i = 1; i < mesh.lods.size(); i++)
+            std::cout << source.name << ": lod " << i << " " << mesh.lods[i].indexCount / 3 << " triangles, error "
+                      << mesh.lods[i].error << std::endl;
+
+        std::string path = outputDirectory + "/" + source.name + ".mesh";
+        if (!writeMeshFile(path, mesh.positions, mesh.colors, mesh.indices, false, mesh.lods))
+            return -1;
+
+        // the indices are narrowed when written, make sure they read back exactly
+        MappedMeshFile written(path);
+        if (!written.isOpen() || written.indexCount() != mesh.indices.size())
+            return -1;
+        for (unsigned int i = 0; i < mesh.indices.size(); i++){
+            if (written.index(i) != mesh.indices[i]){
+                std::cout << "ERROR::MESH_CONVERTER::INDEX_MISMATCH " << path << " at " << i << std::endl;
+                return -1;
+            }
+        }
+        std::cout << "wrote " << path << " (" << mesh.vertexCount() << " vertices, "
+                  << mesh.indices.size() << " indices of " << written.indexSize() << " bytes)" << std::endl;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+#ifndef GRAPHICSPROGRAMMINGEXERCISES_WEATHER_EFFECTS_MESHES_H
+#define GRAPHICSPROGRAMMINGEXERCISES_WEATHER_EFFECTS_MESHES_H
+
+#include <vector>
+
+// the floor of the weather effects scene, large enough to walk around in the rain; the cubes of the scene are the
+// unit cube (-1 to 1) of the exercise 4.6 primitives.h
+// ---------------------------------------------------------------------------------------------------------------
+std::vector<float> weatherFloorVertices {-100.0f, 0.0f, 100.0f,
+                                          100.0f, 0.0f, 100.0f,
+                                          100.0f, 0.0f, -100.0f,
+                                         -100.0f, 0.0f, -100.0f};
+std::vector<unsigned int> weatherFloorIndices {0, 1, 2,
+                                               0, 2, 3};
+std::vector<float> weatherFloorColors {.35f, .4f, .35f, 1.f,
+                                       .3f, .35f, .3f, 1.f,
+                                       .35f, .4f, .35f, 1.f,
+                                       .3f, .35f, .3f, 1.f};
+
+#endif //GRAPHICSPROGRAMMINGEXERCISES_WEATHER_EFFECTS_MESHES_H
@@ -0,0 +1,55 @@
+// imports a model through the asset pipeline (see asset_import.h) and reports the time of the first import
+// against the time of loading the processed mesh from the cache
+//
+// usage: model_import [--reimport] <model file> [cache directory]
+//   --reimport   delete the cache entry of the model first, so that both paths are measured
+
+#include <iostream>
+#include <string>
+#include <cstdio>
+#include <cstring>
+
+#include "asset_import.h"
+
+int main(int argc, char* argv[])
+{
+    bool reimport = false;
+    std::string modelPath, cacheDirectory = ".";
+    for (int i = 1; i < argc; i++){
+        if (std::strcmp(argv[i], "--reimport") == 0)
+            reimport = true;
+        else if (modelPath.empty())
+            modelPath = argv[i];
+        else
+            cacheDirectory = argv[i];
+    }
+    if (modelPath.empty()){
+        std::cout << "usage: model_import [--reimport] <model file> [cache directory]" << std::endl;
+        return -1;
+    }
+
+    if (reimport){
+        uint64_t contentHash;
+        if (hashFileContents(modelPath, contentHash))
+            std::remove(processedMeshCachePath(cacheDirectory, contentHash).c_str());
+    }
+
+    // the first load imports the model, unless it is already cached
+    ImportTimings first, second;
+    {
+        MappedMeshFile mesh;
+        if (!loadModelCached(modelPath, cacheDirectory, mesh, &first))
+            return -1;
+        first.print(std::cout);
+    }
+    // the second load always comes from the cache
+    {
+        MappedMeshFile mesh;
+        if (!loadModelCached(modelPath, cacheDirectory, mesh, &second))
+            return -1;
+        second.print(std::cout);
+    }
+    if (!first.cacheHit && second.totalSeconds() > 0.0)
+        std::cout << "cached load is " << first.totalSeconds() / second.totalSeconds() << "x faster than import" << std::endl;
+    return 0;
+}
\ No newline at end of file
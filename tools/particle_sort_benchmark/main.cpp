@@ -0,0 +1,129 @@
+// measures the back to front sort of particle_sort.h for particle counts and thread counts, on particles at random
+// positions in a box around the camera (like the weather effects volume); the keys are computed in the sort, as in
+// the assignment, and every result is checked. std::stable_sort of the same keys on one thread is the reference
+//
+// usage: particle_sort_benchmark [--iterations <n>] [--counts <n,n,...>] [--threads <n,n,...>]
+//   --iterations <n>   sorts per count and thread count, the median time is reported (default 20)
+//   --counts           particle counts (default 65536,262144,1048576,4194304)
+//   --threads          thread counts (default 1,2,4,8 and the hardware threads)
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cstdint>
+#include <cmath>
+
+#include "particle_sort.h"
+
+std::vector<unsigned int> parseList(const char* text){
+    std::vector<unsigned int> values;
+    std::stringstream stream(text);
+    std::string value;
+    while (std::getline(stream, value, ','))
+        if (std::atoi(value.c_str()) > 0)
+            values.push_back((unsigned int) std::atoi(value.c_str()));
+    return values;
+}
+
+double median(std::vector<double> values){
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+// positions in a 20 m box, the camera looks along -z from the center
+struct Particles {
+    std::vector<float> x, y, z;
+    float maxDepth = 20.0f;
+
+    explicit Particles(unsigned int count) : x(count), y(count), z(count){
+        uint32_t state = 1;
+        auto random = [&state]{
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return (float) (state >> 8) / 16777216.0f;
+        };
+        for (unsigned int i = 0; i < count; i++){
+            x[i] = random() * 20.0f - 10.0f;
+            y[i] = random() * 20.0f - 10.0f;
+            z[i] = random() * 20.0f - 10.0f;
+        }
+    }
+
+    uint16_t key(unsigned int i) const{
+        return depthKey(std::sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]), maxDepth);
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    unsigned int iterations = 20;
+    std::vector<unsigned int> counts = {65536, 262144, 1048576, 4194304};
+    std::vector<unsigned int> threadCounts = {1, 2, 4, 8};
+    if (std::find(threadCounts.begin(), threadCounts.end(), std::thread::hardware_concurrency()) == threadCounts.end())
+        threadCounts.push_back(std::thread::hardware_concurrency());
+    for (int i = 1; i + 1 < argc; i += 2){
+        if (std::strcmp(argv[i], "--iterations") == 0)
+            iterations = (unsigned int) std::max(1, std::atoi(argv[i + 1]));
+        else if (std::strcmp(argv[i], "--counts") == 0)
+            counts = parseList(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--threads") == 0)
+            threadCounts = parseList(argv[i + 1]);
+        else {
+            std::cout << "usage: particle_sort_benchmark [--iterations <n>] [--counts <n,n,...>] [--threads <n,n,...>]" << std::endl;
+            return -1;
+        }
+    }
+
+    std::printf("%10s %8s %10s %12s %8s\n", "particles", "threads", "ms", "M/s", "speedup");
+    bool failed = false;
+    ParticleSorter sorter(1);
+    std::vector<unsigned int> order;
+    for (unsigned int count : counts){
+        Particles particles(count);
+        auto key = [&particles](unsigned int i){ return particles.key(i); };
+
+        // reference
+        std::vector<double> times;
+        std::vector<unsigned int> reference(count);
+        for (unsigned int iteration = 0; iteration < std::min(iterations, 5u); iteration++){
+            auto start = std::chrono::steady_clock::now();
+            std::vector<uint16_t> keys(count);
+            for (unsigned int i = 0; i < count; i++){
+                keys[i] = key(i);
+                reference[i] = i;
+            }
+            std::stable_sort(reference.begin(), reference.end(), [&keys](unsigned int a, unsigned int b){ return keys[a] < keys[b]; });
+            times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        double referenceMs = median(times);
+        std::printf("%10u %8s %10.3f %12.1f %8s\n", count, "std", referenceMs, count / referenceMs / 1000.0, "");
+
+        double singleThreadMs = 0;
+        for (unsigned int threads : threadCounts){
+            sorter.setThreadCount(threads);
+            times.clear();
+            for (unsigned int iteration = 0; iteration < iterations; iteration++){
+                auto start = std::chrono::steady_clock::now();
+                sorter.sort(count, key, order);
+                times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            }
+            // the radix sort is stable, so it matches the reference exactly
+            if (order != reference){
+                std::cout << "ERROR::PARTICLE_SORT::WRONG_ORDER " << count << " particles, " << threads << " threads" << std::endl;
+                failed = true;
+            }
+            double ms = median(times);
+            if (threads == threadCounts.front())
+                singleThreadMs = ms;
+            std::printf("%10u %8u %10.3f %12.1f %7.2fx\n", count, threads, ms, count / ms / 1000.0, singleThreadMs / ms);
+        }
+    }
+    return failed ? 1 : 0;
+}